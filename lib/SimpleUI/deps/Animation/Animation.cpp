@@ -5,16 +5,16 @@ namespace SimpleUI{
 
     void Animation::Start(){
         m_enable = true;
-        m_startTime = micros();
+        m_startTime = Clock::now();
     }
 
     void Animation::Resume(){
         m_enable = true; 
-        m_startTime = micros() - m_elapsed;
+        m_startTime = Clock::now() - m_elapsed;
     };
 
     void Animation::Reset(){
-        m_startTime = micros();
+        m_startTime = Clock::now();
         m_elapsed = 0UL;
         m_progress = m_start;
         m_state = AnimState::Start;
@@ -48,15 +48,14 @@ namespace SimpleUI{
         if (m_enable) {
             if ( m_state != AnimState::Finished) 
             {
-                m_now = micros();
+                m_now = Clock::now();
                 m_elapsed = m_now - m_startTime;
 
                 m_T = normalize(static_cast<float>(m_elapsed), 0, m_length);
+                m_T = std::clamp(m_T, 0.0f, 1.0f);
 
                 if(m_interpolation == Interpolation::Sinusoidal) 
                     m_T = static_cast<float>(0.5*sin(m_T*M_PI-M_PI_2)+0.5);
-                
-                m_T = std::clamp(m_T, 0.0f, 1.0f);
 
                 m_progress = lerp(m_start, m_end, m_T);
 
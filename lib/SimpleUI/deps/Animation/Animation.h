@@ -8,6 +8,24 @@ namespace SimpleUI{
     enum class AnimState{Start, Running, Finished};
     //Interpolation algorithm
     enum class Interpolation{Linear, CubicBezier, Sinusoidal};
+
+    /*The time source of every animation. Once Tick() has been called, the time is frozen until the next Tick(), so every animation
+    updated in the same frame sees the same instant, even across several UIs. Before the first Tick() it simply follows micros().*/
+    class Clock{
+        public:
+        //Latch the current time as the time of the frame that's about to be rendered
+        static inline void Tick() { s_now = micros(); s_ticking = true; }
+        //Go back to following micros()
+        static inline void Release() { s_ticking = false; }
+        //!@return The time of the current frame in microseconds
+        static inline uint32_t now() { return s_ticking ? s_now : micros(); }
+        //!@return True if the time is currently frozen by Tick()
+        static inline bool isTicking() { return s_ticking; }
+
+        private:
+        static inline uint32_t s_now = 0;
+        static inline bool s_ticking = false;
+    };
     
     class Animation{
         public:
@@ -18,7 +36,7 @@ namespace SimpleUI{
         */
         Animation(float start = 0.0f, float end = 1.0f, unsigned int length = 1000U, Interpolation interpolation = Interpolation::Linear) 
         : m_start(start), m_end(end), m_length(length*1000U),
-          m_now(micros()), m_startTime(micros()), m_elapsed(0UL), m_progress(start),
+          m_now(Clock::now()), m_startTime(Clock::now()), m_elapsed(0UL), m_progress(start),
           m_enable(false), m_loop(false), m_state(AnimState::Start), m_T(0.0f)
           { setFunc(interpolation); }
 
@@ -45,6 +63,7 @@ namespace SimpleUI{
         inline const float getProgress() const { return m_progress; }
         inline const bool isEnabled() const { return m_enable; }
         inline void setLoop(const bool loop){ m_loop = loop; }
+        inline const bool isLooping() const { return m_loop; }
         void setFunc(Interpolation function);
 
         bool operator==(const AnimState state){
@@ -0,0 +1,120 @@
+#include "Assets.h"
+
+namespace SimpleUI{
+
+    AssetStore& AssetStore::shared(){
+        static AssetStore store;
+        return store;
+    }
+
+    Texture* AssetStore::m_findTexture(const void* data, unsigned int w, unsigned int h, PixelType type, const uint8_t* alpha) const {
+        for(const auto& texture : m_textures){
+            if(texture->data.mono == data && texture->data.alpha == alpha && texture->width == w && texture->height == h && texture->data.colorspace == type)
+                return texture.get();
+        }
+        return nullptr;
+    }
+
+    Texture* AssetStore::texture(unsigned int w, unsigned int h, const uint8_t* data){
+        Texture* found = m_findTexture(data, w, h, PixelType::Mono);
+        if(found)
+            return found;
+        m_textures.emplace_back(new Texture(w, h, data));
+        return m_textures.back().get();
+    }
+
+    Texture* AssetStore::texture(unsigned int w, unsigned int h, const uint16_t* data){
+        Texture* found = m_findTexture(data, w, h, PixelType::RGB565);
+        if(found)
+            return found;
+        m_textures.emplace_back(new Texture(w, h, data));
+        return m_textures.back().get();
+    }
+
+    Texture* AssetStore::texture(unsigned int w, unsigned int h, const uint16_t* data, const uint8_t* alpha){
+        Texture* found = m_findTexture(data, w, h, PixelType::RGB565A4, alpha);
+        if(found)
+            return found;
+        m_textures.emplace_back(new Texture(w, h, data, alpha));
+        return m_textures.back().get();
+    }
+
+    const Texture& AssetStore::scaled(const Texture& source, float factor, bool filtered){
+        const ScaledEntry* entry = m_findScaled(source, factor, filtered);
+        return entry ? entry->texture : source;
+    }
+
+    SharedTexture AssetStore::scaledShared(const Texture& source, float factor, bool filtered){
+        const ScaledEntry* entry = m_findScaled(source, factor, filtered);
+        return entry ? entry->texture : SharedTexture(OwnedTexture(source));
+    }
+
+    //Find or make the cache entry of a scaled copy, nullptr if the source is used as it is
+    const AssetStore::ScaledEntry* AssetStore::m_findScaled(const Texture& source, float factor, bool filtered){
+        if(factor == 1.0f || !source.data.mono) //A texture without pixels can't be scaled, it isn't drawn either
+            return nullptr;
+
+        const unsigned int width = static_cast<unsigned int>(source.width * factor);
+        const unsigned int height = static_cast<unsigned int>(source.height * factor);
+        m_use_counter++;
+
+        for(auto& entry : m_scaled){
+            if(entry.source == &source && entry.pixels == source.data.mono && entry.width == width && entry.height == height && entry.filtered == filtered){
+                entry.last_use = m_use_counter;
+                return &entry;
+            }
+        }
+
+        SharedTexture result(scale(source, factor, filtered));
+        if(!result.data.mono)
+            return nullptr;
+        const size_t bytes = Texture::getByteSize(result.width, result.height, result.data.colorspace);
+        m_scaled.push_back(ScaledEntry{&source, source.data.mono, width, height, filtered, std::move(result), bytes, m_use_counter});
+        m_scaled_usage += bytes;
+        m_evict(&m_scaled.back());
+        
+        for(auto& entry : m_scaled){ //Eviction moves the entries around
+            if(entry.last_use == m_use_counter)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    //Drop the least recently used scaled textures until the cache fits its budget again
+    void AssetStore::m_evict(const ScaledEntry* keep){
+        const uint32_t keep_use = keep->last_use;
+        while(m_scaled_usage > m_scaled_budget && m_scaled.size() > 1){
+            auto oldest = m_scaled.end();
+            for(auto it = m_scaled.begin(); it != m_scaled.end(); it++){
+                if(it->last_use != keep_use && (oldest == m_scaled.end() || it->last_use < oldest->last_use))
+                    oldest = it;
+            }
+            if(oldest == m_scaled.end())
+                return;
+            m_scaled_usage -= oldest->bytes;
+            m_scaled.erase(oldest);
+        }
+    }
+
+    void AssetStore::releaseScaled(){
+        m_scaled.clear();
+        m_scaled_usage = 0;
+    }
+
+    void AssetStore::releaseScaled(const Texture& source){
+        for(auto it = m_scaled.begin(); it != m_scaled.end();){
+            if(it->source == &source){
+                m_scaled_usage -= it->bytes;
+                it = m_scaled.erase(it);
+            }
+            else
+                it++;
+        }
+    }
+
+    const GFXfont* AssetStore::font(const std::string& name) const {
+        const auto it = m_fonts.find(name);
+        return it != m_fonts.end() ? it->second : nullptr;
+    }
+
+}
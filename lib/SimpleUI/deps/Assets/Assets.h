@@ -0,0 +1,85 @@
+#pragma once
+#include "Texture.h"
+#include <Adafruit_GFX.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace SimpleUI{
+
+    /*Holds the assets that several UIs can share: deduplicated textures, fonts and the scaled copies of textures produced by animations.
+    Every UI uses AssetStore::shared() unless it's given its own store, so two displays showing the same icon keep a single copy of it.*/
+    class AssetStore{
+        public:
+        /*!
+            @param scaled_budget How many bytes the cache of scaled textures is allowed to use
+        */
+        AssetStore(size_t scaled_budget = 8192U) : m_scaled_budget(scaled_budget){}
+
+        //The store used by default by every UI
+        static AssetStore& shared();
+
+        /*!
+            @brief Get the texture wrapping an array, creating it only the first time the array is requested
+            @param w     Width in pixels
+            @param h     Height in pixels
+            @param data  Pointer to the pixels, usually stored in flash
+            @return A texture owned by the store, the same for every request of the same array
+        */
+        Texture* texture(unsigned int w, unsigned int h, const uint8_t* data);
+        Texture* texture(unsigned int w, unsigned int h, const uint16_t* data);
+        Texture* texture(unsigned int w, unsigned int h, const uint16_t* data, const uint8_t* alpha);
+
+        /*!
+            @brief Get a scaled copy of a texture, computing it only if no UI asked for the same size recently
+            @param source  The texture to scale
+            @param factor  The scaling factor
+            @param filtered  Interpolate bilinearly, cached apart from the unfiltered copy of the same size
+            @return The scaled texture, valid until the next call to scaled()
+        */
+        const Texture& scaled(const Texture& source, float factor, bool filtered = false);
+        /*!
+            @brief Same as scaled(), but the copy stays alive as long as a handle on it does, even after the cache evicted it
+            @return A handle on the scaled pixels, or on the source's own pixels if there's nothing to scale
+        */
+        SharedTexture scaledShared(const Texture& source, float factor, bool filtered = false);
+
+        inline void registerFont(const std::string& name, const GFXfont* font){ m_fonts[name] = font; }
+        //!@return The font registered with the given name, nullptr (the built-in font) if there's none
+        const GFXfont* font(const std::string& name) const;
+
+        //Free every scaled texture
+        void releaseScaled();
+        //Free the scaled copies of a texture, needed when its pixels go away
+        void releaseScaled(const Texture& source);
+        inline void setScaledBudget(size_t bytes){ m_scaled_budget = bytes; }
+        inline size_t getScaledBudget() const { return m_scaled_budget; }
+        //!@return How many bytes are used by scaled textures
+        inline size_t getScaledUsage() const { return m_scaled_usage; }
+        inline size_t getTextureCount() const { return m_textures.size(); }
+
+        private:
+        struct ScaledEntry{
+            const Texture* source;
+            const void* pixels;     //The pixels the source had, a view that moved to another cell needs a new copy
+            unsigned int width, height;
+            bool filtered;
+            SharedTexture texture;      //Evicting the entry only drops the cache's handle
+            size_t bytes;
+            uint32_t last_use;
+        };
+        Texture* m_findTexture(const void* data, unsigned int w, unsigned int h, PixelType type, const uint8_t* alpha = nullptr) const;
+        const ScaledEntry* m_findScaled(const Texture& source, float factor, bool filtered);
+        void m_evict(const ScaledEntry* keep);
+
+        private:
+        std::vector<std::unique_ptr<Texture>> m_textures;
+        std::vector<ScaledEntry> m_scaled;
+        std::unordered_map<std::string, const GFXfont*> m_fonts;
+        size_t m_scaled_budget;
+        size_t m_scaled_usage = 0;
+        uint32_t m_use_counter = 0;
+    };
+
+}
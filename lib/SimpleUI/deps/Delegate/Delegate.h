@@ -0,0 +1,113 @@
+#pragma once
+#include <stddef.h>
+#include <string.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SimpleUI{
+
+    template<typename Signature, size_t Capacity = 2 * sizeof(void*)>
+    class Delegate;
+
+    /*A callback that stores what it calls inside itself and never allocates, unlike std::function.
+    It binds free functions, member functions through member<&Class::method>(object) and lambdas whose captures fit in Capacity bytes,
+    which by default is enough for two references or pointers. A bigger callable is rejected at compile time:
+    keep it alive somewhere else and bind it with ref(), this is also how an existing std::function is handed over.
+    An empty delegate converts to false, so the caller can skip the call altogether.*/
+    template<typename R, typename... Args, size_t Capacity>
+    class Delegate<R(Args...), Capacity>{
+        public:
+        Delegate() = default;
+        Delegate(std::nullptr_t){}
+
+        //Bind a free function or a lambda, a null function pointer leaves the delegate empty
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+        Delegate(F&& callable){
+            using Callable = std::decay_t<F>;
+            static_assert(sizeof(Callable) <= Capacity, "The callable doesn't fit in the delegate, keep it alive elsewhere and bind it with Delegate::ref()");
+            static_assert(alignof(Callable) <= alignof(void*), "The callable needs a stricter alignment than the delegate provides");
+            if constexpr (std::is_pointer_v<std::remove_reference_t<F>>){
+                if (!callable)
+                    return;
+            }
+            ::new (static_cast<void*>(m_storage)) Callable(std::forward<F>(callable));
+            m_invoke = &m_call<Callable>;
+            if constexpr (!std::is_trivially_copyable_v<Callable> || !std::is_trivially_destructible_v<Callable>)
+                m_manage = &m_manager<Callable>;
+        }
+
+        /*!
+            @brief Bind a member function
+            @param object  The object the method is called on, it must outlive the delegate
+        */
+        template<auto Method, typename T>
+        static Delegate member(T* object){
+            return Delegate([object](Args... args) -> R { return (object->*Method)(std::forward<Args>(args)...); });
+        }
+        /*!
+            @brief Bind a callable without copying it, for the ones too big to be stored
+            @param callable  It must outlive the delegate
+        */
+        template<typename F>
+        static Delegate ref(F& callable){
+            F* target = &callable;
+            return Delegate([target](Args... args) -> R { return (*target)(std::forward<Args>(args)...); });
+        }
+
+        Delegate(const Delegate& other){ m_copy(other); }
+        Delegate& operator=(const Delegate& other){
+            if (this != &other){
+                reset();
+                m_copy(other);
+            }
+            return *this;
+        }
+        Delegate& operator=(std::nullptr_t){ reset(); return *this; }
+        ~Delegate(){ reset(); }
+
+        //Unbind whatever is bound
+        void reset(){
+            if (m_manage)
+                m_manage(m_storage, nullptr);
+            m_invoke = nullptr;
+            m_manage = nullptr;
+        }
+
+        //!@return True if something is bound
+        explicit operator bool() const { return m_invoke != nullptr; }
+        //The delegate must not be empty
+        R operator()(Args... args) const { return m_invoke(m_storage, std::forward<Args>(args)...); }
+
+        private:
+        using Invoker = R (*)(void* storage, Args&&... args);
+        //Copies the callable from src to dst, or destroys the one in dst if src is nullptr
+        using Manager = void (*)(void* dst, const void* src);
+
+        template<typename Callable>
+        static R m_call(void* storage, Args&&... args){
+            return (*static_cast<Callable*>(storage))(std::forward<Args>(args)...);
+        }
+        template<typename Callable>
+        static void m_manager(void* dst, const void* src){
+            if (src)
+                ::new (dst) Callable(*static_cast<const Callable*>(src));
+            else
+                static_cast<Callable*>(dst)->~Callable();
+        }
+        void m_copy(const Delegate& other){
+            if (other.m_manage)
+                other.m_manage(m_storage, other.m_storage);
+            else
+                memcpy(m_storage, other.m_storage, Capacity);
+            m_invoke = other.m_invoke;
+            m_manage = other.m_manage;
+        }
+
+        private:
+        alignas(void*) mutable unsigned char m_storage[Capacity] = {};
+        Invoker m_invoke = nullptr;
+        Manager m_manage = nullptr;
+    };
+
+}
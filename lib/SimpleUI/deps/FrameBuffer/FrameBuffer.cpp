@@ -0,0 +1,333 @@
+#include "FrameBuffer.h"
+#include <string.h>
+
+namespace SimpleUI{
+
+    static size_t strideOf(uint16_t w, ColorFormat format){
+        switch(format){
+            case ColorFormat::Mono:     return (w + 7) / 8;
+            case ColorFormat::Palette4: return (w + 1) / 2;
+            case ColorFormat::RGB332:   return w;
+            case ColorFormat::RGB565:   return w * 2;
+        }
+        return w * 2;
+    }
+
+    //Clip a horizontal span to the canvas, returns false if nothing is left
+    static bool clipSpan(int16_t& x, int16_t y, int16_t& w, int16_t width, int16_t height){
+        if(y < 0 || y >= height || w <= 0)
+            return false;
+        if(x < 0){
+            w += x;
+            x = 0;
+        }
+        if(x + w > width)
+            w = width - x;
+        return w > 0;
+    }
+
+    void ColorUtils::blendSpan565A4(uint16_t* dst, const uint16_t* src, const uint8_t* alpha, int alpha_x, int count){
+        for(int i = 0; i < count; i++){
+            const int ax = alpha_x + i;
+            const uint8_t opacity = (ax & 1) ? (alpha[ax >> 1] & 0x0F) : (alpha[ax >> 1] >> 4);
+            if(opacity == 15)
+                dst[i] = src[i];
+            else if(opacity != 0)
+                dst[i] = blend565(dst[i], src[i], alpha4To32(opacity));
+        }
+    }
+
+//--------------------FrameBuffer CLASS---------------------------------------------------------------//
+
+    FrameBuffer::FrameBuffer(uint16_t w, uint16_t h, ColorFormat format)
+    : Adafruit_GFX(w, h), m_stride(strideOf(w, format)), m_format(format)
+    {
+        m_buffer = new uint8_t[m_stride * h]();
+    }
+
+    FrameBuffer::~FrameBuffer(){
+        delete[] m_buffer;
+        delete[] m_lines[0];
+        delete[] m_lines[1];
+    }
+
+    uint16_t FrameBuffer::getPixel(int16_t x, int16_t y) const {
+        if(m_outside(x, y))
+            return 0;
+        uint16_t color;
+        readLine(y, x, 1, &color);
+        return color;
+    }
+
+    void FrameBuffer::stream(const LineSink& sink){
+        if(!sink)
+            return;
+        if(m_format == ColorFormat::RGB565){ //Already in the display's format, hand over the lines as they are
+            const uint16_t* pixels = reinterpret_cast<const uint16_t*>(m_buffer);
+            for(int16_t y = 0; y < HEIGHT; y++){
+                sink(y, pixels + y * WIDTH, WIDTH);
+            }
+            return;
+        }
+
+        if(!m_lines[0]){
+            m_lines[0] = new uint16_t[WIDTH];
+            m_lines[1] = new uint16_t[WIDTH];
+        }
+        for(int16_t y = 0; y < HEIGHT; y++){
+            uint16_t* line = m_lines[y & 1];
+            readLine(y, 0, WIDTH, line);
+            sink(y, line, WIDTH);
+        }
+    }
+
+//--------------------FrameBuffer16 CLASS---------------------------------------------------------------//
+
+    void FrameBuffer16::drawPixel(int16_t x, int16_t y, uint16_t color){
+        if(m_outside(x, y))
+            return;
+        getPixels()[y * WIDTH + x] = color;
+    }
+
+    void FrameBuffer16::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+        if(!clipSpan(x, y, w, WIDTH, HEIGHT))
+            return;
+        uint16_t* pixel = getPixels() + y * WIDTH + x;
+        std::fill(pixel, pixel + w, color);
+    }
+
+    void FrameBuffer16::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+        if(x < 0 || x >= WIDTH)
+            return;
+        const int16_t top = std::max<int16_t>(y, 0);
+        const int16_t bottom = std::min<int16_t>(y + h, HEIGHT);
+        uint16_t* pixels = getPixels();
+        for(int16_t row = top; row < bottom; row++){
+            pixels[row * WIDTH + x] = color;
+        }
+    }
+
+    void FrameBuffer16::fillScreen(uint16_t color){
+        std::fill(getPixels(), getPixels() + WIDTH * HEIGHT, color);
+    }
+
+    void FrameBuffer16::readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const {
+        memcpy(out, getPixels() + y * WIDTH + x, w * sizeof(uint16_t));
+    }
+
+//--------------------FrameBuffer8 CLASS---------------------------------------------------------------//
+
+    void FrameBuffer8::drawPixel(int16_t x, int16_t y, uint16_t color){
+        if(m_outside(x, y))
+            return;
+        m_buffer[y * m_stride + x] = ColorUtils::rgb565To332(color);
+    }
+
+    void FrameBuffer8::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+        if(!clipSpan(x, y, w, WIDTH, HEIGHT))
+            return;
+        memset(m_buffer + y * m_stride + x, ColorUtils::rgb565To332(color), w);
+    }
+
+    void FrameBuffer8::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+        if(x < 0 || x >= WIDTH)
+            return;
+        const uint8_t value = ColorUtils::rgb565To332(color);
+        const int16_t top = std::max<int16_t>(y, 0);
+        const int16_t bottom = std::min<int16_t>(y + h, HEIGHT);
+        for(int16_t row = top; row < bottom; row++){
+            m_buffer[row * m_stride + x] = value;
+        }
+    }
+
+    void FrameBuffer8::fillScreen(uint16_t color){
+        memset(m_buffer, ColorUtils::rgb565To332(color), getBufferSize());
+    }
+
+    void FrameBuffer8::readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const {
+        const uint8_t* pixel = m_buffer + y * m_stride + x;
+        for(int16_t i = 0; i < w; i++){
+            out[i] = ColorUtils::RGB332_TO_565[pixel[i]];
+        }
+    }
+
+//--------------------FrameBuffer4 CLASS---------------------------------------------------------------//
+
+    FrameBuffer4::FrameBuffer4(uint16_t w, uint16_t h, std::initializer_list<uint16_t> palette)
+    : FrameBuffer(w, h, ColorFormat::Palette4)
+    {
+        setPalette(palette);
+    }
+
+    void FrameBuffer4::setPalette(std::initializer_list<uint16_t> palette){
+        m_palette_size = 0;
+        for(const uint16_t color : palette){
+            if(m_palette_size == 16)
+                break;
+            m_palette[m_palette_size++] = color;
+        }
+        if(m_palette_size == 0)
+            m_palette[m_palette_size++] = 0x0000;
+        m_last_color = m_palette[0];
+        m_last_index = 0;
+    }
+
+    uint8_t FrameBuffer4::m_indexOf(uint16_t color){
+        if(color == m_last_color)
+            return m_last_index;
+
+        uint8_t index = 0;
+        bool found = false;
+        for(uint8_t i = 0; i < m_palette_size; i++){
+            if(m_palette[i] == color){
+                index = i;
+                found = true;
+                break;
+            }
+        }
+
+        if(!found && m_palette_size < 16){
+            index = m_palette_size;
+            m_palette[m_palette_size++] = color;
+        }
+        else if(!found){ //The palette is full, use the closest color
+            uint32_t best = UINT32_MAX;
+            const int r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+            for(uint8_t i = 0; i < m_palette_size; i++){
+                const int dr = r - (m_palette[i] >> 11);
+                const int dg = g - ((m_palette[i] >> 5) & 0x3F);
+                const int db = b - (m_palette[i] & 0x1F);
+                const uint32_t distance = 4*dr*dr + dg*dg + 4*db*db; //Green has one more bit of precision
+                if(distance < best){
+                    best = distance;
+                    index = i;
+                }
+            }
+        }
+
+        m_last_color = color;
+        m_last_index = index;
+        return index;
+    }
+
+    void FrameBuffer4::drawPixel(int16_t x, int16_t y, uint16_t color){
+        if(m_outside(x, y))
+            return;
+        m_setIndex(x, y, m_indexOf(color));
+    }
+
+    void FrameBuffer4::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+        if(!clipSpan(x, y, w, WIDTH, HEIGHT))
+            return;
+        const uint8_t index = m_indexOf(color);
+        if(x & 1){ //Leading half byte
+            m_setIndex(x++, y, index);
+            w--;
+        }
+        memset(m_buffer + y * m_stride + (x >> 1), index | (index << 4), w >> 1);
+        if(w & 1) //Trailing half byte
+            m_setIndex(x + w - 1, y, index);
+    }
+
+    void FrameBuffer4::fillScreen(uint16_t color){
+        const uint8_t index = m_indexOf(color);
+        memset(m_buffer, index | (index << 4), getBufferSize());
+    }
+
+    void FrameBuffer4::readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const {
+        const uint8_t* line = m_buffer + y * m_stride;
+        for(int16_t i = 0; i < w; i++){
+            const int16_t px = x + i;
+            const uint8_t byte = line[px >> 1];
+            out[i] = m_palette[(px & 1) ? (byte & 0x0F) : (byte >> 4)];
+        }
+    }
+
+//--------------------FrameBuffer1 CLASS---------------------------------------------------------------//
+
+    void FrameBuffer1::drawPixel(int16_t x, int16_t y, uint16_t color){
+        if(m_outside(x, y))
+            return;
+        uint8_t& byte = m_buffer[y * m_stride + (x >> 3)];
+        const uint8_t mask = 0x80 >> (x & 7);
+        byte = color != background ? byte | mask : byte & ~mask;
+    }
+
+    void FrameBuffer1::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+        if(!clipSpan(x, y, w, WIDTH, HEIGHT))
+            return;
+        for(int16_t i = 0; i < w; i++){
+            drawPixel(x + i, y, color);
+        }
+    }
+
+    void FrameBuffer1::fillScreen(uint16_t color){
+        memset(m_buffer, color != background ? 0xFF : 0x00, getBufferSize());
+    }
+
+    void FrameBuffer1::readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const {
+        const uint8_t* line = m_buffer + y * m_stride;
+        for(int16_t i = 0; i < w; i++){
+            const int16_t px = x + i;
+            out[i] = (line[px >> 3] & (0x80 >> (px & 7))) ? foreground : background;
+        }
+    }
+
+//--------------------StripBuffer CLASS---------------------------------------------------------------//
+
+    StripBuffer::StripBuffer(uint16_t w, uint16_t h, uint16_t lines)
+    : Adafruit_GFX(w, h), m_lines(lines ? std::min(lines, h) : 1)
+    {
+        m_pixels[0] = new uint16_t[w * m_lines]();
+        m_pixels[1] = new uint16_t[w * m_lines]();
+    }
+
+    StripBuffer::~StripBuffer(){
+        delete[] m_pixels[0];
+        delete[] m_pixels[1];
+    }
+
+    void StripBuffer::setBand(int16_t top){
+        m_top = top;
+        m_current ^= 1;
+    }
+
+    void StripBuffer::drawPixel(int16_t x, int16_t y, uint16_t color){
+        y -= m_top;
+        if(x < 0 || x >= WIDTH || y < 0 || y >= m_lines)
+            return;
+        m_pixels[m_current][y * WIDTH + x] = color;
+    }
+
+    void StripBuffer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+        y -= m_top;
+        if(!clipSpan(x, y, w, WIDTH, m_lines))
+            return;
+        uint16_t* pixel = m_pixels[m_current] + y * WIDTH + x;
+        std::fill(pixel, pixel + w, color);
+    }
+
+    void StripBuffer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+        if(x < 0 || x >= WIDTH)
+            return;
+        const int16_t top = std::max<int16_t>(y - m_top, 0);
+        const int16_t bottom = std::min<int16_t>(y + h - m_top, m_lines);
+        uint16_t* pixels = m_pixels[m_current];
+        for(int16_t row = top; row < bottom; row++){
+            pixels[row * WIDTH + x] = color;
+        }
+    }
+
+    void StripBuffer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+        const int16_t top = std::max<int16_t>(y, m_top);
+        const int16_t bottom = std::min<int16_t>(y + h, m_top + m_lines);
+        for(int16_t row = top; row < bottom; row++){
+            drawFastHLine(x, row, w, color);
+        }
+    }
+
+    void StripBuffer::fillScreen(uint16_t color){
+        std::fill(m_pixels[m_current], m_pixels[m_current] + WIDTH * m_lines, color);
+    }
+
+}
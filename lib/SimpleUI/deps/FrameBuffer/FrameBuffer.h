@@ -0,0 +1,255 @@
+#pragma once
+#include <Adafruit_GFX.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include "Delegate.h"
+
+namespace SimpleUI{
+
+    //How a framebuffer stores its pixels
+    enum class ColorFormat{Mono=1, Palette4=4, RGB332=8, RGB565=16};
+
+    namespace ColorUtils{
+        //!@return The RGB332 color closest to an RGB565 one
+        constexpr uint8_t rgb565To332(uint16_t color){
+            return ((color >> 8) & 0xE0) | ((color >> 6) & 0x1C) | ((color >> 3) & 0x03);
+        }
+        //!@return The RGB565 expansion of an RGB332 color, low bits are filled by replicating the high ones so white stays white
+        constexpr uint16_t rgb332To565(uint8_t color){
+            const uint16_t r = (color >> 5) & 0x07, g = (color >> 2) & 0x07, b = color & 0x03;
+            return (((r << 2) | (r >> 1)) << 11) | (((g << 3) | g) << 5) | ((b << 3) | (b << 1) | (b >> 1));
+        }
+        constexpr std::array<uint16_t, 256> makeRgb332Table(){
+            std::array<uint16_t, 256> table{};
+            for(unsigned int i = 0; i < 256; i++){
+                table[i] = rgb332To565(i);
+            }
+            return table;
+        }
+        //Lookup table used to expand RGB332 lines, it lives in flash
+        inline constexpr std::array<uint16_t, 256> RGB332_TO_565 = makeRgb332Table();
+
+        /*!
+            @brief Blend two RGB565 colors in fixed point, all three channels at once
+            @param background  The color underneath
+            @param foreground  The color on top
+            @param alpha       Opacity of the foreground, from 0 to 32
+        */
+        inline uint16_t blend565(uint16_t background, uint16_t foreground, uint8_t alpha){
+            //Spread the channels as 00000gggggg00000rrrrr000000bbbbb so the products can't overflow into each other
+            const uint32_t bg = (background | (background << 16)) & 0x07E0F81F;
+            const uint32_t fg = (foreground | (foreground << 16)) & 0x07E0F81F;
+            const uint32_t result = ((((fg - bg) * alpha) >> 5) + bg) & 0x07E0F81F;
+            return static_cast<uint16_t>(result | (result >> 16));
+        }
+        //!@return A 4 bit opacity expanded to the 0-32 range used by blend565
+        constexpr uint8_t alpha4To32(uint8_t alpha){
+            return alpha == 15 ? 32 : alpha << 1;
+        }
+        /*!
+            @brief Blend a span of RGB565A4 pixels over a line
+            @param dst       The line to draw on
+            @param src       RGB565 pixels of the span
+            @param alpha     Packed 4 bit opacities of the texture line the span belongs to
+            @param alpha_x   Index of the first pixel of the span in the texture line
+            @param count     How many pixels to blend
+        */
+        void blendSpan565A4(uint16_t* dst, const uint16_t* src, const uint8_t* alpha, int alpha_x, int count);
+    }
+
+    class FrameBuffer;
+
+    //Direct access to the pixels of a canvas, lets drawing kernels read what's underneath them
+    struct PixelAccess{
+        uint16_t* pixels = nullptr;          //First pixel of line `top`, nullptr if the canvas doesn't store RGB565
+        int16_t width = 0;                   //Pixels per line
+        int16_t top = 0;                     //First screen line held
+        int16_t lines = 0;                   //How many lines are held
+        FrameBuffer* framebuffer = nullptr;  //Used to read pixels one by one when the canvas stores another format
+
+        //!@return The RGB565 pixels of a screen line, nullptr if they aren't directly accessible
+        inline uint16_t* line(int16_t y) const {
+            return (pixels && y >= top && y < top + lines) ? pixels + (y - top) * width : nullptr;
+        }
+        //!@return True if pixels can be read in any way
+        inline bool isReadable() const { return pixels || framebuffer; }
+        /*!
+            @brief Narrow a range of screen lines to the ones held, a strip canvas holds only a band of the screen
+            @param first  First line of the range
+            @param end    The line after the last one, the range is empty once it's not past first
+        */
+        inline void clipLines(int& first, int& end) const {
+            if(!pixels)
+                return;
+            first = std::max<int>(first, top);
+            end = std::min<int>(end, top + lines);
+        }
+    };
+
+    /*A canvas that every element can draw into with RGB565 colors, whatever the format it stores its pixels in.
+    Pixels are converted when they're drawn and expanded back to RGB565 one line at a time while the frame is streamed to the display,
+    so a smaller format costs RAM only in proportion to its bit depth. Rotation is not supported, the canvas always matches the panel.*/
+    class FrameBuffer : public Adafruit_GFX{
+        public:
+        //Receives a line of RGB565 pixels, the pointer stays valid until the line after the next one is handed over
+        using LineSink = Delegate<void(int16_t y, const uint16_t* line, uint16_t w)>;
+
+        FrameBuffer(uint16_t w, uint16_t h, ColorFormat format);
+        virtual ~FrameBuffer();
+        FrameBuffer(const FrameBuffer&) = delete;
+        FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+        /*!
+            @brief Expand part of a line to RGB565
+            @param y    The line to read
+            @param x    The first pixel to read
+            @param w    How many pixels to read
+            @param out  Where to write the RGB565 pixels, must hold at least w pixels
+        */
+        virtual void readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const = 0;
+        //!@return The RGB565 color of a pixel
+        uint16_t getPixel(int16_t x, int16_t y) const;
+
+        /*!
+            @brief Send the whole frame to a sink line by line, expanding it to RGB565 on the way
+            @param sink Called once per line, from top to bottom
+        */
+        void stream(const LineSink& sink);
+
+        inline ColorFormat getFormat() const { return m_format; }
+        inline uint8_t* getBuffer() const { return m_buffer; }
+        //!@return How many bytes the pixels take
+        inline size_t getBufferSize() const { return m_stride * HEIGHT; }
+        //!@return How many bytes a line takes
+        inline size_t getStride() const { return m_stride; }
+
+        protected:
+        inline bool m_outside(int16_t x, int16_t y) const { return x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT; }
+
+        protected:
+        uint8_t* m_buffer;
+        uint16_t* m_lines[2] = {nullptr, nullptr}; //Ping-pong buffers used while streaming, allocated on first use
+        size_t m_stride;
+        ColorFormat m_format;
+    };
+
+    //Full color framebuffer, 2 bytes per pixel
+    class FrameBuffer16 : public FrameBuffer{
+        public:
+        FrameBuffer16(uint16_t w, uint16_t h) : FrameBuffer(w, h, ColorFormat::RGB565){}
+        void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+        void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+        void fillScreen(uint16_t color) override;
+        void readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const override;
+        inline uint16_t* getPixels() const { return reinterpret_cast<uint16_t*>(m_buffer); }
+    };
+
+    //RGB332 framebuffer, 1 byte per pixel
+    class FrameBuffer8 : public FrameBuffer{
+        public:
+        FrameBuffer8(uint16_t w, uint16_t h) : FrameBuffer(w, h, ColorFormat::RGB332){}
+        void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+        void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+        void fillScreen(uint16_t color) override;
+        void readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const override;
+    };
+
+    /*Framebuffer with a palette of up to 16 RGB565 colors, half a byte per pixel. Colors that aren't in the palette are added while
+    there's room, after that they're replaced by the closest color in the palette.*/
+    class FrameBuffer4 : public FrameBuffer{
+        public:
+        /*!
+            @param w        Width in pixels
+            @param h        Height in pixels
+            @param palette  The colors known in advance, the first one is the initial background
+        */
+        FrameBuffer4(uint16_t w, uint16_t h, std::initializer_list<uint16_t> palette = {0x0000, 0xFFFF});
+        void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+        void fillScreen(uint16_t color) override;
+        void readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const override;
+
+        void setPalette(std::initializer_list<uint16_t> palette);
+        inline const uint16_t* getPalette() const { return m_palette; }
+        inline uint8_t getPaletteSize() const { return m_palette_size; }
+
+        protected:
+        uint8_t m_indexOf(uint16_t color);
+        inline void m_setIndex(int16_t x, int16_t y, uint8_t index){
+            uint8_t& byte = m_buffer[y * m_stride + (x >> 1)];
+            byte = (x & 1) ? (byte & 0xF0) | index : (byte & 0x0F) | (index << 4);
+        }
+
+        protected:
+        uint16_t m_palette[16];
+        uint8_t m_palette_size = 0;
+        uint16_t m_last_color = 0;  //The last color looked up, drawing calls tend to repeat the same color many times
+        uint8_t m_last_index = 0;
+    };
+
+    //1 bit per pixel framebuffer, any color other than the background is drawn with the foreground color
+    class FrameBuffer1 : public FrameBuffer{
+        public:
+        /*!
+            @param w           Width in pixels
+            @param h           Height in pixels
+            @param foreground  RGB565 color of the pixels that are on
+            @param background  RGB565 color of the pixels that are off
+        */
+        FrameBuffer1(uint16_t w, uint16_t h, uint16_t foreground = 0xFFFF, uint16_t background = 0x0000)
+        : FrameBuffer(w, h, ColorFormat::Mono), foreground(foreground), background(background){}
+        void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+        void fillScreen(uint16_t color) override;
+        void readLine(int16_t y, int16_t x, int16_t w, uint16_t* out) const override;
+
+        public:
+        uint16_t foreground;
+        uint16_t background;
+    };
+
+    /*A canvas as wide as the screen but only a few lines tall, used to render a frame one horizontal band at a time.
+    Drawing calls keep using screen coordinates, anything outside the current band is dropped. Two bands are allocated and
+    setBand() switches between them, so one band can still be in flight to the display while the next one is rendered.*/
+    class StripBuffer : public Adafruit_GFX{
+        public:
+        /*!
+            @param w      Width of the screen in pixels
+            @param h      Height of the screen in pixels
+            @param lines  How many lines a band holds
+        */
+        StripBuffer(uint16_t w, uint16_t h, uint16_t lines);
+        ~StripBuffer();
+        StripBuffer(const StripBuffer&) = delete;
+        StripBuffer& operator=(const StripBuffer&) = delete;
+
+        //Move to the band starting at the given line, switching to the other buffer
+        void setBand(int16_t top);
+
+        void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+        void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+        void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+        //Fill the current band only
+        void fillScreen(uint16_t color) override;
+
+        //!@return The first screen line held by the current band
+        inline int16_t getTop() const { return m_top; }
+        //!@return How many lines the current band holds, the last band of the screen can be shorter
+        inline uint16_t getLines() const { return std::min<int>(m_lines, HEIGHT - m_top); }
+        inline uint16_t getStripHeight() const { return m_lines; }
+        //!@return The RGB565 pixels of the current band
+        inline uint16_t* getPixels() const { return m_pixels[m_current]; }
+
+        private:
+        uint16_t* m_pixels[2];
+        uint16_t m_lines;
+        int16_t m_top = 0;
+        uint8_t m_current = 0;
+    };
+
+}
@@ -0,0 +1,443 @@
+#include "Mirror.h"
+#include <string.h>
+#include <new>
+#include <algorithm>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace SimpleUI{
+
+    namespace{
+        //Type, count and the three numbers of a MirrorDelta at their longest
+        constexpr size_t delta_header = 2 + 3 * 5;
+        constexpr size_t body_limit = TelemetryCodec::max_payload - delta_header;
+
+        template<typename Unit> inline Unit loadUnit(const uint8_t* bytes, size_t unit){
+            Unit value;
+            memcpy(&value, bytes + unit * sizeof(Unit), sizeof(Unit));
+            return value;
+        }
+        //Units travel little endian whatever the board
+        template<typename Unit> inline void storeUnit(uint8_t* out, Unit value){
+            for(size_t i = 0; i < sizeof(Unit); i++){
+                out[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+    }
+
+//--------------------FrameMirror CLASS---------------------------------------------------------------//
+
+    FrameMirror::FrameMirror(TelemetryChannel* channel, uint32_t budget_us, size_t reserve)
+    : m_channel(channel), m_budget(budget_us), m_reserve(reserve){}
+
+    FrameMirror::~FrameMirror(){
+        delete[] m_reference;
+    }
+
+    bool FrameMirror::begin(uint16_t width, uint16_t height, uint8_t bits, size_t stride){
+        delete[] m_reference;
+        m_reference = new (std::nothrow) uint8_t[stride * height];
+        if(!m_reference){
+            m_pending.clear();
+            return false;
+        }
+        m_width = width;
+        m_height = height;
+        m_bits = bits;
+        m_stride = stride;
+        m_unit = bits == 16 ? 2 : 1;
+        m_reset();
+        return true;
+    }
+
+    void FrameMirror::setPalette(const uint16_t* colors, uint8_t count){
+        count = std::min<uint8_t>(count, 16);
+        if(count == m_palette_size && !memcmp(colors, m_palette, count * sizeof(uint16_t)))
+            return;
+        memcpy(m_palette, colors, count * sizeof(uint16_t));
+        m_palette_size = count;
+        m_palette_pending = true;
+    }
+
+    void FrameMirror::setEnabled(bool enabled){
+        if(enabled && !m_enabled.exchange(true, std::memory_order_relaxed))
+            resync();
+        else if(!enabled)
+            m_enabled.store(false, std::memory_order_relaxed);
+    }
+
+    void FrameMirror::nextFrame(){
+        m_frame++;
+        m_frame_counted = false;
+    }
+
+    void FrameMirror::markDirty(uint16_t y, uint16_t count){
+        if(y >= m_pending.size())
+            return;
+        count = std::min<size_t>(count, m_pending.size() - y);
+        memset(m_pending.data() + y, 1, count);
+    }
+
+    bool FrameMirror::isCaughtUp() const {
+        return std::find(m_pending.begin(), m_pending.end(), 1) == m_pending.end();
+    }
+
+    //The receiver starts over from black, every line is sent again
+    void FrameMirror::m_reset(){
+        memset(m_reference, 0, m_stride * m_height);
+        m_pending.assign(m_height, 1);
+        m_info_pending = true;
+        m_palette_pending = m_bits < 16;
+        m_sequence = 0;
+        m_resume = 0;
+        m_body_size = 0;
+        m_start = m_cursor = m_skip = 0;
+    }
+
+    bool FrameMirror::m_postInfo(){
+        if(m_info_pending){
+            if(!m_channel->post(TelemetryRecord(TelemetryType::MirrorInfo).number(m_width).number(m_height).number(m_bits).number(m_stride)))
+                return false;
+            m_info_pending = false;
+        }
+        if(m_palette_pending){
+            uint8_t payload[2 + sizeof(m_palette)] = {static_cast<uint8_t>(TelemetryType::MirrorPalette), 0};
+            for(uint8_t i = 0; i < m_palette_size; i++){
+                storeUnit<uint16_t>(payload + 2 + 2 * i, m_palette[i]);
+            }
+            if(!m_channel->post(payload, 2 + 2 * m_palette_size))
+                return false;
+            m_palette_pending = false;
+        }
+        return true;
+    }
+
+    void FrameMirror::capture(const uint8_t* lines, uint16_t top, uint16_t count){
+        if(!m_reference || !m_channel || top >= m_height || !isEnabled())
+            return;
+        if(m_resync.exchange(false, std::memory_order_relaxed)){
+            m_reset();
+            m_stats.resyncs++;
+        }
+        if(!m_postInfo())
+            return;
+        count = std::min<uint16_t>(count, m_height - top);
+        if(!m_hinted)
+            memset(m_pending.data() + top, 1, count);
+
+        const uint32_t start = m_now();
+        const size_t units = m_stride / m_unit;
+        //Lines are taken from where the budget ran out last time, so the bottom of a busy screen isn't starved
+        const uint16_t first = (m_resume > top && m_resume < top + count) ? m_resume - top : 0;
+        bool stopped = false;
+        for(uint16_t i = 0; i < count; i++){
+            const uint16_t y = top + (first + i) % count;
+            if(!m_pending[y])
+                continue;
+            if(m_now() - start > m_budget){
+                m_resume = y;
+                stopped = true;
+                break;
+            }
+            const uint8_t* line = lines + (y - top) * m_stride;
+            if(!memcmp(line, m_reference + y * m_stride, m_stride)){
+                m_pending[y] = 0;
+                if(m_body_size && m_cursor + m_skip == y * units)
+                    m_skip += units;  //Lets a record carry on past an unchanged line
+                continue;
+            }
+            const bool encoded = m_unit == 2 ? m_encodeLine<uint16_t>(line, y, lines, top) : m_encodeLine<uint8_t>(line, y, lines, top);
+            if(!encoded){
+                m_resume = y;
+                stopped = true;
+                break;
+            }
+            m_pending[y] = 0;
+            m_stats.lines++;
+        }
+        if(m_body_size && !m_post(lines, top))
+            stopped = true;
+        if(stopped)
+            m_stats.deferred++;
+        else
+            m_resume = 0;
+    }
+
+    template<typename Unit>
+    bool FrameMirror::m_encodeLine(const uint8_t* line, uint16_t y, const uint8_t* band, uint16_t top){
+        const size_t units = m_stride / m_unit;
+        const uint8_t* reference = m_reference + y * m_stride;
+        const size_t line_start = y * units;
+        if(m_cursor + m_skip != line_start){
+            //A record only covers lines it has compared, so it ends where the last one it encoded did
+            if(m_body_size && !m_post(band, top))
+                return false;
+            m_start = m_cursor = line_start;
+            m_skip = 0;
+        }
+
+        auto delta = [&](size_t i){ return static_cast<Unit>(loadUnit<Unit>(line, i) ^ loadUnit<Unit>(reference, i)); };
+        constexpr size_t max_literal = (body_limit - 5) / sizeof(Unit);
+        uint8_t values[max_literal * sizeof(Unit)];
+        size_t i = 0;
+        while(i < units){
+            const Unit value = delta(i);
+            size_t end = i + 1;
+            if(value == 0){
+                while(end < units && delta(end) == 0) end++;
+                m_skip += end - i;
+                i = end;
+                continue;
+            }
+            while(end < units && delta(end) == value) end++;
+            if(end - i >= MirrorCodec::min_repeat){
+                storeUnit<Unit>(values, value);
+                if(!m_flushSkip(band, top) || !m_op(MirrorCodec::Repeat, end - i, values, sizeof(Unit), band, top))
+                    return false;
+                i = end;
+                continue;
+            }
+            //Changes that don't repeat, up to the next unchanged unit or the next run worth a Repeat
+            end = i + 1;
+            while(end < units && end - i < max_literal){
+                const Unit next = delta(end);
+                if(next == 0 || (end + 2 < units && delta(end + 1) == next && delta(end + 2) == next))
+                    break;
+                end++;
+            }
+            for(size_t k = i; k < end; k++){
+                storeUnit<Unit>(values + (k - i) * sizeof(Unit), delta(k));
+            }
+            if(!m_flushSkip(band, top) || !m_op(MirrorCodec::Literal, end - i, values, (end - i) * sizeof(Unit), band, top))
+                return false;
+            i = end;
+        }
+        return true;
+    }
+
+    //Write the unchanged units waiting before a change, an empty record starts at the change instead
+    bool FrameMirror::m_flushSkip(const uint8_t* band, uint16_t top){
+        if(!m_skip)
+            return true;
+        if(!m_body_size){
+            m_cursor += m_skip;
+            m_start = m_cursor;
+            m_skip = 0;
+            return true;
+        }
+        const size_t count = m_skip;
+        m_skip = 0;
+        return m_op(MirrorCodec::Skip, count, nullptr, 0, band, top);
+    }
+
+    bool FrameMirror::m_op(MirrorCodec::Op op, size_t count, const uint8_t* values, size_t value_bytes, const uint8_t* band, uint16_t top){
+        uint8_t control[5];
+        const size_t control_size = TelemetryCodec::putVarint(control, static_cast<uint32_t>((count << 2) | op));
+        if(m_body_size + control_size + value_bytes > body_limit){
+            if(op == MirrorCodec::Skip){
+                m_skip = count;  //Nothing after it in this record, the next one starts past it
+                return m_post(band, top);
+            }
+            if(!m_post(band, top))
+                return false;
+        }
+        if(!m_body_size)
+            m_start = m_cursor;
+        memcpy(m_body + m_body_size, control, control_size);
+        if(value_bytes)
+            memcpy(m_body + m_body_size + control_size, values, value_bytes);
+        m_body_size += control_size + value_bytes;
+        m_cursor += count;
+        return true;
+    }
+
+    /*Post the record being built and bring the reference up to date with it. If the channel has no room the lines it covered
+    are left pending, and sent again from scratch*/
+    bool FrameMirror::m_post(const uint8_t* band, uint16_t top){
+        const size_t units = m_stride / m_unit;
+        uint8_t payload[TelemetryCodec::max_payload];
+        payload[0] = static_cast<uint8_t>(TelemetryType::MirrorDelta);
+        payload[1] = 3;
+        size_t size = 2;
+        size += TelemetryCodec::putVarint(payload + size, m_sequence);
+        size += TelemetryCodec::putVarint(payload + size, m_frame);
+        size += TelemetryCodec::putVarint(payload + size, static_cast<uint32_t>(m_start));
+        memcpy(payload + size, m_body, m_body_size);
+        size += m_body_size;
+
+        const bool room = m_channel->getFree() >= TelemetryChannel::encodedSize(size) + m_reserve;
+        if(!room || !m_channel->post(payload, size)){
+            markDirty(m_start / units, (m_cursor + units - 1) / units - m_start / units);
+            m_body_size = 0;
+            m_cursor = m_start;
+            m_skip = 0;
+            return false;
+        }
+        const size_t from = m_start * m_unit, to = m_cursor * m_unit;
+        memcpy(m_reference + from, band + from - top * m_stride, to - from);
+        m_sequence++;
+        m_stats.chunks++;
+        m_stats.bytes += size;
+        if(!m_frame_counted){
+            m_frame_counted = true;
+            m_stats.frames++;
+        }
+        m_body_size = 0;
+        m_start = m_cursor += m_skip;
+        m_skip = 0;
+        return true;
+    }
+
+    uint32_t FrameMirror::m_now(){
+#ifdef ARDUINO
+        return micros();
+#else
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+//--------------------MirrorReceiver CLASS---------------------------------------------------------------//
+
+    bool MirrorReceiver::apply(const TelemetryMessage& message){
+        const uint32_t* n = message.numbers;
+        switch(message.type){
+            case TelemetryType::MirrorInfo:{
+                if(message.count < 4)
+                    return false;
+                const uint8_t bits = static_cast<uint8_t>(n[2]);
+                const bool known = bits == 16 || bits == 8 || bits == 4 || bits == 1;
+                if(!known || !n[0] || !n[1] || n[0] > 4096 || n[1] > 4096 || n[3] < (static_cast<size_t>(n[0]) * bits + 7) / 8 || n[3] > 16384){
+                    m_lose();
+                    return false;
+                }
+                m_width = static_cast<uint16_t>(n[0]);
+                m_height = static_cast<uint16_t>(n[1]);
+                m_bits = bits;
+                m_stride = n[3];
+                m_pixels.assign(m_stride * m_height, 0);
+                m_expected = 0;
+                m_synced = true;
+                return true;
+            }
+            case TelemetryType::MirrorPalette:{
+                const size_t count = std::min<size_t>(message.text.size() / 2, 16);
+                for(size_t i = 0; i < count; i++){
+                    m_palette[i] = static_cast<uint8_t>(message.text[2 * i]) | (static_cast<uint8_t>(message.text[2 * i + 1]) << 8);
+                }
+                return m_synced && count;
+            }
+            case TelemetryType::MirrorDelta:
+                return m_applyDelta(message);
+            default:
+                return false;
+        }
+    }
+
+    bool MirrorReceiver::m_applyDelta(const TelemetryMessage& message){
+        if(!m_synced)
+            return false;
+        if(message.count < 3 || message.numbers[0] != m_expected){
+            m_lose();
+            return false;
+        }
+        m_expected++;
+        m_frame = message.numbers[1];
+
+        const uint8_t* body = reinterpret_cast<const uint8_t*>(message.text.data());
+        const size_t len = message.text.size();
+        const size_t unit_size = m_bits == 16 ? 2 : 1;
+        const size_t units = m_pixels.size() / unit_size;
+        size_t unit = message.numbers[2];
+        size_t read = 0;
+        auto value = [&](uint32_t& out){
+            if(read + unit_size > len)
+                return false;
+            out = unit_size == 2 ? body[read] | (body[read + 1] << 8) : body[read];
+            read += unit_size;
+            return true;
+        };
+        while(read < len){
+            uint32_t control;
+            const size_t used = TelemetryCodec::getVarint(body + read, len - read, control);
+            const size_t count = control >> 2;
+            read += used;
+            if(!used || unit + count > units){
+                m_lose();
+                return false;
+            }
+            uint32_t changed = 0;
+            switch(control & 3){
+                case MirrorCodec::Skip:
+                    break;
+                case MirrorCodec::Repeat:
+                    if(!value(changed)){
+                        m_lose();
+                        return false;
+                    }
+                    for(size_t i = 0; i < count; i++){
+                        m_xor(unit + i, changed);
+                    }
+                    break;
+                case MirrorCodec::Literal:
+                    for(size_t i = 0; i < count; i++){
+                        if(!value(changed)){
+                            m_lose();
+                            return false;
+                        }
+                        m_xor(unit + i, changed);
+                    }
+                    break;
+                default:
+                    m_lose();
+                    return false;
+            }
+            unit += count;
+        }
+        return true;
+    }
+
+    void MirrorReceiver::m_xor(size_t unit, uint32_t value){
+        if(m_bits == 16){
+            m_pixels[2 * unit] ^= static_cast<uint8_t>(value);
+            m_pixels[2 * unit + 1] ^= static_cast<uint8_t>(value >> 8);
+        }else{
+            m_pixels[unit] ^= static_cast<uint8_t>(value);
+        }
+    }
+
+    void MirrorReceiver::m_lose(){
+        m_lost++;
+        m_synced = false;
+    }
+
+    void MirrorReceiver::readLine(uint16_t y, uint8_t* rgb) const {
+        if(y >= m_height){
+            memset(rgb, 0, 3 * m_width);
+            return;
+        }
+        const uint8_t* line = m_pixels.data() + y * m_stride;
+        for(uint16_t x = 0; x < m_width; x++){
+            uint16_t color;
+            switch(m_bits){
+                case 16: color = line[2 * x] | (line[2 * x + 1] << 8); break;
+                case 8:{
+                    //Same expansion as ColorUtils::rgb332To565
+                    const uint16_t r = (line[x] >> 5) & 0x07, g = (line[x] >> 2) & 0x07, b = line[x] & 0x03;
+                    color = (((r << 2) | (r >> 1)) << 11) | (((g << 3) | g) << 5) | ((b << 3) | (b << 1) | (b >> 1));
+                    break;
+                }
+                case 4: color = m_palette[(x & 1) ? (line[x >> 1] & 0x0F) : (line[x >> 1] >> 4)]; break;
+                default: color = m_palette[(line[x >> 3] >> (7 - (x & 7))) & 1]; break;
+            }
+            const uint8_t r = (color >> 11) & 0x1F, g = (color >> 5) & 0x3F, b = color & 0x1F;
+            rgb[3 * x] = (r << 3) | (r >> 2);
+            rgb[3 * x + 1] = (g << 2) | (g >> 4);
+            rgb[3 * x + 2] = (b << 3) | (b >> 2);
+        }
+    }
+
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+#include "Telemetry.h"
+
+namespace SimpleUI{
+
+    /*How the changes of a frame are encoded. The frame is a run of units, a pixel for 16 bit formats and a byte otherwise,
+    and every unit is XORed with the same unit of the previous frame: what didn't change becomes 0. The result is a list of ops,
+    each one a varint holding (count << 2) | op, where count is a number of units:
+      Skip     count units didn't change
+      Repeat   count units all changed by the same value, which follows
+      Literal  count units changed by the values that follow
+    Units are stored little endian. Ops can run across lines.*/
+    namespace MirrorCodec{
+        enum Op : uint8_t{Skip = 0, Repeat = 1, Literal = 2};
+        //Shortest run of identical changes worth a Repeat
+        constexpr size_t min_repeat = 3;
+    }
+
+    //What a mirror sent, since it was created
+    struct MirrorStats{
+        uint32_t frames = 0;      //Frames that had changes to send
+        uint32_t chunks = 0;      //MirrorDelta records posted
+        uint32_t bytes = 0;       //Payload bytes of those records
+        uint32_t lines = 0;       //Lines that changed and were sent
+        uint32_t deferred = 0;    //Frames whose changes didn't all fit in the budget or the channel, the rest followed later
+        uint32_t resyncs = 0;     //Times the whole frame was sent again
+    };
+
+    /*Mirrors the frames a UI presents on a TelemetryChannel, so what the panel shows can be watched from a computer.
+    A copy of the last frame sent is kept, every new frame is compared with it a line at a time and only the lines that changed
+    are encoded (see MirrorCodec), in records small enough to share the link with the telemetry.
+
+    The work is bounded every frame: lines are encoded until the time budget runs out or the channel is too full, the ones left
+    over are sent with the next frames, so a busy screen converges over a few frames instead of stalling the UI.
+    A static screen costs a comparison of its lines, nothing at all if the lines that changed are given with markDirty().
+
+    The receiver starts from a black frame at every MirrorInfo record and applies the deltas in order: one that's lost breaks
+    the picture until resync() sends the whole frame again. See MirrorReceiver.*/
+    class FrameMirror{
+        public:
+        /*!
+            @param channel    Where the records are posted
+            @param budget_us  Longest time spent encoding each frame
+            @param reserve    Bytes of the channel left free for the other records
+        */
+        FrameMirror(TelemetryChannel* channel, uint32_t budget_us = 2000U, size_t reserve = 256U);
+        ~FrameMirror();
+        FrameMirror(const FrameMirror&) = delete;
+        FrameMirror& operator=(const FrameMirror&) = delete;
+
+        /*!
+            @brief Describe the frames to mirror, the whole frame is sent with the next one. UI::bindMirror() calls it
+            @param bits    Bits per pixel: 16 for RGB565, 8 for RGB332, 4 for a palette, 1 for two colors
+            @param stride  Bytes per line
+            @return False if the copy of the frame couldn't be allocated
+        */
+        bool begin(uint16_t width, uint16_t height, uint8_t bits, size_t stride);
+        //Set the colors of the indexed formats, they're sent again only if they changed
+        void setPalette(const uint16_t* colors, uint8_t count);
+        //Start a new frame, its changes can be captured in several bands
+        void nextFrame();
+        /*!
+            @brief Compare a band of the frame with the last one sent and post what changed
+            @param lines  The first line of the band, lines follow each other stride bytes apart
+            @param top    Row of the frame the band starts at
+            @param count  How many lines the band holds
+        */
+        void capture(const uint8_t* lines, uint16_t top, uint16_t count);
+        /*!
+            @brief Tell which lines changed, when it's already known (see DisplayTransport::onChangedLines)
+            Once useDirtyHints() is on, the lines that aren't marked are taken as unchanged and not even compared.
+        */
+        void markDirty(uint16_t y, uint16_t count);
+        inline void useDirtyHints(bool enabled){ m_hinted = enabled; }
+        //Send the whole frame again with the next capture, any task can call it
+        inline void resync(){ m_resync.store(true, std::memory_order_relaxed); }
+        //Stop or restart mirroring, any task can call it. A disabled mirror captures nothing, it resyncs when enabled again
+        void setEnabled(bool enabled);
+        inline bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        inline void setBudget(uint32_t budget_us){ m_budget = budget_us; }
+        inline uint32_t getBudget() const { return m_budget; }
+        inline const MirrorStats& getStats() const { return m_stats; }
+        //!@return True if every change captured so far was sent
+        bool isCaughtUp() const;
+
+        private:
+        void m_reset();
+        bool m_postInfo();
+        template<typename Unit> bool m_encodeLine(const uint8_t* line, uint16_t y, const uint8_t* band, uint16_t top);
+        bool m_op(MirrorCodec::Op op, size_t count, const uint8_t* values, size_t value_bytes, const uint8_t* band, uint16_t top);
+        bool m_flushSkip(const uint8_t* band, uint16_t top);
+        bool m_post(const uint8_t* band, uint16_t top);
+        static uint32_t m_now();
+
+        private:
+        TelemetryChannel* m_channel;
+        uint32_t m_budget;
+        size_t m_reserve;
+        uint8_t* m_reference = nullptr;   //The frame as the receiver has it
+        std::vector<uint8_t> m_pending;   //Lines that may differ from the reference
+        uint16_t m_width = 0, m_height = 0;
+        uint8_t m_bits = 16;
+        size_t m_stride = 0;
+        uint8_t m_unit = 2;               //Bytes per unit
+        uint16_t m_palette[16];
+        uint8_t m_palette_size = 0;
+        bool m_info_pending = false;
+        bool m_palette_pending = false;
+        bool m_hinted = false;
+        std::atomic<bool> m_resync{false};
+        std::atomic<bool> m_enabled{true};
+        uint16_t m_resume = 0;            //Line the last capture ran out of budget at, the next one starts there
+        uint32_t m_frame = 0;
+        uint32_t m_sequence = 0;          //Number of the next MirrorDelta since the last MirrorInfo
+        bool m_frame_counted = false;
+        MirrorStats m_stats;
+
+        //The record being built
+        uint8_t m_body[TelemetryCodec::max_payload];
+        size_t m_body_size = 0;
+        size_t m_start = 0;               //First unit of the frame the record covers
+        size_t m_cursor = 0;              //Unit the ops written so far reach
+        size_t m_skip = 0;                //Unchanged units waiting to be written, only if changes follow
+    };
+
+    /*Rebuilds the frames of a FrameMirror from the records of a TelemetryDecoder, on the computer watching.
+    Pixels are read back as RGB888 whatever the format mirrored.*/
+    class MirrorReceiver{
+        public:
+        /*!
+            @brief Apply a record, any record can be given, the ones that aren't about the mirror are ignored
+            @return True if the picture changed
+        */
+        bool apply(const TelemetryMessage& message);
+        //!@return True if the picture matches the board's, false until the first MirrorInfo and after a lost record
+        inline bool isSynced() const { return m_synced; }
+        inline uint16_t getWidth() const { return m_width; }
+        inline uint16_t getHeight() const { return m_height; }
+        inline uint8_t getBits() const { return m_bits; }
+        //!@return Frame number of the last change applied
+        inline uint32_t getFrame() const { return m_frame; }
+        //!@return Times a record was missing or malformed
+        inline uint32_t getLost() const { return m_lost; }
+        //Write a line of the picture as RGB888, 3 * getWidth() bytes
+        void readLine(uint16_t y, uint8_t* rgb) const;
+
+        private:
+        bool m_applyDelta(const TelemetryMessage& message);
+        void m_xor(size_t unit, uint32_t value);
+        void m_lose();
+
+        private:
+        std::vector<uint8_t> m_pixels;
+        uint16_t m_width = 0, m_height = 0;
+        uint8_t m_bits = 16;
+        size_t m_stride = 0;
+        uint16_t m_palette[16] = {0x0000, 0xFFFF};
+        uint32_t m_expected = 0;    //Sequence number of the next MirrorDelta
+        uint32_t m_frame = 0;
+        uint32_t m_lost = 0;
+        bool m_synced = false;
+    };
+
+}
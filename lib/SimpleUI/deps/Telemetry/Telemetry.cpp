@@ -0,0 +1,236 @@
+#include "Telemetry.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+namespace SimpleUI{
+
+    namespace TelemetryCodec{
+        size_t putVarint(uint8_t* out, uint32_t value){
+            size_t len = 0;
+            while(value >= 0x80){
+                out[len++] = static_cast<uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            out[len++] = static_cast<uint8_t>(value);
+            return len;
+        }
+
+        size_t getVarint(const uint8_t* in, size_t len, uint32_t& value){
+            value = 0;
+            for(size_t i = 0; i < len && i < 5; i++){
+                value |= static_cast<uint32_t>(in[i] & 0x7F) << (7 * i);
+                if(!(in[i] & 0x80))
+                    return i + 1;
+            }
+            return 0;
+        }
+
+        uint8_t crc8(const uint8_t* data, size_t len){
+            uint8_t crc = 0;
+            for(size_t i = 0; i < len; i++){
+                crc ^= data[i];
+                for(int bit = 0; bit < 8; bit++){
+                    crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+                }
+            }
+            return crc;
+        }
+
+        size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out){
+            size_t code_index = 0; //Where the length of the current block goes
+            size_t written = 1;
+            uint8_t code = 1;
+            for(size_t i = 0; i < len; i++){
+                if(in[i] != 0){
+                    out[written++] = in[i];
+                    code++;
+                }
+                if(in[i] == 0 || code == 0xFF){
+                    out[code_index] = code;
+                    code = 1;
+                    code_index = written++;
+                    if(in[i] != 0 && i + 1 == len) //A full block ending the input doesn't need an empty one after it
+                        return written - 1;
+                }
+            }
+            out[code_index] = code;
+            return written;
+        }
+
+        size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out){
+            size_t read = 0, written = 0;
+            while(read < len){
+                const uint8_t code = in[read++];
+                if(code == 0 || read + code - 1 > len)
+                    return 0;
+                for(uint8_t i = 1; i < code; i++){
+                    if(in[read] == 0)
+                        return 0;
+                    out[written++] = in[read++];
+                }
+                if(code != 0xFF && read < len)
+                    out[written++] = 0;
+            }
+            return written;
+        }
+    }
+
+//--------------------TelemetryRecord CLASS---------------------------------------------------------------//
+
+    TelemetryRecord::TelemetryRecord(TelemetryType type){
+        m_bytes[0] = static_cast<uint8_t>(type);
+        m_bytes[1] = 0; //How many numbers follow
+    }
+
+    TelemetryRecord& TelemetryRecord::number(uint32_t value){
+        if(m_has_text || m_bytes[1] >= max_numbers || m_size + 5 > max_payload){
+            m_truncated = true;
+            return *this;
+        }
+        m_size += TelemetryCodec::putVarint(m_bytes + m_size, value);
+        m_bytes[1]++;
+        return *this;
+    }
+
+    TelemetryRecord& TelemetryRecord::text(const char* value){
+        if(m_has_text || !value){
+            m_truncated = m_truncated || m_has_text;
+            return *this;
+        }
+        const size_t len = strlen(value);
+        const size_t kept = std::min(len, max_payload - m_size);
+        memcpy(m_bytes + m_size, value, kept);
+        m_size += kept;
+        m_has_text = true;
+        m_truncated = m_truncated || kept < len;
+        return *this;
+    }
+
+    TelemetryRecord TelemetryRecord::heap(){
+        TelemetryRecord record(TelemetryType::Heap);
+#if defined(ESP32)
+        record.number(heap_caps_get_free_size(MALLOC_CAP_8BIT))
+              .number(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT))
+              .number(heap_caps_get_total_size(MALLOC_CAP_8BIT));
+#else
+        record.number(0).number(0).number(0);
+#endif
+        return record;
+    }
+
+//--------------------TelemetryChannel CLASS---------------------------------------------------------------//
+
+    TelemetryChannel::TelemetryChannel(size_t capacity)
+    : m_ring(new uint8_t[capacity ? capacity : 1]), m_capacity(capacity ? capacity : 1)
+    {
+        //The stream opens with a delimiter, so whatever the link carried before (like boot messages) doesn't spoil the first record
+        m_ring[0] = TelemetryCodec::delimiter;
+        m_head.store(1, std::memory_order_relaxed);
+    }
+
+    TelemetryChannel::~TelemetryChannel(){
+        delete[] m_ring;
+    }
+
+    bool TelemetryChannel::post(const TelemetryRecord& record){
+        return post(record.getBytes(), record.size());
+    }
+
+    bool TelemetryChannel::post(const uint8_t* payload, size_t size){
+        if(size > TelemetryCodec::max_payload){
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint8_t raw[TelemetryCodec::max_payload + 1];
+        uint8_t encoded[encodedSize(TelemetryCodec::max_payload)];
+        memcpy(raw, payload, size);
+        raw[size] = TelemetryCodec::crc8(raw, size);
+        size_t len = TelemetryCodec::cobsEncode(raw, size + 1, encoded);
+        encoded[len++] = TelemetryCodec::delimiter;
+
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if(m_capacity - (head - tail) < len){
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const size_t start = head % m_capacity;
+        const size_t first = std::min(len, m_capacity - start);
+        memcpy(m_ring + start, encoded, first);
+        memcpy(m_ring, encoded + first, len - first);
+        m_head.store(head + len, std::memory_order_release);
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t TelemetryChannel::read(uint8_t* out, size_t max){
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t len = std::min(max, head - tail);
+        const size_t start = tail % m_capacity;
+        const size_t first = std::min(len, m_capacity - start);
+        memcpy(out, m_ring + start, first);
+        memcpy(out + first, m_ring, len - first);
+        m_tail.store(tail + len, std::memory_order_release);
+        return len;
+    }
+
+//--------------------TelemetryDecoder CLASS---------------------------------------------------------------//
+
+    void TelemetryDecoder::feed(const uint8_t* bytes, size_t len){
+        for(size_t i = 0; i < len; i++){
+            if(bytes[i] == TelemetryCodec::delimiter){
+                m_frame();
+                continue;
+            }
+            if(m_buffer.size() < TelemetryCodec::cobsBound(TelemetryCodec::max_payload + 1))
+                m_buffer.push_back(bytes[i]);
+            else
+                m_overflow = true;  //Not a record, zeros were lost. Dropped at the next delimiter
+        }
+    }
+
+    void TelemetryDecoder::m_frame(){
+        const bool valid_size = !m_overflow && !m_buffer.empty();
+        m_overflow = false;
+        if(!valid_size){
+            if(!m_buffer.empty())
+                m_corrupted++;
+            m_buffer.clear();
+            return;
+        }
+        m_decoded_buffer.resize(m_buffer.size());
+        const size_t len = TelemetryCodec::cobsDecode(m_buffer.data(), m_buffer.size(), m_decoded_buffer.data());
+        m_buffer.clear();
+        TelemetryMessage message;
+        if(len < 3 || TelemetryCodec::crc8(m_decoded_buffer.data(), len - 1) != m_decoded_buffer[len - 1]
+           || !parse(m_decoded_buffer.data(), len - 1, message)){
+            m_corrupted++;
+            return;
+        }
+        m_decoded++;
+        if(m_handler)
+            m_handler(message);
+    }
+
+    bool TelemetryDecoder::parse(const uint8_t* payload, size_t len, TelemetryMessage& message){
+        if(len < 2 || payload[1] > TelemetryRecord::max_numbers)
+            return false;
+        message.type = static_cast<TelemetryType>(payload[0]);
+        message.count = payload[1];
+        size_t read = 2;
+        for(size_t i = 0; i < message.count; i++){
+            const size_t used = TelemetryCodec::getVarint(payload + read, len - read, message.numbers[i]);
+            if(!used)
+                return false;
+            read += used;
+        }
+        message.text.assign(reinterpret_cast<const char*>(payload + read), len - read);
+        return true;
+    }
+
+}
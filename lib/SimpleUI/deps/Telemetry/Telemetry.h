@@ -0,0 +1,161 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Delegate.h"
+
+namespace SimpleUI{
+
+    //What a telemetry record reports, its numbers come in the order listed
+    enum class TelemetryType : uint8_t{
+        Hello = 0,      //Protocol version, uptime in ms, CPU frequency in MHz
+        Frame = 1,      //Frame number, render us, present us, smoothed frame us, worst frame us, quality, frames over budget
+        Heap = 2,       //Free bytes, lowest free bytes since boot, total bytes
+        Focus = 3,      //Type of the focused element, then its id as text
+        Animation = 4,  //State, 1 if the value grows, value in thousandths (zigzag encoded), then the id of the element as text
+        Perf = 5,       //Worst time in us, then the name of the function as text
+        Transport = 6,  //Frames, regions, command bytes, pixel bytes
+        MirrorInfo = 7,     //Width, height, bits per pixel, bytes per line. The mirrored frame starts over from black, see FrameMirror
+        MirrorPalette = 8,  //The RGB565 colors of the indexed formats as text, little endian
+        MirrorDelta = 9     //Sequence number, frame number, first unit, then the encoded changes as text
+    };
+
+    /*The wire format: every record is a type byte, a count of numbers, the numbers as LEB128 varints and optionally some text
+    running to the end. A CRC-8 of all that is appended, then the whole is COBS encoded so it has no zero byte and is followed by one.
+    A receiver can start listening at any time, or lose bytes, and pick up again at the next zero.*/
+    namespace TelemetryCodec{
+        constexpr uint8_t version = 1;
+        constexpr uint8_t delimiter = 0x00;
+        //Longest payload a record can have on the wire, its encoding then fits a single COBS block
+        constexpr size_t max_payload = 240;
+
+        //!@return How many bytes were written, at most 5
+        size_t putVarint(uint8_t* out, uint32_t value);
+        //!@return How many bytes were read, 0 if the varint is cut short or too long
+        size_t getVarint(const uint8_t* in, size_t len, uint32_t& value);
+        //Map signed numbers to unsigned ones so small negative values stay short
+        constexpr uint32_t zigzag(int32_t value){ return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+        constexpr int32_t unzigzag(uint32_t value){ return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1); }
+        //CRC-8 with the polynomial 0x07
+        uint8_t crc8(const uint8_t* data, size_t len);
+        //!@return The size of the longest encoding of len bytes
+        constexpr size_t cobsBound(size_t len){ return len + len / 254 + 1; }
+        //!@return How many bytes were written to out, which needs cobsBound(len) bytes. The delimiter isn't added
+        size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out);
+        //!@return How many bytes were written to out, which needs len bytes, 0 if the input isn't valid COBS
+        size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out);
+    }
+
+    //Builds the payload of a record, numbers first and the text last
+    class TelemetryRecord{
+        public:
+        static constexpr size_t max_payload = 64;
+        static constexpr size_t max_numbers = 12;
+        static_assert(max_payload <= TelemetryCodec::max_payload, "A record must fit on the wire");
+
+        explicit TelemetryRecord(TelemetryType type);
+        TelemetryRecord& number(uint32_t value);
+        TelemetryRecord& signedNumber(int32_t value){ return number(TelemetryCodec::zigzag(value)); }
+        //Set the text of the record, cut to what fits. Numbers can't be added after it
+        TelemetryRecord& text(const char* value);
+
+        //The heap of the chip: free bytes, lowest free bytes since boot and total bytes. All 0 where it can't be read
+        static TelemetryRecord heap();
+
+        inline const uint8_t* getBytes() const { return m_bytes; }
+        inline size_t size() const { return m_size; }
+        //!@return True if something didn't fit and was left out
+        inline bool isTruncated() const { return m_truncated; }
+
+        private:
+        uint8_t m_bytes[max_payload];
+        size_t m_size = 2;
+        bool m_has_text = false;
+        bool m_truncated = false;
+    };
+
+    /*Carries encoded records from the render core to the task that sends them, through a ring of bytes. post() never blocks or allocates:
+    a record that doesn't fit whole is dropped and counted, so a slow link costs records rather than frames.
+    One task posts and one task reads, they don't need a lock.*/
+    class TelemetryChannel{
+        public:
+        /*!
+            @param capacity  Size of the ring in bytes, a record takes a few bytes more than its payload
+        */
+        TelemetryChannel(size_t capacity = 1024U);
+        ~TelemetryChannel();
+        TelemetryChannel(const TelemetryChannel&) = delete;
+        TelemetryChannel& operator=(const TelemetryChannel&) = delete;
+
+        //!@return False if the record was dropped for lack of room
+        bool post(const TelemetryRecord& record);
+        /*!
+            @brief Post a payload built by hand, for records larger than a TelemetryRecord holds
+            @param len  Up to TelemetryCodec::max_payload bytes
+            @return False if the record was dropped for lack of room or was too long
+        */
+        bool post(const uint8_t* payload, size_t len);
+        /*!
+            @brief Take encoded bytes out of the ring, whole records or not, to be written to the link
+            @return How many bytes were copied
+        */
+        size_t read(uint8_t* out, size_t max);
+        //!@return How many bytes wait to be read
+        inline size_t getPending() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+        //!@return How many bytes can still be posted
+        inline size_t getFree() const { return m_capacity - getPending(); }
+        //!@return How many bytes a payload takes in the ring once encoded
+        static constexpr size_t encodedSize(size_t len){ return TelemetryCodec::cobsBound(len + 1) + 1; }
+        inline uint32_t getPosted() const { return m_posted.load(std::memory_order_relaxed); }
+        inline uint32_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        private:
+        uint8_t* m_ring;
+        size_t m_capacity;
+        std::atomic<size_t> m_head{0};  //Bytes ever written, only the poster moves it
+        std::atomic<size_t> m_tail{0};  //Bytes ever read, only the reader moves it
+        std::atomic<uint32_t> m_posted{0};
+        std::atomic<uint32_t> m_dropped{0};
+    };
+
+    //A record read back from the wire
+    struct TelemetryMessage{
+        TelemetryType type;
+        uint32_t numbers[TelemetryRecord::max_numbers];
+        size_t count = 0;
+        std::string text;
+    };
+
+    //Finds the records in a stream of bytes, whatever way it's cut, and hands over the valid ones
+    class TelemetryDecoder{
+        public:
+        using Handler = Delegate<void(const TelemetryMessage& message)>;
+
+        TelemetryDecoder(const Handler& handler = nullptr) : m_handler(handler){}
+        inline void onMessage(const Handler& handler){ m_handler = handler; }
+        void feed(const uint8_t* bytes, size_t len);
+        /*!
+            @brief Read the payload of a record, once decoded and checked
+            @return False if it's malformed
+        */
+        static bool parse(const uint8_t* payload, size_t len, TelemetryMessage& message);
+
+        inline uint32_t getDecoded() const { return m_decoded; }
+        //!@return Frames that failed to decode, the first one is usually cut if listening started mid stream
+        inline uint32_t getCorrupted() const { return m_corrupted; }
+
+        private:
+        void m_frame();
+
+        private:
+        Handler m_handler;
+        std::vector<uint8_t> m_buffer;
+        std::vector<uint8_t> m_decoded_buffer;
+        bool m_overflow = false;
+        uint32_t m_decoded = 0;
+        uint32_t m_corrupted = 0;
+    };
+
+}
@@ -1,4 +1,6 @@
 #include "Texture.h"
+#include <algorithm>
+#include <new>
 
 const float Fmap(const float x, const float in_min, const float in_max, const float out_min, const float out_max)
 {
@@ -7,25 +9,21 @@ const float Fmap(const float x, const float in_min, const float in_max, const fl
 const float Flerp(const float v0, const float v1, const float t) {
   return (1 - t) * v0 + t * v1;
 }
-bool dirtyRects(Texture first, Texture second){
+bool dirtyRects(Texture& first, const Texture& second){
     if(!(first.width == second.width && first.height == second.height && first.data.colorspace == second.data.colorspace)) return false;
+    if(!first.data.mono || !second.data.mono || first.getStride() != first.width || second.getStride() != second.width) return false;
     bool areDifferent=true;
-    size_t len = first.width * first.height;
-    switch(first.data.colorspace){
-        case PixelType::Mono:
-        for(size_t i = 0; i<len; i++){
-            if(first.data.mono[i] != second.data.mono[i]){
-                areDifferent=false;
-                first.data.mono[i] = second.data.mono[i];
-            }
-        }
-        break;
-
-        case PixelType::RGB565:
-        for(size_t i = 0; i<len; i++){
-            if(first.data.mono[i] != second.data.mono[i]){
+    //Compared as bytes, the alpha plane of an RGB565A4 texture follows its colors
+    const size_t color_len = first.data.colorspace == PixelType::Mono ? Texture::getArrSize8(first.width, first.height, 1.0f)
+                                                                       : Texture::getArrSize16(first.width, first.height, 1.0f) * 2;
+    uint8_t* planes[2] = {first.data.mono, first.data.alpha};
+    const uint8_t* sources[2] = {second.data.mono, second.data.alpha};
+    const size_t lengths[2] = {color_len, first.data.colorspace == PixelType::RGB565A4 ? (size_t)Texture::getArrSize4(first.width, first.height, 1.0f) : 0};
+    for(int plane = 0; plane < 2; plane++){
+        for(size_t i = 0; i < lengths[plane]; i++){
+            if(planes[plane][i] != sources[plane][i]){
                 areDifferent=false;
-                first.data.mono[i] = second.data.mono[i];
+                planes[plane][i] = sources[plane][i];
             }
         }
     }
@@ -70,19 +68,193 @@ int Texture::getArrSize8(int width, int height, float scale_fac) {
 int Texture::getArrSize16 (int width, int height, float scale_fac){
     return (static_cast<int>(width * scale_fac) * static_cast<int>(height * scale_fac));
     }
+int Texture::getArrSize4(int width, int height, float scale_fac) {
+        int w = static_cast<int>(width * scale_fac);
+        int h = static_cast<int>(height * scale_fac);
+        return ((w + 1) / 2) * h;  // two pixels per byte
+    }
+
+size_t Texture::getByteSize(unsigned int w, unsigned int h, PixelType type){
+    switch(type){
+        case PixelType::Mono:     return getArrSize8(w, h, 1.0f);
+        case PixelType::RGB565:   return getArrSize16(w, h, 1.0f) * 2;
+        case PixelType::RGB565A4: return getArrSize16(w, h, 1.0f) * 2 + getArrSize4(w, h, 1.0f);
+    }
+    return 0;
+}
+
+//--------------------OwnedTexture CLASS---------------------------------------------------------------//
+
+OwnedTexture::OwnedTexture(unsigned int w, unsigned int h, PixelType type){
+    const size_t bytes = getByteSize(w, h, type);
+    m_pixels = bytes ? new (std::nothrow) uint8_t[bytes]() : nullptr;
+    if(!m_pixels)
+        return;
+    width = w;
+    height = h;
+    data.colorspace = type;
+    data.mono = m_pixels;   //The colors of RGB565 textures too, new[] aligns the buffer for any type
+    if(type == PixelType::RGB565A4)
+        data.alpha = m_pixels + getArrSize16(w, h, 1.0f) * 2;  //The alpha plane follows the colors in the same buffer
+}
+
+OwnedTexture& OwnedTexture::operator=(OwnedTexture&& other) noexcept {
+    if(this != &other){
+        m_free();
+        Texture::operator=(other);
+        m_pixels = other.m_pixels;
+        other.m_forget();
+    }
+    return *this;
+}
+
+void OwnedTexture::m_free(){
+    delete[] m_pixels;
+    m_forget();
+}
+
+void OwnedTexture::m_forget(){
+    m_pixels = nullptr;
+    Texture::operator=(Texture());
+}
+
+//--------------------SharedTexture CLASS---------------------------------------------------------------//
+
+SharedTexture::SharedTexture(OwnedTexture&& owned){
+    if(!owned.ownsPixels()){ //Nothing to free, the handle is a plain view
+        Texture::operator=(owned);
+        return;
+    }
+    m_owner = std::make_shared<const OwnedTexture>(std::move(owned));
+    Texture::operator=(*m_owner);
+}
+
+SharedTexture& SharedTexture::operator=(SharedTexture&& other) noexcept {
+    if(this != &other){
+        Texture::operator=(other);
+        m_owner = std::move(other.m_owner);
+        static_cast<Texture&>(other) = Texture();
+    }
+    return *this;
+}
 
-const Texture scale(Texture& input, const float scaling_factor){
+Texture Texture::view(const Texture& source, unsigned int x, unsigned int y, unsigned int w, unsigned int h){
+    if(!source.data.mono || x + w > source.width || y + h > source.height)
+        return Texture(w, h, static_cast<uint8_t*>(nullptr));
+    const unsigned int pitch = source.getStride();
+    Texture result;
+    switch(source.data.colorspace){
+        case PixelType::Mono:
+            if(x % 8 != 0)
+                return Texture(w, h, static_cast<uint8_t*>(nullptr));
+            result = Texture(w, h, source.data.mono + y * ((pitch + 7) / 8) + x / 8);
+            break;
+        case PixelType::RGB565:
+            result = Texture(w, h, source.data.rgb565 + y * pitch + x);
+            break;
+        case PixelType::RGB565A4:
+            if(x % 2 != 0)
+                return Texture(w, h, static_cast<uint8_t*>(nullptr));
+            result = Texture(w, h, source.data.rgb565 + y * pitch + x, source.data.alpha + y * ((pitch + 1) / 2) + x / 2);
+            break;
+    }
+    result.stride = pitch;
+    return result;
+}
+
+TextureAtlas::TextureAtlas(const Texture& sheet, uint16_t cell_width, uint16_t cell_height, size_t count)
+: m_sheet(sheet), m_cells(nullptr), m_cell_width(cell_width), m_cell_height(cell_height)
+{
+    m_columns = cell_width ? sheet.width / cell_width : 0;
+    const size_t capacity = cell_height ? size_t(m_columns) * (sheet.height / cell_height) : 0;
+    m_count = (count && count < capacity) ? count : capacity;
+}
+
+Texture TextureAtlas::cell(size_t index) const {
+    if(index >= m_count)
+        return Texture();
+    if(m_cells){
+        const AtlasCell& area = m_cells[index];
+        return Texture::view(m_sheet, area.x, area.y, area.w, area.h);
+    }
+    return Texture::view(m_sheet, (index % m_columns) * m_cell_width, (index / m_columns) * m_cell_height, m_cell_width, m_cell_height);
+}
+
+//--------------------TextureTransform CLASS---------------------------------------------------------------//
+
+static int32_t toFixed(float value){
+    return static_cast<int32_t>(lroundf(value * 65536.0f));
+}
+
+TextureTransform TextureTransform::translation(float x, float y){
+    TextureTransform result;
+    result.tx = toFixed(x);
+    result.ty = toFixed(y);
+    return result;
+}
+
+TextureTransform TextureTransform::scaling(float sx, float sy){
+    TextureTransform result;
+    result.a = toFixed(sx);
+    result.d = toFixed(sy);
+    return result;
+}
+
+TextureTransform TextureTransform::rotation(float radians){
+    const float cos_r = cosf(radians), sin_r = sinf(radians);
+    TextureTransform result;
+    result.a = toFixed(cos_r);
+    result.b = toFixed(-sin_r);
+    result.c = toFixed(sin_r);
+    result.d = toFixed(cos_r);
+    return result;
+}
+
+TextureTransform TextureTransform::place(float pivot_x, float pivot_y, float x, float y, float radians, float sx, float sy){
+    return translation(-pivot_x, -pivot_y).then(scaling(sx, sy)).then(rotation(radians)).then(translation(x, y));
+}
+
+TextureTransform TextureTransform::then(const TextureTransform& next) const {
+    auto mul = [](int32_t p, int32_t q){ return static_cast<int32_t>((static_cast<int64_t>(p) * q) >> 16); };
+    TextureTransform result;
+    result.a = mul(next.a, a) + mul(next.b, c);
+    result.b = mul(next.a, b) + mul(next.b, d);
+    result.c = mul(next.c, a) + mul(next.d, c);
+    result.d = mul(next.c, b) + mul(next.d, d);
+    result.tx = mul(next.a, tx) + mul(next.b, ty) + next.tx;
+    result.ty = mul(next.c, tx) + mul(next.d, ty) + next.ty;
+    return result;
+}
+
+bool TextureTransform::inverse(TextureTransform& result) const {
+    const float fa = a / 65536.0f, fb = b / 65536.0f, fc = c / 65536.0f, fd = d / 65536.0f;
+    const float det = fa * fd - fb * fc;
+    if (fabsf(det) < 1.0f / 4096.0f)
+        return false;
+    const float ia = fd / det, ib = -fb / det, ic = -fc / det, id = fa / det;
+    const float ftx = tx / 65536.0f, fty = ty / 65536.0f;
+    result.a = toFixed(ia);
+    result.b = toFixed(ib);
+    result.c = toFixed(ic);
+    result.d = toFixed(id);
+    result.tx = toFixed(-(ia * ftx + ib * fty));
+    result.ty = toFixed(-(ic * ftx + id * fty));
+    return true;
+}
+
+OwnedTexture scale(const Texture& input, const float scaling_factor, bool filtered){
     if (scaling_factor == 1.0f)
-        return input;
+        return OwnedTexture(input);
     const unsigned int scaled_width = static_cast<const unsigned int>(input.width * scaling_factor);
     const unsigned int scaled_height = static_cast<const unsigned int>(input.height * scaling_factor);
 
     if(input.data.colorspace==PixelType::Mono){
-        const size_t outputArrSize = Texture::getArrSize8(scaled_width, scaled_height, 1.0f);
-        uint8_t *buffer = new uint8_t[outputArrSize];
-        std::fill(buffer, buffer + outputArrSize, 0);
+        OwnedTexture result(scaled_width, scaled_height, PixelType::Mono);
+        uint8_t *buffer = result.data.mono;
+        if (!buffer)
+            return result;
 
-        const int in_row_bytes = (input.width + 7) / 8;
+        const int in_row_bytes = (input.getStride() + 7) / 8;
         const int out_row_bytes = (scaled_width + 7) / 8;
         const float inv_scaling = 1.0f / scaling_factor;
 
@@ -107,21 +279,51 @@ const Texture scale(Texture& input, const float scaling_factor){
                 }
             }
         }
-        return Texture(scaled_width, scaled_height, std::move(buffer), true);
+        return result;
     }
     else{
-        size_t outputArrSize = Texture::getArrSize16(scaled_width, scaled_height, 1.0f);
-        uint16_t *buffer = new uint16_t[outputArrSize];
+        const bool hasAlpha = input.data.colorspace == PixelType::RGB565A4;
+        OwnedTexture result(scaled_width, scaled_height, input.data.colorspace);
+        uint16_t *buffer = result.data.rgb565;
+        uint8_t *alpha = result.data.alpha;
+        if (!buffer)
+            return result;
+        const int out_alpha_row = (scaled_width + 1) / 2;
+        const unsigned int pitch = input.getStride();
 
         const float inv_scaling = 1.0f / scaling_factor;
+        //Source position of the output pixel centers in 16.16 fixed point, for the filtered path
+        const int32_t step = static_cast<int32_t>(inv_scaling * 65536.0f);
+        const int32_t origin = step / 2 - 32768;
         for (unsigned int y = 0; y < scaled_height; y++){
             unsigned const int src_y = static_cast<unsigned int>(y * inv_scaling);
+            const int32_t fy = std::max<int32_t>(0, origin + static_cast<int32_t>(y) * step);
+            const unsigned int y0 = std::min<unsigned int>(fy >> 16, input.height - 1);
+            const unsigned int y1 = std::min(y0 + 1, input.height - 1);
+            const uint32_t wy = (fy >> 11) & 0x1F;
 
             for (unsigned int x = 0; x < scaled_width; x++){
                 unsigned const int src_x = static_cast<unsigned int>(x * inv_scaling);
-                buffer[y * scaled_width + x] = input.data.rgb565[(src_y * input.width) + src_x];
+                if (filtered){
+                    const int32_t fx = std::max<int32_t>(0, origin + static_cast<int32_t>(x) * step);
+                    const unsigned int x0 = std::min<unsigned int>(fx >> 16, input.width - 1);
+                    const unsigned int x1 = std::min(x0 + 1, input.width - 1);
+                    const uint32_t wx = (fx >> 11) & 0x1F;
+                    //Channels spread apart as in 00000gggggg00000rrrrr000000bbbbb, two 5 bit weights keep each one within its gap
+                    auto spread = [](uint16_t c){ return (c | (uint32_t(c) << 16)) & 0x07E0F81F; };
+                    const uint32_t top = spread(input.data.rgb565[y0 * pitch + x0]) * (32 - wx) + spread(input.data.rgb565[y0 * pitch + x1]) * wx;
+                    const uint32_t bottom = spread(input.data.rgb565[y1 * pitch + x0]) * (32 - wx) + spread(input.data.rgb565[y1 * pitch + x1]) * wx;
+                    const uint32_t mixed = (((top >> 5) & 0x07E0F81F) * (32 - wy) + ((bottom >> 5) & 0x07E0F81F) * wy) >> 5 & 0x07E0F81F;
+                    buffer[y * scaled_width + x] = static_cast<uint16_t>(mixed | (mixed >> 16));
+                }
+                else
+                    buffer[y * scaled_width + x] = input.data.rgb565[(src_y * pitch) + src_x];
+                if (hasAlpha){
+                    const uint8_t opacity = input.data.getAlpha(src_x, src_y, pitch);
+                    alpha[y * out_alpha_row + x / 2] |= (x & 1) ? opacity : (opacity << 4);
+                }
             }
         }
-        return Texture(scaled_width, scaled_height, std::move(buffer), true);
+        return result;
     }
 }
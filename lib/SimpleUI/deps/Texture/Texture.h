@@ -3,9 +3,10 @@
 #include <math.h>
 #include <Arduino.h>
 #include <string.h>
+#include <memory>
 
 
-enum class PixelType{Mono=1, RGB565=16};
+enum class PixelType{Mono=1, RGB565=16, RGB565A4=20};
 
 //A wrapper for supporting multiple data types used in the Texture structure
 struct TextureData{
@@ -14,40 +15,203 @@ struct TextureData{
         uint8_t* mono;
         uint16_t* rgb565;
     };
+    uint8_t* alpha = nullptr;   //Only for RGB565A4, 4 bits of opacity per pixel, two pixels per byte with the left one in the high nibble
     TextureData() : colorspace(PixelType::Mono), mono(nullptr) {}
     TextureData(PixelType type, uint8_t *input) : colorspace(type), mono(input) {}
     TextureData(PixelType type, uint16_t *input) : colorspace(type), rgb565(input) {}
+    TextureData(PixelType type, uint16_t *input, uint8_t *opacity) : colorspace(type), rgb565(input), alpha(opacity) {}
+
+    /*!
+        @return The opacity of a pixel of an RGB565A4 texture, from 0 (transparent) to 15 (opaque)
+        @param stride  Pixels per row of the data, the width unless the texture is a view
+    */
+    inline uint8_t getAlpha(unsigned int x, unsigned int y, unsigned int stride) const {
+        const uint8_t byte = alpha[y * ((stride + 1) / 2) + x / 2];
+        return (x & 1) ? (byte & 0x0F) : (byte >> 4);
+    }
 };
 
-//A useful and versatile image wrapper that holds dimensions and a pointer to an array of any supported colorspace
+class OwnedTexture;
+class SharedTexture;
+
+/*A useful and versatile image wrapper that holds dimensions and a pointer to an array of any supported colorspace.
+A Texture never owns its pixels: it's a view over an array that lives elsewhere, usually in flash, so copying one is cheap and never frees anything.
+Pixels allocated at runtime are owned by an OwnedTexture, or by a SharedTexture when several holders need them.*/
 struct Texture{
     unsigned int width, height;
     TextureData data;
+    unsigned int stride = 0;    //Pixels per row of the data when it's wider than the texture, like in a view of an atlas. 0 if the rows are packed
 
-    Texture(unsigned int w=0, unsigned int h=0, uint8_t* input=nullptr, bool owner = false) : width(w), height(h), data(PixelType::Mono, input), ownsData(owner){}
-    Texture(unsigned int w, unsigned int h, uint16_t *input, bool owner = false) : width(w), height(h), data(PixelType::RGB565, input), ownsData(owner) {}
-    Texture(unsigned int w, unsigned int h, const uint8_t *input, bool owner = false) : width(w), height(h), data(PixelType::Mono, (uint8_t *)input), ownsData(owner) {}
-    Texture(unsigned int w, unsigned int h, const uint16_t *input, bool owner = false) : width(w), height(h), data(PixelType::RGB565, (uint16_t *)input), ownsData(owner) {}
+    Texture(unsigned int w=0, unsigned int h=0, uint8_t* input=nullptr) : width(w), height(h), data(PixelType::Mono, input){}
+    Texture(unsigned int w, unsigned int h, uint16_t *input) : width(w), height(h), data(PixelType::RGB565, input) {}
+    Texture(unsigned int w, unsigned int h, const uint8_t *input) : width(w), height(h), data(PixelType::Mono, (uint8_t *)input) {}
+    Texture(unsigned int w, unsigned int h, const uint16_t *input) : width(w), height(h), data(PixelType::RGB565, (uint16_t *)input) {}
+    Texture(unsigned int w, unsigned int h, uint16_t *input, uint8_t *alpha) : width(w), height(h), data(PixelType::RGB565A4, input, alpha) {}
+    Texture(unsigned int w, unsigned int h, const uint16_t *input, const uint8_t *alpha) : width(w), height(h), data(PixelType::RGB565A4, (uint16_t *)input, (uint8_t *)alpha) {}
+    Texture(const Texture&) = default;
+    Texture& operator=(const Texture&) = default;
+    //A view of a temporary that owns its pixels would dangle as soon as the statement ends, keep the owner in a variable instead
+    Texture(OwnedTexture&&) = delete;
+    Texture(SharedTexture&&) = delete;
+    Texture& operator=(OwnedTexture&&) = delete;
+    Texture& operator=(SharedTexture&&) = delete;
     TextureData getData(){return data;}
+    //!@return Pixels per row of the data
+    inline unsigned int getStride() const { return stride ? stride : width; }
+    //!@return How many bytes the pixels of a packed texture of this size and colorspace take, the alpha plane included
+    static size_t getByteSize(unsigned int w, unsigned int h, PixelType type);
+    /*!
+        @brief Show part of a texture without copying its pixels, the view is valid as long as the source's pixels are
+        A monochrome area has to start on a multiple of 8 pixels and an RGB565A4 one on an even pixel, as pixels share their bytes
+        @return The view, a texture without pixels if the area isn't inside the source or isn't aligned
+    */
+    static Texture view(const Texture& source, unsigned int x, unsigned int y, unsigned int w, unsigned int h);
     static int getArrSize8(int width, int height, float scale_fac);
     static int getArrSize16 (int width, int height, float scale_fac);
+    static int getArrSize4(int width, int height, float scale_fac);
+};
+
+/*A texture that owns the buffers of its pixels and frees them when it's destroyed. It can be moved but not copied,
+so a buffer always has exactly one owner; passing it where a Texture is expected hands out a view that must not outlive it.
+One built from a Texture wraps it without owning anything, which lets scale() return its input when there's nothing to do.*/
+class OwnedTexture : public Texture{
+    public:
+    OwnedTexture() = default;
+    //Wrap pixels owned by someone else
+    explicit OwnedTexture(const Texture& view) : Texture(view){}
+    /*!
+        @brief Allocate the pixels of a texture, cleared to 0
+        @return A texture without pixels if the allocation failed
+    */
+    OwnedTexture(unsigned int w, unsigned int h, PixelType type);
+    OwnedTexture(OwnedTexture&& other) noexcept : Texture(other), m_pixels(other.m_pixels){ other.m_forget(); }
+    OwnedTexture& operator=(OwnedTexture&& other) noexcept;
+    OwnedTexture(const OwnedTexture&) = delete;
+    OwnedTexture& operator=(const OwnedTexture&) = delete;
+    ~OwnedTexture(){ m_free(); }
+
+    //!@return False if the pixels belong to someone else
+    inline bool ownsPixels() const { return m_pixels != nullptr; }
+
+    private:
+    void m_free();
+    void m_forget();
+
+    private:
+    uint8_t* m_pixels = nullptr;    //Every colorspace is allocated as bytes with the alpha plane after the colors, so a single delete[] frees it all
+};
+
+/*A handle on pixels shared by several holders, which are freed with the last handle. Copying a handle only counts one more holder,
+so a texture can be kept alive by whoever still draws it, after the cache that made it moved on. The count is atomic,
+handles may be copied and dropped from different tasks.*/
+class SharedTexture : public Texture{
+    public:
+    SharedTexture() = default;
+    //Take over the pixels of an owned texture, one that only wraps a view gives a handle that counts nothing
+    explicit SharedTexture(OwnedTexture&& owned);
+    SharedTexture(const SharedTexture& other) : Texture(other), m_owner(other.m_owner){}
+    SharedTexture(SharedTexture&& other) noexcept : Texture(other), m_owner(std::move(other.m_owner)){ static_cast<Texture&>(other) = Texture(); }
+    SharedTexture& operator=(const SharedTexture& other){ Texture::operator=(other); m_owner = other.m_owner; return *this; }
+    SharedTexture& operator=(SharedTexture&& other) noexcept;
+
+    //!@return How many handles share the pixels, 0 if the handle doesn't own them
+    inline long getHolders() const { return m_owner.use_count(); }
 
-    ~Texture(){
-        if (ownsData) {
-            switch (data.colorspace) {
-                case PixelType::Mono:   delete[] data.mono;   break;
-                case PixelType::RGB565: delete[] data.rgb565; break;
-            }
-        }
-    }
     private:
-    bool ownsData = false;
+    std::shared_ptr<const OwnedTexture> m_owner;
+};
+
+//A rectangle of a texture atlas
+struct AtlasCell{
+    uint16_t x, y, w, h;
+};
+
+/*Many images packed in a single texture, so the frames of an animated icon share one array in flash and one Texture.
+The cells are drawn through views of the sheet, which never copy pixels. Cells are either listed one by one,
+usually in a constexpr array next to the sheet, or laid out as a grid of equal cells read from left to right and top to bottom.*/
+class TextureAtlas{
+    public:
+    /*!
+        @param sheet  The texture holding every cell, it must outlive the atlas
+        @param cells  Where each image is in the sheet, the array must outlive the atlas
+        @param count  How many cells there are
+    */
+    TextureAtlas(const Texture& sheet, const AtlasCell* cells, size_t count) : m_sheet(sheet), m_cells(cells), m_count(count){}
+    /*!
+        @param sheet        The texture holding every cell, it must outlive the atlas
+        @param cell_width   Width of every cell
+        @param cell_height  Height of every cell
+        @param count        How many cells are used, 0 for every cell of the grid
+    */
+    TextureAtlas(const Texture& sheet, uint16_t cell_width, uint16_t cell_height, size_t count = 0);
+
+    //!@return A view of a cell, a texture without pixels if the index is out of range
+    Texture cell(size_t index) const;
+    inline size_t size() const { return m_count; }
+    inline const Texture& getSheet() const { return m_sheet; }
+
+    private:
+    const Texture& m_sheet;
+    const AtlasCell* m_cells;   //nullptr for a grid
+    size_t m_count;
+    uint16_t m_cell_width = 0, m_cell_height = 0;
+    uint16_t m_columns = 0;
+};
+
+//How a transformed texture is sampled
+enum class TextureSampling{
+    Nearest,    //The source pixel under the center of each screen pixel
+    Bilinear    //A mix of the four nearest source pixels, monochrome textures get antialiased edges where the canvas can be read back
+};
+
+/*A 2x3 affine matrix that places a texture on the screen: a texture point (u, v) lands on
+x = a*u + b*v + tx, y = c*u + d*v + ty. The coefficients are in 16.16 fixed point so drawing only adds integers per pixel,
+floats are used once when the matrix is built. Transforms are chained with then(), the left one being applied first.*/
+struct TextureTransform{
+    int32_t a = 65536, b = 0, c = 0, d = 65536;
+    int32_t tx = 0, ty = 0;
+
+    //The identity, built by the helpers below rather than from braces so {x, y} keeps meaning a Point in drawTexture() calls
+    TextureTransform(){}
+
+    static TextureTransform translation(float x, float y);
+    //A negative factor mirrors the texture along that axis
+    static TextureTransform scaling(float sx, float sy);
+    //Clockwise on screen, as the y axis points down
+    static TextureTransform rotation(float radians);
+    /*!
+        @brief The usual transform of a dial or an icon: scale and rotate a texture around a point of it, then put that point on the screen
+        @param pivot_x  Point of the texture the rotation happens around, in texture pixels
+        @param pivot_y
+        @param x        Where the pivot lands on the screen
+        @param y
+        @param radians  Clockwise rotation
+        @param sx       Horizontal scale, negative to mirror
+        @param sy       Vertical scale, negative to flip
+    */
+    static TextureTransform place(float pivot_x, float pivot_y, float x, float y, float radians = 0.0f, float sx = 1.0f, float sy = 1.0f);
+
+    //!@return This transform followed by next
+    TextureTransform then(const TextureTransform& next) const;
+    /*!
+        @brief Compute the transform going from the screen back to the texture
+        @return False if the matrix squashes the texture to a line or a point, it can't be drawn then
+    */
+    bool inverse(TextureTransform& result) const;
 };
 
 void transferFrame(uint16_t* emitter, uint16_t* receiver, size_t len);
-bool dirtyRects(Texture first, Texture second);
+/*!
+    @brief Copy the pixels of second that differ into first, both must have the same size and colorspace
+    @return False if a pixel was copied, or if the textures don't match
+*/
+bool dirtyRects(Texture& first, const Texture& second);
 const float Fmap(const float x, const float in_min, const float in_max, const float out_min, const float out_max);
 const float Flerp(const float v0, const float v1, const float t);
-const Texture scale(Texture &input, const float scaling_factor);
+/*!
+    @brief Scale a texture, the result owns a new buffer unless the factor is 1, then it's a view of the input
+    @param filtered  Interpolate RGB565 pixels bilinearly instead of picking the nearest one, it's about four times slower
+*/
+OwnedTexture scale(const Texture &input, const float scaling_factor, bool filtered = false);
 const uint16_t rgb565(unsigned int r, unsigned int g, unsigned int b);
 const uint16_t hex(std::string hex);
\ No newline at end of file
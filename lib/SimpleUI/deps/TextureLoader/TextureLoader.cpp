@@ -0,0 +1,861 @@
+#include "TextureLoader.h"
+#include <new>
+#include <algorithm>
+#include <stdlib.h>
+#ifndef ARDUINO
+#include <stdio.h>
+#endif
+
+namespace SimpleUI{
+
+//--------------------AssetSource CLASSES---------------------------------------------------------------//
+
+#ifdef ARDUINO
+    class FSAssetFile : public AssetFile{
+        public:
+        FSAssetFile(fs::File file) : m_file(file){}
+        ~FSAssetFile(){ m_file.close(); }
+        size_t read(uint8_t* dst, size_t len) override { return m_file.read(dst, len); }
+
+        private:
+        fs::File m_file;
+    };
+
+    std::unique_ptr<AssetFile> FSAssetSource::open(const std::string& path){
+        fs::File file = m_fs.open(path.c_str(), "r");
+        if(!file || file.isDirectory())
+            return nullptr;
+        return std::unique_ptr<AssetFile>(new FSAssetFile(file));
+    }
+#else
+    class HostAssetFile : public AssetFile{
+        public:
+        HostAssetFile(FILE* file) : m_file(file){}
+        ~HostAssetFile(){ fclose(m_file); }
+        size_t read(uint8_t* dst, size_t len) override { return fread(dst, 1, len, m_file); }
+
+        private:
+        FILE* m_file;
+    };
+
+    std::unique_ptr<AssetFile> DirectoryAssetSource::open(const std::string& path){
+        const std::string full_path = path.empty() || path[0] != '/' ? m_root + "/" + path : m_root + path;
+        FILE* file = fopen(full_path.c_str(), "rb");
+        if(!file)
+            return nullptr;
+        return std::unique_ptr<AssetFile>(new HostAssetFile(file));
+    }
+#endif
+
+//--------------------DECODERS---------------------------------------------------------------//
+
+    namespace{
+        //Reads a file a few bytes at a time, so the decoders can ask for single bytes cheaply
+        class ByteReader{
+            public:
+            ByteReader(AssetFile& file) : m_file(file){}
+
+            //!@return The next byte, -1 at the end of the file
+            inline int next(){
+                if(m_pos == m_len){
+                    m_len = m_file.read(m_buffer, sizeof(m_buffer));
+                    m_pos = 0;
+                    if(m_len == 0)
+                        return -1;
+                }
+                return m_buffer[m_pos++];
+            }
+            bool read(uint8_t* dst, size_t len){
+                for(size_t i = 0; i < len; i++){
+                    const int byte = next();
+                    if(byte < 0)
+                        return false;
+                    dst[i] = byte;
+                }
+                return true;
+            }
+            bool skip(size_t len){
+                for(size_t i = 0; i < len; i++){
+                    if(next() < 0)
+                        return false;
+                }
+                return true;
+            }
+            bool readU32(uint32_t& value){
+                uint8_t bytes[4];
+                if(!read(bytes, 4))
+                    return false;
+                value = (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | bytes[3];
+                return true;
+            }
+
+            private:
+            AssetFile& m_file;
+            uint8_t m_buffer[64];
+            size_t m_pos = 0;
+            size_t m_len = 0;
+        };
+
+        //Everything known about an image before its pixels are decoded
+        struct ImageInfo{
+            ImageFormat format = ImageFormat::Unknown;
+            uint32_t width = 0, height = 0;
+            bool has_alpha = false;
+            //PNG only
+            uint8_t depth = 0, color_type = 0, channels = 0;
+            uint8_t palette[256][4];
+            unsigned int palette_size = 0;
+            bool has_key = false;
+            uint16_t key[3] = {0, 0, 0};  //Transparent color of grey and RGB images
+            uint32_t idat_length = 0;     //Length of the first IDAT chunk, the reader is at its data
+        };
+
+        //Fills the texture buffers a pixel at a time
+        struct PixelWriter{
+            uint16_t* pixels;
+            uint8_t* alpha;     //nullptr if the texture is opaque
+            uint32_t width;
+
+            inline void write(uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a){
+                pixels[y * width + x] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+                if(alpha){
+                    uint8_t& byte = alpha[y * ((width + 1) / 2) + x / 2];
+                    byte = (x & 1) ? ((byte & 0xF0) | (a >> 4)) : ((byte & 0x0F) | (a & 0xF0));
+                }
+            }
+        };
+
+        const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+        bool readQoiHeader(ByteReader& reader, ImageInfo& info){
+            uint8_t channels[2];
+            if(!reader.readU32(info.width) || !reader.readU32(info.height) || !reader.read(channels, 2))
+                return false;
+            info.has_alpha = channels[0] == 4;
+            return channels[0] == 3 || channels[0] == 4;
+        }
+
+        //Reads the chunks before the image data, the reader is left at the start of the first IDAT
+        bool readPngHeader(ByteReader& reader, ImageInfo& info){
+            uint32_t length, type;
+            uint8_t ihdr[5];
+            if(!reader.readU32(length) || !reader.readU32(type) || type != 0x49484452 || length != 13)
+                return false;
+            if(!reader.readU32(info.width) || !reader.readU32(info.height) || !reader.read(ihdr, 5) || !reader.skip(4))
+                return false;
+            info.depth = ihdr[0];
+            info.color_type = ihdr[1];
+            if(ihdr[2] != 0 || ihdr[3] != 0 || ihdr[4] != 0) //Only deflate, the standard filters and no interlacing
+                return false;
+
+            switch(info.color_type){
+                case 0: info.channels = 1; break;
+                case 2: info.channels = 3; break;
+                case 3: info.channels = 1; break;
+                case 4: info.channels = 2; info.has_alpha = true; break;
+                case 6: info.channels = 4; info.has_alpha = true; break;
+                default: return false;
+            }
+            const bool valid_depth = info.color_type == 0 || info.color_type == 3 ? (info.depth == 1 || info.depth == 2 || info.depth == 4 || info.depth == 8)
+                                                                                  : info.depth == 8;
+            if(!valid_depth || (info.color_type == 3 && info.depth > 8))
+                return false;
+
+            while(reader.readU32(length) && reader.readU32(type)){
+                if(type == 0x49444154){ //IDAT
+                    info.idat_length = length;
+                    return true;
+                }
+                if(type == 0x504C5445){ //PLTE
+                    info.palette_size = std::min<uint32_t>(length / 3, 256);
+                    for(unsigned int i = 0; i < info.palette_size; i++){
+                        if(!reader.read(info.palette[i], 3))
+                            return false;
+                        info.palette[i][3] = 0xFF;
+                    }
+                    if(!reader.skip(length - info.palette_size * 3 + 4))
+                        return false;
+                }
+                else if(type == 0x74524E53){ //tRNS
+                    info.has_alpha = true;
+                    if(info.color_type == 3){
+                        for(uint32_t i = 0; i < length; i++){
+                            const int value = reader.next();
+                            if(value < 0)
+                                return false;
+                            if(i < 256)
+                                info.palette[i][3] = value;
+                        }
+                        length = 0;
+                    }
+                    else{
+                        info.has_key = true;
+                        for(uint32_t i = 0; i + 1 < length && i < 6; i += 2){
+                            const int high = reader.next();
+                            const int low = reader.next();
+                            info.key[i / 2] = (high << 8) | low;
+                        }
+                        length = length > 6 ? length - 6 : length & 1;
+                    }
+                    if(!reader.skip(length + 4))
+                        return false;
+                }
+                else if(!reader.skip(length + 4)){
+                    return false;
+                }
+            }
+            return false;
+        }
+
+        bool readInfo(ByteReader& reader, ImageInfo& info){
+            uint8_t header[8];
+            if(!reader.read(header, 4))
+                return false;
+            if(memcmp(header, "qoif", 4) == 0){
+                info.format = ImageFormat::QOI;
+                return readQoiHeader(reader, info);
+            }
+            if(!reader.read(header + 4, 4) || memcmp(header, PNG_SIGNATURE, 8) != 0)
+                return false;
+            info.format = ImageFormat::PNG;
+            return readPngHeader(reader, info);
+        }
+
+        bool decodeQoi(ByteReader& reader, const ImageInfo& info, PixelWriter& out){
+            uint8_t index[64][4] = {};
+            uint8_t px[4] = {0, 0, 0, 255};
+            unsigned int run = 0;
+
+            for(uint32_t y = 0; y < info.height; y++){
+                for(uint32_t x = 0; x < info.width; x++){
+                    if(run > 0){
+                        run--;
+                    }
+                    else{
+                        const int b1 = reader.next();
+                        if(b1 < 0)
+                            return false;
+                        if(b1 == 0xFE){
+                            if(!reader.read(px, 3))
+                                return false;
+                        }
+                        else if(b1 == 0xFF){
+                            if(!reader.read(px, 4))
+                                return false;
+                        }
+                        else{
+                            switch(b1 & 0xC0){
+                                case 0x00:
+                                    memcpy(px, index[b1], 4);
+                                    break;
+                                case 0x40:
+                                    px[0] += ((b1 >> 4) & 0x03) - 2;
+                                    px[1] += ((b1 >> 2) & 0x03) - 2;
+                                    px[2] += (b1 & 0x03) - 2;
+                                    break;
+                                case 0x80:{
+                                    const int b2 = reader.next();
+                                    if(b2 < 0)
+                                        return false;
+                                    const int dg = (b1 & 0x3F) - 32;
+                                    px[0] += dg - 8 + ((b2 >> 4) & 0x0F);
+                                    px[1] += dg;
+                                    px[2] += dg - 8 + (b2 & 0x0F);
+                                    break;
+                                }
+                                default:
+                                    run = b1 & 0x3F;
+                                    break;
+                            }
+                        }
+                        memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+                    }
+                    out.write(x, y, px[0], px[1], px[2], px[3]);
+                }
+            }
+            return true;
+        }
+
+        //Hands over the bytes of consecutive IDAT chunks as a single stream
+        class IdatStream{
+            public:
+            IdatStream(ByteReader& reader, uint32_t first_length) : m_reader(reader), m_remaining(first_length){}
+
+            inline int next(){
+                while(m_remaining == 0){
+                    uint32_t type;
+                    if(m_ended || !m_reader.skip(4) || !m_reader.readU32(m_remaining) || !m_reader.readU32(type) || type != 0x49444154){
+                        m_ended = true;
+                        return -1;
+                    }
+                }
+                m_remaining--;
+                return m_reader.next();
+            }
+
+            private:
+            ByteReader& m_reader;
+            uint32_t m_remaining;
+            bool m_ended = false;
+        };
+
+        //Canonical Huffman code, decoded a bit at a time
+        struct Huffman{
+            uint16_t counts[16];
+            uint16_t symbols[288];
+        };
+
+        //A deflate decoder that writes straight into the whole output, which doubles as its window
+        class Inflater{
+            public:
+            Inflater(IdatStream& input, uint8_t* out, size_t out_len) : m_in(input), m_out(out), m_out_len(out_len){}
+
+            bool run(){
+                int final_block;
+                do{
+                    final_block = m_bits(1);
+                    const int type = m_bits(2);
+                    bool ok;
+                    if(type == 0)
+                        ok = m_stored();
+                    else if(type == 1)
+                        ok = m_fixed();
+                    else if(type == 2)
+                        ok = m_dynamic();
+                    else
+                        ok = false;
+                    if(!ok || m_error)
+                        return false;
+                } while(!final_block);
+                return m_pos == m_out_len;
+            }
+
+            private:
+            int m_bits(int count){
+                uint32_t value = m_bitbuf;
+                while(m_bitcount < count){
+                    const int byte = m_in.next();
+                    if(byte < 0){
+                        m_error = true;
+                        return 0;
+                    }
+                    value |= uint32_t(byte) << m_bitcount;
+                    m_bitcount += 8;
+                }
+                m_bitbuf = value >> count;
+                m_bitcount -= count;
+                return value & ((1u << count) - 1);
+            }
+
+            int m_decode(const Huffman& h){
+                int code = 0, first = 0, index = 0;
+                for(int len = 1; len < 16; len++){
+                    code |= m_bits(1);
+                    const int count = h.counts[len];
+                    if(code - count < first)
+                        return h.symbols[index + (code - first)];
+                    index += count;
+                    first += count;
+                    first <<= 1;
+                    code <<= 1;
+                }
+                m_error = true;
+                return -1;
+            }
+
+            static bool m_build(Huffman& h, const uint8_t* lengths, int n){
+                uint16_t offsets[16];
+                memset(h.counts, 0, sizeof(h.counts));
+                for(int i = 0; i < n; i++)
+                    h.counts[lengths[i]]++;
+                h.counts[0] = 0;
+                offsets[1] = 0;
+                for(int len = 1; len < 15; len++)
+                    offsets[len + 1] = offsets[len] + h.counts[len];
+                for(int i = 0; i < n; i++){
+                    if(lengths[i])
+                        h.symbols[offsets[lengths[i]]++] = i;
+                }
+                return true;
+            }
+
+            bool m_stored(){
+                m_bitbuf = 0;
+                m_bitcount = 0;
+                const int len_low = m_in.next(), len_high = m_in.next();
+                const int nlen_low = m_in.next(), nlen_high = m_in.next();
+                if(nlen_high < 0)
+                    return false;
+                const unsigned int len = len_low | (len_high << 8);
+                if(len != (~(nlen_low | (nlen_high << 8)) & 0xFFFF) || m_pos + len > m_out_len)
+                    return false;
+                for(unsigned int i = 0; i < len; i++){
+                    const int byte = m_in.next();
+                    if(byte < 0)
+                        return false;
+                    m_out[m_pos++] = byte;
+                }
+                return true;
+            }
+
+            bool m_fixed(){
+                Huffman lit, dist;
+                uint8_t lengths[288];
+                for(int i = 0; i < 144; i++) lengths[i] = 8;
+                for(int i = 144; i < 256; i++) lengths[i] = 9;
+                for(int i = 256; i < 280; i++) lengths[i] = 7;
+                for(int i = 280; i < 288; i++) lengths[i] = 8;
+                m_build(lit, lengths, 288);
+                for(int i = 0; i < 30; i++) lengths[i] = 5;
+                m_build(dist, lengths, 30);
+                return m_codes(lit, dist);
+            }
+
+            bool m_dynamic(){
+                static const uint8_t ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+                const int nlen = m_bits(5) + 257;
+                const int ndist = m_bits(5) + 1;
+                const int ncode = m_bits(4) + 4;
+                if(nlen > 286 || ndist > 30)
+                    return false;
+
+                uint8_t lengths[320] = {};
+                for(int i = 0; i < ncode; i++)
+                    lengths[ORDER[i]] = m_bits(3);
+                Huffman code_lengths;
+                m_build(code_lengths, lengths, 19);
+
+                int index = 0;
+                while(index < nlen + ndist){
+                    int symbol = m_decode(code_lengths);
+                    if(symbol < 0 || m_error)
+                        return false;
+                    if(symbol < 16){
+                        lengths[index++] = symbol;
+                        continue;
+                    }
+                    uint8_t value = 0;
+                    int repeat;
+                    if(symbol == 16){
+                        if(index == 0)
+                            return false;
+                        value = lengths[index - 1];
+                        repeat = 3 + m_bits(2);
+                    }
+                    else if(symbol == 17)
+                        repeat = 3 + m_bits(3);
+                    else
+                        repeat = 11 + m_bits(7);
+                    if(index + repeat > nlen + ndist)
+                        return false;
+                    while(repeat--)
+                        lengths[index++] = value;
+                }
+                if(lengths[256] == 0)
+                    return false;
+
+                Huffman lit, dist;
+                m_build(lit, lengths, nlen);
+                m_build(dist, lengths + nlen, ndist);
+                return m_codes(lit, dist);
+            }
+
+            bool m_codes(const Huffman& lit, const Huffman& dist){
+                static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+                static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+                static const uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+                static const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+                while(true){
+                    const int symbol = m_decode(lit);
+                    if(symbol < 0 || m_error)
+                        return false;
+                    if(symbol == 256)
+                        return true;
+                    if(symbol < 256){
+                        if(m_pos >= m_out_len)
+                            return false;
+                        m_out[m_pos++] = symbol;
+                        continue;
+                    }
+                    const int length_code = symbol - 257;
+                    if(length_code >= 29)
+                        return false;
+                    const size_t length = LENGTH_BASE[length_code] + m_bits(LENGTH_EXTRA[length_code]);
+                    const int dist_code = m_decode(dist);
+                    if(dist_code < 0 || dist_code >= 30)
+                        return false;
+                    const size_t distance = DIST_BASE[dist_code] + m_bits(DIST_EXTRA[dist_code]);
+                    if(m_error || distance > m_pos || m_pos + length > m_out_len)
+                        return false;
+                    for(size_t i = 0; i < length; i++, m_pos++)
+                        m_out[m_pos] = m_out[m_pos - distance];
+                }
+            }
+
+            private:
+            IdatStream& m_in;
+            uint8_t* m_out;
+            size_t m_out_len;
+            size_t m_pos = 0;
+            uint32_t m_bitbuf = 0;
+            int m_bitcount = 0;
+            bool m_error = false;
+        };
+
+        inline uint8_t paeth(int a, int b, int c){
+            const int p = a + b - c;
+            const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+            if(pa <= pb && pa <= pc)
+                return a;
+            return pb <= pc ? b : c;
+        }
+
+        bool decodePng(ByteReader& reader, const ImageInfo& info, PixelWriter& out){
+            if(info.color_type == 3 && info.palette_size == 0)
+                return false;
+            const size_t stride = (size_t(info.width) * info.channels * info.depth + 7) / 8;
+            const size_t raw_len = (stride + 1) * info.height;
+            std::unique_ptr<uint8_t[]> raw(new (std::nothrow) uint8_t[raw_len]);
+            if(!raw)
+                return false;
+
+            IdatStream idat(reader, info.idat_length);
+            //Skip the zlib header, a preset dictionary is never used by PNG
+            const int cmf = idat.next();
+            const int flags = idat.next();
+            if(flags < 0 || (cmf & 0x0F) != 8 || (flags & 0x20))
+                return false;
+            Inflater inflater(idat, raw.get(), raw_len);
+            if(!inflater.run())
+                return false;
+
+            const size_t bpp = std::max<size_t>(1, info.channels * info.depth / 8);
+            const uint8_t* previous = nullptr;
+            for(uint32_t y = 0; y < info.height; y++){
+                uint8_t* line = raw.get() + y * (stride + 1);
+                const uint8_t filter = line[0];
+                line++;
+                for(size_t i = 0; i < stride; i++){
+                    const uint8_t a = i >= bpp ? line[i - bpp] : 0;
+                    const uint8_t b = previous ? previous[i] : 0;
+                    const uint8_t c = previous && i >= bpp ? previous[i - bpp] : 0;
+                    switch(filter){
+                        case 0: break;
+                        case 1: line[i] += a; break;
+                        case 2: line[i] += b; break;
+                        case 3: line[i] += (a + b) / 2; break;
+                        case 4: line[i] += paeth(a, b, c); break;
+                        default: return false;
+                    }
+                }
+                previous = line;
+
+                for(uint32_t x = 0; x < info.width; x++){
+                    uint8_t r, g, b, a = 0xFF;
+                    if(info.depth < 8){ //Grey or palette packed in 1, 2 or 4 bits, leftmost pixel in the high bits
+                        const unsigned int per_byte = 8 / info.depth;
+                        const unsigned int shift = (per_byte - 1 - x % per_byte) * info.depth;
+                        const uint8_t value = (line[x / per_byte] >> shift) & ((1 << info.depth) - 1);
+                        if(info.color_type == 3){
+                            if(value >= info.palette_size)
+                                return false;
+                            const uint8_t* entry = info.palette[value];
+                            r = entry[0]; g = entry[1]; b = entry[2]; a = entry[3];
+                        }
+                        else{
+                            r = g = b = value * 255 / ((1 << info.depth) - 1);
+                            if(info.has_key && value == info.key[0])
+                                a = 0;
+                        }
+                    }
+                    else{
+                        const uint8_t* p = line + x * info.channels;
+                        switch(info.color_type){
+                            case 0:
+                                r = g = b = p[0];
+                                if(info.has_key && p[0] == info.key[0]) a = 0;
+                                break;
+                            case 2:
+                                r = p[0]; g = p[1]; b = p[2];
+                                if(info.has_key && r == info.key[0] && g == info.key[1] && b == info.key[2]) a = 0;
+                                break;
+                            case 3:{
+                                if(p[0] >= info.palette_size)
+                                    return false;
+                                const uint8_t* entry = info.palette[p[0]];
+                                r = entry[0]; g = entry[1]; b = entry[2]; a = entry[3];
+                                break;
+                            }
+                            case 4: r = g = b = p[0]; a = p[1]; break;
+                            default: r = p[0]; g = p[1]; b = p[2]; a = p[3]; break;
+                        }
+                    }
+                    out.write(x, y, r, g, b, a);
+                }
+            }
+            return true;
+        }
+    }
+
+//--------------------TextureLoader CLASS---------------------------------------------------------------//
+
+    TextureLoader::TextureLoader(AssetSource& source, size_t budget, AssetStore* store)
+    : m_source(source), m_store(store ? store : &AssetStore::shared()), m_budget(budget)
+    {}
+
+    ImageFormat TextureLoader::detectFormat(const uint8_t* header, size_t len){
+        if(len >= 4 && memcmp(header, "qoif", 4) == 0)
+            return ImageFormat::QOI;
+        if(len >= 8 && memcmp(header, PNG_SIGNATURE, 8) == 0)
+            return ImageFormat::PNG;
+        return ImageFormat::Unknown;
+    }
+
+    TextureLoader::Entry* TextureLoader::m_find(const std::string& path){
+        for(auto& entry : m_entries){
+            if(entry->path == path)
+                return entry.get();
+        }
+        return nullptr;
+    }
+
+    const TextureLoader::Entry* TextureLoader::m_find(const Texture* texture) const {
+        for(const auto& entry : m_entries){
+            if(entry->texture.get() == texture)
+                return entry.get();
+        }
+        return nullptr;
+    }
+
+    Texture* TextureLoader::load(const std::string& path, const Scene* scene){
+        std::unique_lock<std::mutex> lock(m_lock);
+        Entry* entry = m_find(path);
+        if(!entry){
+            //The file is read without the lock, another task may add the same path meanwhile
+            lock.unlock();
+            std::unique_ptr<Entry> created(new Entry());
+            created->path = path;
+            if(!m_readHeader(*created))
+                return nullptr;
+            lock.lock();
+            entry = m_find(path);
+            if(!entry){
+                m_entries.push_back(std::move(created));
+                entry = m_entries.back().get();
+            }
+        }
+
+        if(scene)
+            entry->scenes.insert(scene);
+        else
+            entry->always_resident = true;
+        entry->last_use = ++m_use_counter;
+
+        if(!entry->pixels.ownsPixels() && m_isPinned(*entry) && !m_decode(*entry, lock))
+            return nullptr;
+        return entry->texture.get();
+    }
+
+    void TextureLoader::activate(const Scene* scene){
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_active.insert(scene);
+        const uint32_t use = ++m_use_counter;
+        //By index, the lock is let go while decoding and other tasks may add entries
+        for(size_t i = 0; i < m_entries.size(); i++){
+            Entry& entry = *m_entries[i];
+            if(entry.scenes.count(scene)){
+                entry.last_use = use;
+                if(!entry.pixels.ownsPixels())
+                    m_decode(entry, lock);
+            }
+        }
+    }
+
+    void TextureLoader::deactivate(const Scene* scene){
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_active.erase(scene);
+        m_use_counter++;
+        for(auto& entry : m_entries){
+            if(entry->scenes.count(scene))
+                entry->last_use = m_use_counter;
+        }
+    }
+
+    bool TextureLoader::isResident(const Texture* texture) const {
+        std::lock_guard<std::mutex> lock(m_lock);
+        const Entry* entry = m_find(texture);
+        return entry && entry->pixels.ownsPixels();
+    }
+
+    bool TextureLoader::isReady(const Scene* scene) const {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for(const auto& entry : m_entries){
+            if(!entry->pixels.ownsPixels() && entry->scenes.count(scene))
+                return false;
+        }
+        return true;
+    }
+
+    size_t TextureLoader::preload(const Scene* scene, size_t budget, const std::atomic<bool>* cancel){
+        std::vector<Entry*> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            for(auto& entry : m_entries){
+                if(!entry->pixels.ownsPixels() && entry->scenes.count(scene))
+                    pending.push_back(entry.get());
+            }
+        }
+
+        size_t decoded = 0;
+        for(Entry* entry : pending){
+            if(cancel && cancel->load())
+                break;
+            std::unique_lock<std::mutex> lock(m_lock);
+            if(entry->pixels.ownsPixels() || entry->decoding || decoded + entry->bytes > budget)
+                continue;
+            if(getUsage() + entry->bytes > m_budget && !m_hasPooled(*entry->texture))
+                continue;
+            if(m_decode(*entry, lock)){
+                entry->last_use = ++m_use_counter;
+                decoded += entry->bytes;
+            }
+        }
+        return decoded;
+    }
+
+    void TextureLoader::trim(){
+        std::lock_guard<std::mutex> lock(m_lock);
+        for(auto& entry : m_entries){
+            if(entry->pixels.ownsPixels() && !m_isPinned(*entry))
+                m_evict(*entry);
+        }
+        m_pool.clear();
+        m_pooled_bytes = 0;
+    }
+
+    bool TextureLoader::m_isPinned(const Entry& entry) const {
+        if(entry.always_resident)
+            return true;
+        for(const Scene* scene : entry.scenes){
+            if(m_active.count(scene))
+                return true;
+        }
+        return false;
+    }
+
+    //A pooled texture is reused only by one of the same size and colorspace, so it always describes what it holds
+    bool TextureLoader::m_hasPooled(const Texture& shape) const {
+        for(const auto& pooled : m_pool){
+            if(pooled.width == shape.width && pooled.height == shape.height && pooled.data.colorspace == shape.data.colorspace)
+                return true;
+        }
+        return false;
+    }
+
+    bool TextureLoader::m_readHeader(Entry& entry){
+        std::unique_ptr<AssetFile> file = m_source.open(entry.path);
+        if(!file)
+            return false;
+        ByteReader reader(*file);
+        std::unique_ptr<ImageInfo> info(new ImageInfo());
+        if(!readInfo(reader, *info) || info->width == 0 || info->height == 0 || info->width > 4096 || info->height > 4096)
+            return false;
+
+        const PixelType type = info->has_alpha ? PixelType::RGB565A4 : PixelType::RGB565;
+        entry.has_alpha = info->has_alpha;
+        entry.bytes = Texture::getByteSize(info->width, info->height, type);
+        //Not resident yet, the texture has its size but no pixels
+        entry.texture.reset(new Texture(info->width, info->height, static_cast<uint16_t*>(nullptr)));
+        entry.texture->data.colorspace = type;
+        return true;
+    }
+
+    /*Decode a texture into pixels taken from the budget. The lock is held to take the pixels and to publish them, the file is read
+    and decoded without it. Whoever asks for the same texture meanwhile waits for this decode instead of starting another one*/
+    bool TextureLoader::m_decode(Entry& entry, std::unique_lock<std::mutex>& lock){
+        if(entry.decoding){
+            m_decoded.wait(lock, [&entry]{ return !entry.decoding; });
+            return entry.pixels.ownsPixels();
+        }
+        OwnedTexture pixels = m_allocate(entry);
+        if(!pixels.ownsPixels())
+            return false;
+        entry.decoding = true;
+        m_resident_bytes += entry.bytes;    //Counted already, so others leave room for it
+        lock.unlock();
+
+        const unsigned int width = entry.texture->width, height = entry.texture->height;
+        bool decoded = false;
+        std::unique_ptr<AssetFile> file = m_source.open(entry.path);
+        if(file){
+            ByteReader reader(*file);
+            std::unique_ptr<ImageInfo> info(new ImageInfo()); //The palette is too big for the stack of a small task
+            if(readInfo(reader, *info) && info->width == width && info->height == height && info->has_alpha == entry.has_alpha){
+                PixelWriter writer{pixels.data.rgb565, pixels.data.alpha, info->width};
+                decoded = info->format == ImageFormat::QOI ? decodeQoi(reader, *info, writer) : decodePng(reader, *info, writer);
+            }
+        }
+
+        lock.lock();
+        entry.decoding = false;
+        if(decoded){
+            entry.pixels = std::move(pixels);
+            entry.texture->data = entry.pixels.data;
+            m_decodes++;
+        }
+        else{
+            m_resident_bytes -= entry.bytes;
+            m_release(std::move(pixels));
+        }
+        m_decoded.notify_all();
+        return decoded;
+    }
+
+    //Find room for a texture: reuse a pooled one of the same size, or free pooled ones and evict textures until it fits
+    OwnedTexture TextureLoader::m_allocate(const Entry& loading){
+        const Texture& shape = *loading.texture;
+        while(true){
+            for(auto it = m_pool.begin(); it != m_pool.end(); it++){
+                if(it->width == shape.width && it->height == shape.height && it->data.colorspace == shape.data.colorspace){
+                    OwnedTexture pixels = std::move(*it);
+                    m_pooled_bytes -= loading.bytes;
+                    m_pool.erase(it);
+                    return pixels;
+                }
+            }
+            if(getUsage() + loading.bytes <= m_budget)
+                break;
+
+            if(!m_pool.empty()){
+                m_pooled_bytes -= Texture::getByteSize(m_pool.front().width, m_pool.front().height, m_pool.front().data.colorspace);
+                m_pool.erase(m_pool.begin());
+                continue;
+            }
+
+            Entry* oldest = nullptr;
+            for(auto& entry : m_entries){
+                if(entry.get() != &loading && entry->pixels.ownsPixels() && !m_isPinned(*entry) && (!oldest || entry->last_use < oldest->last_use))
+                    oldest = entry.get();
+            }
+            if(!oldest) //Everything resident is visible, going over the budget is better than not showing it
+                break;
+            m_evict(*oldest);
+        }
+        return OwnedTexture(shape.width, shape.height, shape.data.colorspace);
+    }
+
+    void TextureLoader::m_evict(Entry& entry){
+        m_store->releaseScaled(*entry.texture);
+        m_resident_bytes -= entry.bytes;
+        m_release(std::move(entry.pixels));
+        entry.texture->data.rgb565 = nullptr;
+        entry.texture->data.alpha = nullptr;
+    }
+
+    void TextureLoader::m_release(OwnedTexture&& pixels){
+        m_pooled_bytes += Texture::getByteSize(pixels.width, pixels.height, pixels.data.colorspace);
+        m_pool.push_back(std::move(pixels));
+    }
+
+}
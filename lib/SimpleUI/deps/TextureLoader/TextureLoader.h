@@ -0,0 +1,162 @@
+#pragma once
+#include "Texture.h"
+#include "Assets.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#ifdef ARDUINO
+#include <FS.h>
+#endif
+
+namespace SimpleUI{
+
+    class Scene;
+
+    //A file opened by an AssetSource, read front to back
+    class AssetFile{
+        public:
+        virtual ~AssetFile() = default;
+        /*!
+            @brief Read the next bytes of the file
+            @return How many bytes were read, less than len only at the end of the file
+        */
+        virtual size_t read(uint8_t* dst, size_t len) = 0;
+    };
+
+    //Where the TextureLoader finds its files
+    class AssetSource{
+        public:
+        virtual ~AssetSource() = default;
+        //!@return The opened file, nullptr if it doesn't exist
+        virtual std::unique_ptr<AssetFile> open(const std::string& path) = 0;
+    };
+
+#ifdef ARDUINO
+    //Reads the assets from a flash filesystem, LittleFS and SPIFFS both work
+    class FSAssetSource : public AssetSource{
+        public:
+        //The filesystem must already be mounted
+        FSAssetSource(fs::FS& filesystem) : m_fs(filesystem){}
+        std::unique_ptr<AssetFile> open(const std::string& path) override;
+
+        private:
+        fs::FS& m_fs;
+    };
+#else
+    //Reads the assets from a directory of the host, stands in for the flash filesystem when the UI runs on a computer
+    class DirectoryAssetSource : public AssetSource{
+        public:
+        //@param root The directory paths are relative to, it plays the role of the root of the flash partition
+        DirectoryAssetSource(const std::string& root) : m_root(root){}
+        std::unique_ptr<AssetFile> open(const std::string& path) override;
+
+        private:
+        std::string m_root;
+    };
+#endif
+
+    enum class ImageFormat{Unknown, QOI, PNG};
+
+    /*Decodes QOI and PNG files into textures on demand, so images don't have to be compiled into the firmware.
+    Textures are RGB565, or RGB565A4 if the image has an alpha channel. Their pixels are OwnedTextures kept by the loader,
+    which are recycled through a pool when a texture is evicted and reused by the next texture of the same size.
+
+    A texture loaded for a scene is resident only while a UI shows that scene, or until the byte budget needs its space back:
+    when the budget is exceeded the least recently shown textures of inactive scenes are evicted first.
+    Evicted textures keep their size, so the layout doesn't change, and are decoded again the next time their scene is shown.
+    Textures loaded without a scene are always resident.
+
+    QOI is decoded while it's read. PNG needs a buffer as big as the raw image while it's inflated, QOI is the better choice on small targets.
+    Interlaced PNGs and 16 bit channels are not supported.
+    Every public method can be called from any task, a decode blocks the other callers only for the texture being decoded.*/
+    class TextureLoader{
+        public:
+        /*!
+            @param source  Where the files are read from
+            @param budget  How many bytes the pixels of the resident textures and the pool are allowed to use
+            @param store   The asset store whose scaled copies are dropped when a texture is evicted, AssetStore::shared() if nullptr
+        */
+        TextureLoader(AssetSource& source, size_t budget = 32768U, AssetStore* store = nullptr);
+
+        /*!
+            @brief Get the texture of a file, the same one for every request of the same path
+            @param path   The file, .qoi or .png
+            @param scene  The scene that shows the texture, nullptr to keep it always resident
+            @return The texture, nullptr if the file doesn't exist or can't be decoded. It stays valid as long as the loader exists,
+            but its pixels are available only while it's resident
+        */
+        Texture* load(const std::string& path, const Scene* scene = nullptr);
+
+        //Make the textures of a scene resident and keep them from being evicted, it's done by the UI the loader is bound to
+        void activate(const Scene* scene);
+        //Let the textures of a scene be evicted when the budget needs it
+        void deactivate(const Scene* scene);
+        /*!
+            @brief Decode the textures of a scene before it's shown, using only the free part of the budget: nothing is evicted
+            Preloaded textures stay evictable until the scene is activated. Safe to call from another task.
+            @param scene   The scene whose textures are decoded
+            @param budget  How many bytes can be decoded at most
+            @param cancel  Checked before every texture, the preload stops as soon as it's set
+            @return How many bytes were decoded
+        */
+        size_t preload(const Scene* scene, size_t budget, const std::atomic<bool>* cancel = nullptr);
+        //!@return True if the pixels of the texture are in memory
+        bool isResident(const Texture* texture) const;
+        //!@return True if every texture loaded for the scene is resident
+        bool isReady(const Scene* scene) const;
+
+        //Evict every texture that isn't needed by an active scene and empty the pool
+        void trim();
+        inline void setBudget(size_t bytes){ m_budget = bytes; }
+        //!@return How many bytes are used by resident textures and pooled buffers
+        inline size_t getUsage() const { return m_resident_bytes + m_pooled_bytes; }
+        inline size_t getResidentBytes() const { return m_resident_bytes; }
+        //!@return How many times a file was decoded, reloads after an eviction included
+        inline uint32_t getDecodeCount() const { return m_decodes; }
+
+        //!@return The format of a file, recognized by its first bytes
+        static ImageFormat detectFormat(const uint8_t* header, size_t len);
+
+        private:
+        struct Entry{
+            std::string path;
+            std::unique_ptr<Texture> texture;
+            std::set<const Scene*> scenes;  //The scenes that show the texture
+            bool always_resident = false;   //Loaded without a scene at least once
+            OwnedTexture pixels;            //What the texture shows, without pixels if evicted
+            size_t bytes = 0;
+            uint32_t last_use = 0;
+            bool has_alpha = false;
+            bool decoding = false;          //A task is decoding the texture without holding the lock
+        };
+        Entry* m_find(const std::string& path);
+        const Entry* m_find(const Texture* texture) const;
+        bool m_isPinned(const Entry& entry) const;
+        bool m_hasPooled(const Texture& shape) const;
+        bool m_readHeader(Entry& entry);
+        bool m_decode(Entry& entry, std::unique_lock<std::mutex>& lock);
+        OwnedTexture m_allocate(const Entry& loading);
+        void m_evict(Entry& entry);
+        void m_release(OwnedTexture&& pixels);
+
+        private:
+        mutable std::mutex m_lock;          //Guards the entries and the pool, it's not held while a file is decoded
+        std::condition_variable m_decoded;  //Notified when a decode is over
+        AssetSource& m_source;
+        AssetStore* m_store;
+        std::vector<std::unique_ptr<Entry>> m_entries;
+        std::vector<OwnedTexture> m_pool;
+        std::set<const Scene*> m_active;
+        size_t m_budget;
+        size_t m_resident_bytes = 0;
+        size_t m_pooled_bytes = 0;
+        uint32_t m_use_counter = 0;
+        uint32_t m_decodes = 0;
+    };
+
+}
@@ -0,0 +1,470 @@
+#include "Transport.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+namespace SimpleUI{
+
+    static uint8_t* allocateTransfer(size_t bytes){
+#if defined(ESP32)
+        return static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_DMA));
+#else
+        return new uint8_t[bytes];
+#endif
+    }
+
+    static void releaseTransfer(uint8_t* buffer){
+#if defined(ESP32)
+        heap_caps_free(buffer);
+#else
+        delete[] buffer;
+#endif
+    }
+
+    //What a region costs on the wire: the three window commands with their parameters, then two bytes per pixel
+    static uint32_t regionCost(uint32_t w, uint32_t h){
+        return 11U + w * h * 2U;
+    }
+
+    //Commands take their parameters as big endian 16 bit values, the byte received sets one half of one of them
+    static void setParameter(uint16_t* values, size_t parameter, uint8_t byte){
+        uint16_t& value = values[parameter / 2];
+        value = (parameter % 2) ? static_cast<uint16_t>((value & 0xFF00) | byte) : static_cast<uint16_t>(byte << 8);
+    }
+
+//--------------------SPIDisplayBus CLASS---------------------------------------------------------------//
+
+#ifdef ARDUINO
+    SPIDisplayBus::SPIDisplayBus(SPIClass& spi, int8_t dc, int8_t cs, uint32_t frequency)
+    : m_spi(spi), m_dc(dc), m_cs(cs), m_frequency(frequency){}
+
+    void SPIDisplayBus::begin(){
+        if(!m_pins_ready){ //Not in the constructor, a global bus would be built before the board is ready
+            pinMode(m_dc, OUTPUT);
+            if(m_cs >= 0)
+                pinMode(m_cs, OUTPUT);
+            m_pins_ready = true;
+        }
+        m_spi.beginTransaction(SPISettings(m_frequency, MSBFIRST, SPI_MODE0));
+        if(m_cs >= 0)
+            digitalWrite(m_cs, LOW);
+    }
+
+    void SPIDisplayBus::command(uint8_t cmd){
+        digitalWrite(m_dc, LOW);
+        m_spi.write(cmd);
+        digitalWrite(m_dc, HIGH);
+    }
+
+    void SPIDisplayBus::data(const uint8_t* bytes, size_t len){
+        m_spi.writeBytes(bytes, len);
+    }
+
+    void SPIDisplayBus::end(){
+        if(m_cs >= 0)
+            digitalWrite(m_cs, HIGH);
+        m_spi.endTransaction();
+    }
+#endif
+
+//--------------------RecordingBus CLASS---------------------------------------------------------------//
+
+    void RecordingBus::data(const uint8_t* bytes, size_t len){
+        for(size_t i = 0; i < len; i++){
+            m_stream.push_back(Byte{bytes[i], false});
+        }
+    }
+
+    void RecordingBus::clear(){
+        m_stream.clear();
+        m_commands = 0;
+        m_transactions = 0;
+    }
+
+    size_t RecordingBus::replay(uint16_t* panel, uint16_t width, uint16_t height, uint16_t* shown) const {
+        uint16_t cols[2] = {0, 0}, rows[2] = {0, 0};
+        uint16_t area[3] = {0, height, 0};  //Fixed rows on top, scrolled rows, fixed rows at the bottom
+        uint16_t start = 0;                 //Row shown on the first scrolled line
+        uint8_t command = 0;
+        size_t parameter = 0;   //Data bytes received since the last command
+        uint16_t x = 0, y = 0;
+        uint8_t high = 0;
+        size_t written = 0;
+
+        for(const Byte& byte : m_stream){
+            if(byte.command){
+                command = byte.value;
+                parameter = 0;
+                if(command == PanelCommand::RAMWR){
+                    x = cols[0];
+                    y = rows[0];
+                }
+                continue;
+            }
+            if(command == PanelCommand::CASET || command == PanelCommand::RASET){
+                if(parameter < 4)
+                    setParameter(command == PanelCommand::CASET ? cols : rows, parameter, byte.value);
+            }else if(command == PanelCommand::VSCRDEF){
+                if(parameter < 6)
+                    setParameter(area, parameter, byte.value);
+            }else if(command == PanelCommand::VSCRSADD){
+                if(parameter < 2)
+                    setParameter(&start, parameter, byte.value);
+            }else if(command == PanelCommand::RAMWR){
+                if(parameter % 2 == 0){
+                    high = byte.value;
+                }else{
+                    if(x < width && y < height){
+                        panel[y * width + x] = static_cast<uint16_t>((high << 8) | byte.value);
+                        written++;
+                    }
+                    if(x++ >= cols[1]){
+                        x = cols[0];
+                        y++;
+                    }
+                }
+            }
+            parameter++;
+        }
+
+        if(shown){
+            //The scrolled lines show the rows of the area from the start row on, wrapping around at its end
+            const bool scrolling = area[1] && start >= area[0] && start < area[0] + area[1];
+            for(uint16_t line = 0; line < height; line++){
+                uint16_t row = line;
+                if(scrolling && line >= area[0] && line < area[0] + area[1])
+                    row = area[0] + (start - area[0] + line - area[0]) % area[1];
+                memcpy(shown + line * width, panel + (row < height ? row : line) * width, width * sizeof(uint16_t));
+            }
+        }
+        return written;
+    }
+
+//--------------------DisplayTransport CLASS---------------------------------------------------------------//
+
+    DisplayTransport::DisplayTransport(DisplayBus& bus, size_t buffer_pixels, uint16_t x_offset, uint16_t y_offset)
+    : m_bus(bus), m_buffer_pixels(buffer_pixels ? buffer_pixels : 1), m_x_offset(x_offset), m_y_offset(y_offset)
+    {
+        m_buffers[0] = allocateTransfer(m_buffer_pixels * 2);
+        m_buffers[1] = allocateTransfer(m_buffer_pixels * 2);
+    }
+
+    DisplayTransport::~DisplayTransport(){
+        releaseTransfer(m_buffers[0]);
+        releaseTransfer(m_buffers[1]);
+    }
+
+    bool DisplayTransport::queue(const uint16_t* pixels, uint16_t stride, uint16_t x, uint16_t y, uint16_t w, uint16_t h){
+        if(!pixels || w == 0 || h == 0)
+            return true;
+        const Region region{pixels, stride, x, y, w, h};
+        if(m_merge(region))
+            return true;
+        if(m_count >= max_regions)
+            return false;
+        m_regions[m_count++] = region;
+        return true;
+    }
+
+    //Grow a queued region of the same frame to cover a new one if that sends fewer bytes, and keep merging what the growth reached
+    bool DisplayTransport::m_merge(const Region& region){
+        Region merged = region;
+        bool absorbed = false;
+        for(size_t i = 0; i < m_count; ){
+            const Region& other = m_regions[i];
+            if(other.pixels != merged.pixels || other.stride != merged.stride){
+                i++;
+                continue;
+            }
+            const uint16_t left = std::min(merged.x, other.x), top = std::min(merged.y, other.y);
+            const uint16_t right = std::max(merged.x + merged.w, other.x + other.w), bottom = std::max(merged.y + merged.h, other.y + other.h);
+            const uint16_t w = right - left, h = bottom - top;
+            if(regionCost(w, h) > regionCost(merged.w, merged.h) + regionCost(other.w, other.h)){
+                i++;
+                continue;
+            }
+            merged = Region{merged.pixels, merged.stride, left, top, w, h};
+            m_regions[i] = m_regions[--m_count];
+            absorbed = true;
+            i = 0;  //The bigger region may now be worth merging with one that was skipped
+        }
+        if(absorbed)
+            m_regions[m_count++] = merged;
+        return absorbed;
+    }
+
+    uint16_t DisplayTransport::queueChanged(const uint16_t* pixels, uint16_t width, uint16_t height){
+        if(m_line_hashes.size() != height)
+            m_line_hashes.assign(height, 0);
+
+        uint16_t changed = 0;
+        int run = -1;   //First line of the current run of changed lines
+        for(uint16_t y = 0; y <= height; y++){
+            bool dirty = false;
+            if(y < height){
+                uint32_t hash = 2166136261U;
+                const uint16_t* line = pixels + y * width;
+                for(uint16_t x = 0; x < width; x++){
+                    hash = (hash ^ line[x]) * 16777619U;
+                }
+                hash |= 1;  //Never 0, so a reset hash always counts as changed
+                dirty = hash != m_line_hashes[y];
+                m_line_hashes[y] = hash;
+            }
+            if(dirty){
+                changed++;
+                if(run < 0)
+                    run = y;
+            }else if(run >= 0){
+                if(m_on_changed)
+                    m_on_changed(run, y - run);
+                if(!queue(pixels, width, 0, run, width, y - run)){
+                    flush();
+                    queue(pixels, width, 0, run, width, y - run);
+                }
+                run = -1;
+            }
+        }
+        return changed;
+    }
+
+    //Open a window on one axis, unless the panel already has the same one
+    void DisplayTransport::m_window(uint8_t cmd, uint16_t start, uint16_t end, uint16_t* last){
+        if(last[0] == start && last[1] == end)
+            return;
+        last[0] = start;
+        last[1] = end;
+        const uint8_t parameters[4] = {static_cast<uint8_t>(start >> 8), static_cast<uint8_t>(start), static_cast<uint8_t>(end >> 8), static_cast<uint8_t>(end)};
+        m_bus.command(cmd);
+        m_bus.data(parameters, 4);
+        m_bus.wait();   //The parameters live on the stack
+        m_stats.command_bytes += 5;
+    }
+
+    void DisplayTransport::setRotation(PanelRotation rotation, uint16_t width, uint16_t height){
+        if(rotation != PanelRotation::Deg0)
+            m_unscroll();
+        m_rotation = rotation;
+        m_frame_width = width;
+        m_frame_height = height;
+    }
+
+    //Where a region of the frame lands in the panel's memory
+    DisplayTransport::Window DisplayTransport::m_toPanel(const Region& region) const {
+        switch(m_rotation){
+            case PanelRotation::Deg90:
+                return Window{static_cast<uint16_t>(m_frame_height - region.y - region.h), region.x, region.h, region.w};
+            case PanelRotation::Deg180:
+                return Window{static_cast<uint16_t>(m_frame_width - region.x - region.w), static_cast<uint16_t>(m_frame_height - region.y - region.h), region.w, region.h};
+            case PanelRotation::Deg270:
+                return Window{region.y, static_cast<uint16_t>(m_frame_width - region.x - region.w), region.h, region.w};
+            default:
+                return Window{region.x, region.y, region.w, region.h};
+        }
+    }
+
+    void DisplayTransport::setScrollable(uint16_t panel_lines){
+        m_unscroll();
+        m_panel_lines = panel_lines;
+    }
+
+    bool DisplayTransport::scroll(uint16_t top, uint16_t height, int16_t lines){
+        const uint16_t distance = lines < 0 ? -lines : lines;
+        if(!m_panel_lines || m_rotation != PanelRotation::Deg0 || distance >= height || m_y_offset + top + height > m_panel_lines)
+            return false;
+        if(top != m_scroll_top || height != m_scroll_height){
+            m_unscroll();
+            m_scroll_top = top;
+            m_scroll_height = height;
+            m_fixed_bottom = m_panel_lines - m_y_offset - top - height;
+            m_define_pending = true;
+            m_start_pending = true; //The start the panel has may not even be in the new band
+        }
+        if(lines == 0)
+            return true;
+        m_scroll_start = (m_scroll_start + lines + height) % height;
+        m_start_pending = true;
+        m_stats.scrolled_lines += height - distance;
+
+        //The panel now shows every line of the band where the content moved, the lines it brought in don't match anything yet
+        if(m_line_hashes.size() >= static_cast<size_t>(top + height)){
+            uint32_t* band = m_line_hashes.data() + top;
+            if(lines > 0){
+                memmove(band, band + distance, (height - distance) * sizeof(uint32_t));
+                std::fill(band + height - distance, band + height, 0U);
+            }else{
+                memmove(band + distance, band, (height - distance) * sizeof(uint32_t));
+                std::fill(band, band + distance, 0U);
+            }
+        }
+        return true;
+    }
+
+    //Put the band back in place, its lines are stored out of order in the panel memory so they're sent again
+    void DisplayTransport::m_unscroll(){
+        if(m_scroll_start == 0)
+            return;
+        if(m_line_hashes.size() >= static_cast<size_t>(m_scroll_top + m_scroll_height))
+            std::fill(m_line_hashes.begin() + m_scroll_top, m_line_hashes.begin() + m_scroll_top + m_scroll_height, 0U);
+        m_scroll_start = 0;
+        m_start_pending = true;
+    }
+
+    //Where a line of the frame is in the panel memory, before the offset
+    uint16_t DisplayTransport::m_panelLine(uint16_t y) const {
+        if(y < m_scroll_top || y >= m_scroll_top + m_scroll_height)
+            return y;
+        return m_scroll_top + (y - m_scroll_top + m_scroll_start) % m_scroll_height;
+    }
+
+    void DisplayTransport::m_sendScroll(){
+        if(m_define_pending){
+            const uint16_t fixed_top = m_y_offset + m_scroll_top;
+            const uint8_t parameters[6] = {static_cast<uint8_t>(fixed_top >> 8), static_cast<uint8_t>(fixed_top),
+                                           static_cast<uint8_t>(m_scroll_height >> 8), static_cast<uint8_t>(m_scroll_height),
+                                           static_cast<uint8_t>(m_fixed_bottom >> 8), static_cast<uint8_t>(m_fixed_bottom)};
+            m_bus.command(PanelCommand::VSCRDEF);
+            m_bus.data(parameters, 6);
+            m_bus.wait();
+            m_stats.command_bytes += 7;
+        }
+        if(m_start_pending){
+            const uint16_t row = m_y_offset + m_scroll_top + m_scroll_start;
+            const uint8_t parameters[2] = {static_cast<uint8_t>(row >> 8), static_cast<uint8_t>(row)};
+            m_bus.command(PanelCommand::VSCRSADD);
+            m_bus.data(parameters, 2);
+            m_bus.wait();
+            m_stats.command_bytes += 3;
+        }
+        m_define_pending = false;
+        m_start_pending = false;
+    }
+
+    /*Send a region where the panel reads it. A scrolled band wraps around in the panel memory: its lines are stored from the scroll start on,
+    and the ones past the end of the band are back at its top, so a region crossing the band is cut where the rows stop following each other.*/
+    void DisplayTransport::m_sendRegion(const Region& region, uint16_t* cols, uint16_t* rows){
+        const uint16_t band_end = m_scroll_top + m_scroll_height;
+        const uint16_t cuts[3] = {m_scroll_top, static_cast<uint16_t>(band_end - m_scroll_start), band_end};
+        const uint16_t bottom = region.y + region.h;
+        for(uint16_t y = region.y; y < bottom; ){
+            uint16_t end = bottom;
+            if(m_scroll_start){
+                for(uint16_t cut : cuts){
+                    if(cut > y && cut < end)
+                        end = cut;
+                }
+            }
+            const Region piece{region.pixels, region.stride, region.x, y, region.w, static_cast<uint16_t>(end - y)};
+            Window window = m_toPanel(piece);
+            if(m_scroll_start) //Only upright frames scroll
+                window.y = m_panelLine(piece.y);
+            m_window(PanelCommand::CASET, m_x_offset + window.x, m_x_offset + window.x + window.w - 1, cols);
+            m_window(PanelCommand::RASET, m_y_offset + window.y, m_y_offset + window.y + window.h - 1, rows);
+            m_bus.command(PanelCommand::RAMWR);
+            m_stats.command_bytes++;
+            m_send(piece);
+            m_stats.regions++;
+            y = end;
+        }
+    }
+
+    void DisplayTransport::flush(){
+        if(m_count == 0 && !m_define_pending && !m_start_pending)
+            return;
+        std::sort(m_regions, m_regions + m_count, [this](const Region& a, const Region& b){
+            const Window first = m_toPanel(a), second = m_toPanel(b);
+            return first.y != second.y ? first.y < second.y : first.x < second.x;
+        });
+
+        uint16_t cols[2] = {0xFFFF, 0xFFFF}, rows[2] = {0xFFFF, 0xFFFF};
+        m_bus.begin();
+        //The scroll goes first: the lines it brings in show what scrolled out for a moment, instead of the new lines showing up in the wrong place
+        m_sendScroll();
+        for(size_t i = 0; i < m_count; i++){
+            m_sendRegion(m_regions[i], cols, rows);
+        }
+        m_bus.wait();
+        m_bus.end();
+        m_count = 0;
+        m_stats.frames++;
+        if(m_on_complete)
+            m_on_complete();
+    }
+
+    //Hand a filled buffer to the bus and switch to the other one, which is free once the bus is done with it
+    void DisplayTransport::m_transfer(uint8_t*& out, size_t& current, size_t pixels){
+        m_bus.wait();
+        m_bus.data(out, pixels * 2);
+        m_stats.pixel_bytes += pixels * 2;
+        current ^= 1;
+        out = m_buffers[current];
+    }
+
+    //Stream the pixels of a region, filling one buffer while the other one is on the wire
+    void DisplayTransport::m_send(const Region& region){
+        if(m_rotation == PanelRotation::Deg90 || m_rotation == PanelRotation::Deg270){
+            m_sendTransposed(region);
+            return;
+        }
+        //Upside down, the panel's lines are the frame's lines read backwards from the bottom
+        const bool reversed = m_rotation == PanelRotation::Deg180;
+        const ptrdiff_t step = reversed ? -1 : 1;
+        size_t current = 0;
+        size_t filled = 0;
+        uint8_t* out = m_buffers[current];
+        for(uint16_t row = 0; row < region.h; row++){
+            const uint16_t frame_y = reversed ? region.y + region.h - 1 - row : region.y + row;
+            const uint16_t* pixel = region.pixels + frame_y * region.stride + region.x + (reversed ? region.w - 1 : 0);
+            for(uint16_t col = 0; col < region.w; col++, pixel += step){
+                out[filled * 2] = static_cast<uint8_t>(*pixel >> 8);
+                out[filled * 2 + 1] = static_cast<uint8_t>(*pixel);
+                if(++filled == m_buffer_pixels){
+                    m_transfer(out, current, filled);
+                    filled = 0;
+                }
+            }
+        }
+        if(filled)
+            m_transfer(out, current, filled);
+        m_bus.wait();   //The next command can't go out while pixels are still being sent
+    }
+
+    /*Stream a region turned by a quarter, each line of the panel being a column of the frame. The buffer is filled a block at a time:
+    as many whole panel lines as fit, or a part of one if it's longer than the buffer. A block is filled by reading the frame
+    a line at a time, the few pixels of each line that fall in the block being contiguous, and only the writes into the small
+    buffer jump around, so the frame is read once in order.*/
+    void DisplayTransport::m_sendTransposed(const Region& region){
+        const bool clockwise = m_rotation == PanelRotation::Deg90;
+        const size_t panel_lines = region.w, panel_columns = region.h;
+        const size_t band = panel_columns <= m_buffer_pixels ? m_buffer_pixels / panel_columns : 1;    //Panel lines per block
+        const size_t segment = std::min(panel_columns, m_buffer_pixels);                                //Panel columns per block
+        size_t current = 0;
+        uint8_t* out = m_buffers[current];
+
+        for(size_t first_line = 0; first_line < panel_lines; first_line += band){
+            const size_t lines = std::min(band, panel_lines - first_line);
+            //The frame columns of the block, read left to right when turning clockwise and right to left otherwise
+            const uint16_t first_x = clockwise ? region.x + first_line : region.x + region.w - 1 - first_line;
+            const ptrdiff_t step = clockwise ? 1 : -1;
+            for(size_t first_column = 0; first_column < panel_columns; first_column += segment){
+                const size_t columns = std::min(segment, panel_columns - first_column);
+                for(size_t column = 0; column < columns; column++){
+                    //Clockwise, the panel's first column is the frame's last line
+                    const size_t frame_y = clockwise ? region.y + region.h - 1 - (first_column + column) : region.y + first_column + column;
+                    const uint16_t* pixel = region.pixels + frame_y * region.stride + first_x;
+                    uint8_t* slot = out + column * 2;
+                    for(size_t line = 0; line < lines; line++, pixel += step, slot += columns * 2){
+                        slot[0] = static_cast<uint8_t>(*pixel >> 8);
+                        slot[1] = static_cast<uint8_t>(*pixel);
+                    }
+                }
+                m_transfer(out, current, lines * columns);
+            }
+        }
+        m_bus.wait();
+    }
+
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "Delegate.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <SPI.h>
+#endif
+
+namespace SimpleUI{
+
+    //The commands of the ST77xx and ILI9341 family the transport sends
+    namespace PanelCommand{
+        constexpr uint8_t CASET = 0x2A;    //Column address set
+        constexpr uint8_t RASET = 0x2B;    //Row address set
+        constexpr uint8_t RAMWR = 0x2C;    //Memory write
+        constexpr uint8_t VSCRDEF = 0x33;  //Vertical scroll area: fixed lines on top, scrolled lines, fixed lines at the bottom
+        constexpr uint8_t VSCRSADD = 0x37; //Vertical scroll start: the row of memory shown on the first scrolled line
+    }
+
+    //How the frame is turned to match the way the panel scans its memory, clockwise
+    enum class PanelRotation : uint8_t{Deg0, Deg90, Deg180, Deg270};
+
+    /*The wire between a DisplayTransport and the panel. Bytes are sent as commands (DC low) or data (DC high) inside a transaction.
+    A bus may return from data() before the bytes are out, like a DMA transfer would, as long as wait() blocks until they are:
+    the transport never touches a buffer handed to data() before calling wait().*/
+    class DisplayBus{
+        public:
+        virtual ~DisplayBus() = default;
+        virtual void begin() = 0;
+        virtual void command(uint8_t cmd) = 0;
+        virtual void data(const uint8_t* bytes, size_t len) = 0;
+        //Block until every byte handed to data() is out
+        virtual void wait(){}
+        virtual void end() = 0;
+    };
+
+#ifdef ARDUINO
+    //Drives the panel through an SPIClass, bytes are sent as they are so the transport's pre-swapped buffers go out untouched
+    class SPIDisplayBus : public DisplayBus{
+        public:
+        /*!
+            @param spi        The bus, already started with begin()
+            @param dc         Data/command pin
+            @param cs         Chip select pin, -1 if it's tied low
+            @param frequency  Clock in Hz
+        */
+        SPIDisplayBus(SPIClass& spi, int8_t dc, int8_t cs = -1, uint32_t frequency = 40000000U);
+        void begin() override;
+        void command(uint8_t cmd) override;
+        void data(const uint8_t* bytes, size_t len) override;
+        void end() override;
+
+        private:
+        SPIClass& m_spi;
+        int8_t m_dc, m_cs;
+        uint32_t m_frequency;
+        bool m_pins_ready = false;
+    };
+#endif
+
+    /*Stands in for the panel on a computer: records the byte stream exactly as it would go over the wire,
+    so what a transport sends can be checked and its volume measured.*/
+    class RecordingBus : public DisplayBus{
+        public:
+        struct Byte{
+            uint8_t value;
+            bool command;   //Sent with DC low
+        };
+        void begin() override { m_transactions++; }
+        void command(uint8_t cmd) override { m_stream.push_back(Byte{cmd, true}); m_commands++; }
+        void data(const uint8_t* bytes, size_t len) override;
+        void end() override {}
+
+        inline const std::vector<Byte>& getStream() const { return m_stream; }
+        inline size_t getCommandCount() const { return m_commands; }
+        inline size_t getTransactionCount() const { return m_transactions; }
+        //!@return Every byte sent, commands included
+        inline size_t getByteCount() const { return m_stream.size(); }
+        void clear();
+        /*!
+            @brief Apply the recorded stream to the memory of a panel, the way its controller would
+            @param panel   RGB565 pixels of the panel, native byte order
+            @param width   Columns of the panel memory
+            @param height  Rows of the panel memory
+            @param shown   If given, filled with what the panel shows: its memory read through the last scroll area and scroll start sent
+            @return How many pixels were written
+        */
+        size_t replay(uint16_t* panel, uint16_t width, uint16_t height, uint16_t* shown = nullptr) const;
+
+        private:
+        std::vector<Byte> m_stream;
+        size_t m_commands = 0;
+        size_t m_transactions = 0;
+    };
+
+    //What a transport sent, since it was created
+    struct TransportStats{
+        uint32_t frames = 0;        //Calls to flush() that sent something
+        uint32_t regions = 0;       //Windows opened with RAMWR
+        uint32_t command_bytes = 0; //Command bytes and their parameters
+        uint32_t pixel_bytes = 0;
+        uint32_t scrolled_lines = 0; //Lines the panel moved with its scroll start instead of having them sent again
+    };
+
+    /*Sends RGB565 regions of a frame to a panel. The regions of a frame are queued first, overlapping or touching ones are merged when
+    that sends fewer bytes, then flush() sends them all in a single transaction: CASET and RASET open the window of each region and
+    RAMWR streams its pixels. Consecutive regions sharing their columns or rows skip the repeated command.
+
+    Pixels are copied into two buffers already swapped to the panel's big endian order while the other buffer is on the wire,
+    so a bus that sends in the background keeps the SPI busy. On the ESP32 the buffers are taken from DMA capable memory.
+
+    The frame is always drawn the way it's seen, a rotated panel only changes how its pixels are sent: regions are mapped to the
+    panel's memory and quarter turns are transposed in blocks while filling the transfer buffers, reading the frame a line at a time.
+    Rotating in software instead of changing the panel's scan direction keeps the writes in step with the panel's refresh.
+
+    A band of lines can be scrolled by the panel itself (see scroll()): it moves the row of memory it starts showing the band from,
+    and the lines that scrolled out are reused for the ones coming in. Every region is then written where the panel reads it,
+    and the line hashes of queueChanged() follow the picture, so only the lines the scroll exposed are sent again.*/
+    class DisplayTransport{
+        public:
+        /*!
+            @param bus            Where the bytes go
+            @param buffer_pixels  The size of each of the two transfer buffers in pixels, a region is split across as many as needed
+            @param x_offset       Column of the panel memory where the frame starts, depends on the panel and its rotation
+            @param y_offset       Row of the panel memory where the frame starts
+        */
+        DisplayTransport(DisplayBus& bus, size_t buffer_pixels = 1024U, uint16_t x_offset = 0, uint16_t y_offset = 0);
+        ~DisplayTransport();
+        DisplayTransport(const DisplayTransport&) = delete;
+        DisplayTransport& operator=(const DisplayTransport&) = delete;
+
+        /*!
+            @brief Queue a region of a frame for the next flush, the pixels are read only when it happens
+            @param pixels  The frame, RGB565 in native byte order
+            @param stride  Pixels per line of the frame
+            @return False if the queue is full, flush() and queue it again
+        */
+        bool queue(const uint16_t* pixels, uint16_t stride, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+        /*!
+            @brief Queue only the lines of a frame that changed since the last time this was called
+            Every line is hashed and compared with the hash it had, runs of changed lines are queued as full width regions.
+            @return How many lines changed
+        */
+        uint16_t queueChanged(const uint16_t* pixels, uint16_t width, uint16_t height);
+        //Forget the line hashes, the next queueChanged() sends the whole frame
+        inline void resetChanged(){ m_line_hashes.clear(); }
+        //Send every queued region in one transaction, then call the completion callback
+        void flush();
+        /*!
+            @brief Turn every frame sent from now on, queued regions included
+            @param rotation  How the frame is turned to land on the panel, clockwise
+            @param width     Width of the frame as it's drawn
+            @param height    Height of the frame as it's drawn
+        */
+        void setRotation(PanelRotation rotation, uint16_t width, uint16_t height);
+        inline PanelRotation getRotation() const { return m_rotation; }
+        /*!
+            @brief Let the panel scroll a band of the frame in hardware, see scroll()
+            @param panel_lines  Rows of the panel memory the scroll area is defined over, 162 for the ST7735 and 320 for the ILI9341. 0 disables it
+        */
+        void setScrollable(uint16_t panel_lines);
+        /*!
+            @brief Move the content of a band of lines with the panel's scroll start, the commands go out with the next flush.
+            Only an upright frame (PanelRotation::Deg0) can scroll. The panel scrolls whole lines, what else the band holds moves along
+            and is sent again by queueChanged() if it didn't. Moving to another band puts the previous one back in place first
+            @param top     First line of the band
+            @param height  Lines in the band
+            @param lines   How far the content moved up, negative if it moved down
+            @return False if the panel can't scroll the band, the lines that changed have to be sent again
+        */
+        bool scroll(uint16_t top, uint16_t height, int16_t lines);
+        //!@return Line of the band the panel shows at the band's top, 0 when the band is in place
+        inline uint16_t getScrollStart() const { return m_scroll_start; }
+        //Called at the end of every flush that sent something, once the last byte is out
+        inline void onComplete(const Delegate<void()>& callback){ m_on_complete = callback; }
+        //Called by queueChanged() for every run of lines that changed, so others can reuse what it found (see FrameMirror::markDirty)
+        inline void onChangedLines(const Delegate<void(uint16_t y, uint16_t count)>& callback){ m_on_changed = callback; }
+
+        inline const TransportStats& getStats() const { return m_stats; }
+        inline size_t getQueued() const { return m_count; }
+
+        static constexpr size_t max_regions = 16;
+
+        private:
+        struct Region{
+            const uint16_t* pixels;
+            uint16_t stride;
+            uint16_t x, y, w, h;
+        };
+        //A rectangle of the panel's memory, before the offsets
+        struct Window{
+            uint16_t x, y, w, h;
+        };
+        Window m_toPanel(const Region& region) const;
+        bool m_merge(const Region& region);
+        void m_window(uint8_t cmd, uint16_t start, uint16_t end, uint16_t* last);
+        void m_send(const Region& region);
+        void m_sendTransposed(const Region& region);
+        void m_transfer(uint8_t*& out, size_t& current, size_t pixels);
+        void m_sendRegion(const Region& region, uint16_t* cols, uint16_t* rows);
+        uint16_t m_panelLine(uint16_t y) const;
+        void m_unscroll();
+        void m_sendScroll();
+
+        private:
+        DisplayBus& m_bus;
+        uint8_t* m_buffers[2];
+        size_t m_buffer_pixels;
+        uint16_t m_x_offset, m_y_offset;
+        PanelRotation m_rotation = PanelRotation::Deg0;
+        uint16_t m_frame_width = 0, m_frame_height = 0;
+        uint16_t m_panel_lines = 0;
+        uint16_t m_scroll_top = 0, m_scroll_height = 0; //The band the panel scrolls, in lines of the frame
+        uint16_t m_fixed_bottom = 0;                    //Rows of the panel memory below the band
+        uint16_t m_scroll_start = 0;                    //Line of the band shown at its top
+        bool m_define_pending = false;                  //VSCRDEF has to be sent with the next flush
+        bool m_start_pending = false;                   //VSCRSADD has to be sent with the next flush
+        Region m_regions[max_regions];
+        size_t m_count = 0;
+        std::vector<uint32_t> m_line_hashes;
+        Delegate<void()> m_on_complete;
+        Delegate<void(uint16_t, uint16_t)> m_on_changed;
+        TransportStats m_stats;
+    };
+
+}
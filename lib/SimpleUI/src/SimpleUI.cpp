@@ -1,4 +1,7 @@
 #include "SimpleUI.h"
+#include <algorithm>
+#include <new>
+#include <string.h>
 
 namespace SimpleUI{
 //--------------------Cone STRUCT---------------------------------------------------------------//
@@ -70,7 +73,21 @@ namespace SimpleUI{
       }
 
   bool UIElement::isFocused() const {
-    return m_parent_ui->focus.focusedElementID==m_UUID;
+    return m_parent_ui->focus.focusedElementID==m_id();
+  }
+
+  const std::string& UIElement::m_id() const {
+    if (m_UUID.empty())
+      m_UUID = UUIDbuddy::generateUUID();
+    return m_UUID;
+  }
+
+  //Give the element an id that fits in std::string's inline storage, unique for the whole boot
+  void UIElement::m_assignShortId(){
+    static unsigned int counter = 0;
+    char buffer[12];
+    snprintf(buffer, sizeof(buffer), "@%u", counter++);
+    m_UUID = buffer;
   }
 
   void UIElement::drawFocusOutline(const Outline& outline) const {
@@ -78,40 +95,14 @@ namespace SimpleUI{
     if (focus_style == FocusStyle::Outline && isFocused()) {
       Outline draw_outline = custom_focus_outline ? focus_outline : outline;
 
-      Point rect_drawing_pos = getDrawPoint();
-      rect_drawing_pos -= (draw_outline.border_distance + 1);
-      int16_t draw_width = m_width + draw_outline.border_distance*2 +2;
-      int16_t draw_height = m_height + draw_outline.border_distance*2 +2;
-
-
-      if(draw_outline.radius != 0){
-        int16_t draw_radius = draw_outline.radius;
-        for (int i = 0; i < draw_outline.thickness; i++) {
-          m_parent_ui->buffer->drawRoundRect(rect_drawing_pos.x, rect_drawing_pos.y, draw_width, draw_height, draw_radius, draw_outline.color);
-          if (!(i % 2)){
-            int16_t temp_r = draw_radius + 1;
-            m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + temp_r, rect_drawing_pos.y + temp_r, temp_r, 1, draw_outline.color);
-            m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + draw_width - temp_r - 1, rect_drawing_pos.y + temp_r, temp_r, 2, draw_outline.color);
-            m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + draw_width - temp_r - 1, rect_drawing_pos.y + draw_height - temp_r - 1, temp_r, 4, draw_outline.color);
-            m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + temp_r, rect_drawing_pos.y + draw_height - temp_r - 1, temp_r, 8, draw_outline.color);
-          }
-          
-          draw_width += 2;
-          draw_height += 2; 
-          rect_drawing_pos--;
-          draw_radius++;
-        }
-      }
-      else{
-
-        for (int i = 0; i < draw_outline.thickness; i++) {
-          m_parent_ui->buffer->drawRect(rect_drawing_pos.x, rect_drawing_pos.y, draw_width, draw_height, draw_outline.color);
-          draw_width += 2;
-          draw_height += 2;
-          rect_drawing_pos--;
-        }
+      if (draw_outline.thickness == 0) return;
 
-      }
+      //The outermost ring sits border_distance + thickness pixels away from the element, the rings grow inwards from there
+      const int grow = draw_outline.border_distance + draw_outline.thickness;
+      const Point pos = getDrawPoint();
+      const Rect ring(pos.x - grow, pos.y - grow, m_width + grow*2, m_height + grow*2);
+      const unsigned int radius = draw_outline.radius != 0 ? draw_outline.radius + draw_outline.thickness - 1 : 0;
+      m_parent_ui->drawRing(ring, radius, draw_outline.thickness, draw_outline.color);
     }
   }
 
@@ -124,48 +115,81 @@ namespace SimpleUI{
     return getConstraintedPos();
   }
 
+  Rect UIElement::getBounds() const {
+    return Rect(getDrawPoint(), m_s_width, m_s_height);
+  }
+
   Point UIElement::getCenterPoint() const {
     return UiUtils::centerPos(m_position.x, m_position.y, m_width, m_height);
   }
 
   Point UIElement::getConstraintedPos() const {
+    if (!m_pos_dirty && m_cached_constraint == scale_constraint)
+      return m_constrainted_pos;
+
     int widthDiff = m_width - m_s_width;
     int heightDiff = m_height - m_s_height;
     int widthDiff_2 = static_cast<int>(widthDiff * 0.5);
     int heightDiff_2 = static_cast<int>(heightDiff * 0.5);
+    Point result(m_position.x, m_position.y);
     switch (scale_constraint){
-      case Constraint::TopLeft:     return Point( m_position.x, m_position.y );
-      case Constraint::Top:         return Point( m_position.x + widthDiff_2,  m_position.y);
-      case Constraint::TopRight:    return Point( m_position.x + widthDiff,  m_position.y);
-      case Constraint::Left:        return Point( m_position.x,  m_position.y + heightDiff_2);
-      case Constraint::Center:      return Point( m_position.x + widthDiff_2,  m_position.y + heightDiff_2);
-      case Constraint::Right:       return Point( m_position.x + widthDiff,  m_position.y + heightDiff_2);
-      case Constraint::BottomLeft:  return Point( m_position.x,  m_position.y + heightDiff);
-      case Constraint::Bottom:      return Point( m_position.x + widthDiff_2,  m_position.y + heightDiff);
-      case Constraint::BottomRight: return Point( m_position.x + heightDiff,  m_position.y + heightDiff);
+      case Constraint::TopLeft:     result = Point( m_position.x, m_position.y ); break;
+      case Constraint::Top:         result = Point( m_position.x + widthDiff_2,  m_position.y); break;
+      case Constraint::TopRight:    result = Point( m_position.x + widthDiff,  m_position.y); break;
+      case Constraint::Left:        result = Point( m_position.x,  m_position.y + heightDiff_2); break;
+      case Constraint::Center:      result = Point( m_position.x + widthDiff_2,  m_position.y + heightDiff_2); break;
+      case Constraint::Right:       result = Point( m_position.x + widthDiff,  m_position.y + heightDiff_2); break;
+      case Constraint::BottomLeft:  result = Point( m_position.x,  m_position.y + heightDiff); break;
+      case Constraint::Bottom:      result = Point( m_position.x + widthDiff_2,  m_position.y + heightDiff); break;
+      case Constraint::BottomRight: result = Point( m_position.x + widthDiff,  m_position.y + heightDiff); break;
+    }
+    m_constrainted_pos = result;
+    m_cached_constraint = scale_constraint;
+    m_pos_dirty = false;
+    return result;
+  }
+
+  //Update the size with scaling applied, invalidating the cached position only if it actually changed
+  void UIElement::m_setScaledSize(unsigned int w, unsigned int h){
+    if (w != m_s_width || h != m_s_height){
+      m_s_width = w;
+      m_s_height = h;
+      m_pos_dirty = true;
+      invalidateBounds();
+    }
+  }
+
+  void UIElement::m_setSize(unsigned int w, unsigned int h){
+    if (w != m_width || h != m_height){
+      m_width = w;
+      m_height = h;
+      m_pos_dirty = true;
+      invalidateBounds();
     }
-    return Point(m_position.x, m_position.y);
+  }
+
+  void UIElement::invalidateBounds(){
+    m_version++;
+    for (UIElement* element = this; element; element = element->m_parent)
+      element->m_subtree_version++;
   }
 
 //--------------------UIImage CLASS---------------------------------------------------------------//
 
+  void UIImage::update(){
+    anim.Update();
+    const float scale_fac = m_parent_ui->animatedScale(anim);
+    m_setScaledSize(static_cast<unsigned int>(m_body->width * scale_fac), static_cast<unsigned int>(m_body->height * scale_fac));
+  }
+
   void UIImage::render(){
     INSTRUMENTATE(m_parent_ui)
     drawFocusOutline();
-    anim.Update();
   
-    const float scale_fac = anim.getProgress();
-    const Texture drawing_image = scale(*m_body, scale_fac);
-    m_s_height = drawing_image.height;
-    m_s_width = drawing_image.width;
+    const Texture& drawing_image = m_parent_ui->animatedTexture(*m_body, anim);
     const Point drawing_pos = getConstraintedPos();
 
-    if(drawing_image.data.colorspace == PixelType::Mono){
-      m_parent_ui->buffer->drawBitmap(drawing_pos.x, drawing_pos.y, drawing_image.data.mono, drawing_image.width, drawing_image.height, m_mono_color);
-    }
-    else{
-      m_parent_ui->buffer->drawRGBBitmap(drawing_pos.x, drawing_pos.y, drawing_image.data.rgb565, drawing_image.width, drawing_image.height);
-    }
+    m_parent_ui->drawTexture(drawing_image, drawing_pos, m_mono_color);
 
   }
 
@@ -225,61 +249,29 @@ namespace SimpleUI{
     }
   }
 
-void AnimatedApp::render(){
-  INSTRUMENTATE(m_parent_ui)
+void AnimatedApp::update(){
     anim.Update();
     m_computeAnimation();
-  
-    const float scale_fac = anim.getProgress();
-    const Texture drawing_image = scale(*m_showing, scale_fac);
-    m_s_height = drawing_image.height;
-    m_s_width = drawing_image.width;
+    const float scale_fac = m_parent_ui->animatedScale(anim);
+    m_setScaledSize(static_cast<unsigned int>(m_showing->width * scale_fac), static_cast<unsigned int>(m_showing->height * scale_fac));
+  }
+
+void AnimatedApp::render(){
+  INSTRUMENTATE(m_parent_ui)
+    const Texture& drawing_image = m_parent_ui->animatedTexture(*m_showing, anim);
     const Point drawing_pos = getConstraintedPos();
 
     
-    if(drawing_image.data.colorspace == PixelType::Mono){
-      m_parent_ui->buffer->drawBitmap(drawing_pos.x, drawing_pos.y, drawing_image.data.mono, drawing_image.width, drawing_image.height, m_mono_color);
-    }
-    else{
-      m_parent_ui->buffer->drawRGBBitmap(drawing_pos.x, drawing_pos.y, drawing_image.data.rgb565, drawing_image.width, drawing_image.height);
-    }
+    m_parent_ui->drawTexture(drawing_image, drawing_pos, m_mono_color);
   }
 
 //--------------------Checkbox CLASS---------------------------------------------------------------//
 
   void Checkbox::m_drawCheckboxOutline() const {
     INSTRUMENTATE(m_parent_ui)
-    int16_t draw_width = m_width;
-    int16_t draw_height = m_height;
-    Point rect_drawing_pos = getDrawPoint();
-
-    if(outline.radius!=0){
-      int16_t draw_radius = outline.radius+outline.thickness;
-      for (int i = outline.thickness; i > 0 ; i--) {
-        m_parent_ui->buffer->drawRoundRect(rect_drawing_pos.x, rect_drawing_pos.y, draw_width, draw_height, draw_radius, outline.color);
-        if (!(i % 2)){
-          int16_t temp_r = draw_radius + 1;
-          m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + temp_r, rect_drawing_pos.y + temp_r, temp_r, 1, outline.color);
-          m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + draw_width - temp_r - 1, rect_drawing_pos.y + temp_r, temp_r, 2, outline.color);
-          m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + draw_width - temp_r - 1, rect_drawing_pos.y + draw_height - temp_r - 1, temp_r, 4, outline.color);
-          m_parent_ui->buffer->drawCircleHelper(rect_drawing_pos.x + temp_r, rect_drawing_pos.y + draw_height - temp_r - 1, temp_r, 8, outline.color);
-        }
-        
-        draw_width -= 2;
-        draw_height -= 2; 
-        rect_drawing_pos++;
-        draw_radius--;
-      }
-    }
-    else{
-      
-      for (int i = outline.thickness; i > 0 ; i--) {
-        m_parent_ui->buffer->drawRect(rect_drawing_pos.x, rect_drawing_pos.y, draw_width, draw_height, outline.color);
-        draw_width -= 2;
-        draw_height -= 2;
-        rect_drawing_pos++;
-      }
-    }
+    const Point pos = getDrawPoint();
+    const unsigned int radius = outline.radius != 0 ? outline.radius + outline.thickness : 0;
+    m_parent_ui->drawRing(Rect(pos.x, pos.y, m_width, m_height), radius, outline.thickness, outline.color);
   }
 
   void Checkbox::render(){
@@ -292,10 +284,1323 @@ void AnimatedApp::render(){
       if(outline.radius!=0){
         m_parent_ui->buffer->fillRoundRect(fill_pos.x, fill_pos.y, m_width-offset, m_height-offset, outline.radius-outline.border_distance, selection_color);
       }
-      else{
-        m_parent_ui->buffer->fillRect(fill_pos.x, fill_pos.y, m_width-offset, m_height-offset, selection_color);
+      else{
+        m_parent_ui->buffer->fillRect(fill_pos.x, fill_pos.y, m_width-offset, m_height-offset, selection_color);
+      }
+    }
+  }
+
+//--------------------AnimatedSprite CLASS---------------------------------------------------------------//
+
+  AnimatedSprite::AnimatedSprite(const TextureAtlas* atlas, unsigned int frame_time, Point pos, bool isCentered, bool loop)
+    : UIElement(0, 0, pos, false, ElementType::Sprite), m_atlas(atlas), m_frame_us((frame_time ? frame_time : 1U) * 1000U), m_loop(loop)
+  {
+    focusable = false;
+    m_show(0);
+    if (isCentered)
+      m_position = centerToCornerPos(pos.x, pos.y, m_width, m_height);
+  }
+
+  void AnimatedSprite::m_show(size_t index){
+    m_frame = index;
+    m_view = m_atlas ? m_atlas->cell(index) : Texture();
+    m_setSize(m_view.width, m_view.height);
+    m_setScaledSize(m_view.width, m_view.height);
+  }
+
+  void AnimatedSprite::play(){
+    const size_t count = m_atlas ? m_atlas->size() : 0;
+    if (count == 0)
+      return;
+    if (!m_loop && m_frame + 1 >= count)
+      m_show(0);
+    m_started = Clock::now() - m_frame * m_frame_us;
+    m_playing = true;
+  }
+
+  void AnimatedSprite::setFrame(size_t index){
+    const size_t count = m_atlas ? m_atlas->size() : 0;
+    if (index >= count)
+      return;
+    m_show(index);
+    if (m_playing)
+      play();
+  }
+
+  void AnimatedSprite::update(){
+    if (!m_playing)
+      return;
+    const size_t count = m_atlas->size();
+    size_t index = (Clock::now() - m_started) / m_frame_us;
+    if (index >= count){
+      if (m_loop){
+        index %= count;
+      }else{
+        index = count - 1;
+        m_playing = false;
+      }
+    }
+    if (index != m_frame)
+      m_show(index);
+  }
+
+  void AnimatedSprite::render(){
+    INSTRUMENTATE(m_parent_ui)
+    drawFocusOutline();
+    m_parent_ui->drawTexture(m_view, getDrawPoint(), m_mono_color);
+  }
+
+//--------------------ParticleEmitter CLASS---------------------------------------------------------------//
+
+  ParticleEmitter::ParticleEmitter(size_t capacity, const Rect& area)
+    : UIElement(area.width, area.height, Point(area.x, area.y), false, ElementType::Emitter)
+  {
+    focusable = false;
+    //One block for every array, the 4 byte ones first so each array stays aligned
+    m_pool = new (std::nothrow) uint8_t[capacity * (4 * sizeof(int32_t) + 6 * sizeof(uint16_t) + sizeof(uint8_t))];
+    m_capacity = m_pool ? capacity : 0;
+    m_limit = m_capacity;
+    int32_t* words = reinterpret_cast<int32_t*>(m_pool);
+    m_x = words;
+    m_y = words + m_capacity;
+    m_vx = words + 2 * m_capacity;
+    m_vy = words + 3 * m_capacity;
+    uint16_t* halves = reinterpret_cast<uint16_t*>(words + 4 * m_capacity);
+    m_gravity = reinterpret_cast<int16_t*>(halves);
+    m_drag = halves + m_capacity;
+    m_life = halves + 2 * m_capacity;
+    m_fade = halves + 3 * m_capacity;
+    m_start_color = halves + 4 * m_capacity;
+    m_end_color = halves + 5 * m_capacity;
+    m_size = reinterpret_cast<uint8_t*>(halves + 6 * m_capacity);
+  }
+
+  ParticleEmitter::~ParticleEmitter(){
+    delete[] m_pool;
+  }
+
+  //xorshift32, enough to scatter particles
+  uint32_t ParticleEmitter::m_random(){
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return m_seed;
+  }
+
+  size_t ParticleEmitter::burst(const ParticleEffect& effect, Point at){
+    const size_t count = std::min<size_t>(effect.count, m_limit > m_count ? m_limit - m_count : 0);
+    const float direction = effect.direction * static_cast<float>(M_PI / 180.0);
+    const float spread = effect.spread * static_cast<float>(M_PI / 180.0);
+    constexpr float unit = 1.0f / 16777216.0f;  //Turns 24 random bits into [0, 1)
+    constexpr float to_speed = 1048576.0f / 1000.0f;  //Pixels per second to 12.20 pixels per millisecond
+    const float speed_max = std::min(effect.speed_max, 1900.0f);
+    const float speed_min = std::min(effect.speed_min, speed_max);
+    const uint16_t life_min = std::max<uint16_t>(1U, std::min(effect.life_min, effect.life_max));
+    const uint16_t life_max = std::max(life_min, effect.life_max);
+    const int16_t gravity = static_cast<int16_t>(std::clamp(effect.gravity * (16777216.0f / 1000000.0f), -32767.0f, 32767.0f));
+    const uint16_t drag = static_cast<uint16_t>(std::clamp(effect.drag * (65536.0f / 1000.0f), 0.0f, 65535.0f));
+
+    for (size_t n = 0; n < count; n++){
+      const size_t i = m_count++;
+      const float angle = direction + ((m_random() >> 8) * unit - 0.5f) * spread;
+      const float speed = (speed_min + (speed_max - speed_min) * ((m_random() >> 8) * unit)) * to_speed;
+      const uint16_t life = life_min + m_random() % (life_max - life_min + 1U);
+      m_x[i] = at.x * 65536 + 32768;  //From the middle of the pixel
+      m_y[i] = at.y * 65536 + 32768;
+      m_vx[i] = static_cast<int32_t>(cosf(angle) * speed);
+      m_vy[i] = static_cast<int32_t>(-sinf(angle) * speed);  //Counter clockwise angles point up the screen
+      m_gravity[i] = gravity;
+      m_drag[i] = drag;
+      m_life[i] = life;
+      m_fade[i] = 65535U / life;
+      m_start_color[i] = effect.start_color;
+      m_end_color[i] = effect.end_color;
+      m_size[i] = std::max<uint8_t>(effect.size, 1);
+    }
+    return count;
+  }
+
+  //Swap the last particle in place of a dead one, the order of the particles doesn't matter
+  void ParticleEmitter::m_kill(size_t index){
+    const size_t last = --m_count;
+    m_x[index] = m_x[last];
+    m_y[index] = m_y[last];
+    m_vx[index] = m_vx[last];
+    m_vy[index] = m_vy[last];
+    m_gravity[index] = m_gravity[last];
+    m_drag[index] = m_drag[last];
+    m_life[index] = m_life[last];
+    m_fade[index] = m_fade[last];
+    m_start_color[index] = m_start_color[last];
+    m_end_color[index] = m_end_color[last];
+    m_size[index] = m_size[last];
+  }
+
+  //Play the effects on the clicks and focus changes since the last frame. After a frame without the emitter (its scene wasn't shown) it only catches up
+  void ParticleEmitter::m_watch(){
+    UI* ui = m_parent_ui;
+    if (!ui)
+      return;
+    const UIElement* focused = ui->getFocused();
+    if (m_watching && ui->getFrameCount() == m_ui_frame + 1 && focused){
+      const Rect bounds = focused->getBounds();
+      const Point center(bounds.x + bounds.width / 2, bounds.y + bounds.height / 2);
+      if (focus_effect.count && focused != m_focused)
+        burst(focus_effect, center);
+      if (click_effect.count && ui->getClickCount() != m_clicks)
+        burst(click_effect, center);
+    }
+    m_watching = true;
+    m_ui_frame = ui->getFrameCount();
+    m_clicks = ui->getClickCount();
+    m_focused = focused;
+  }
+
+  //Shrink the number of particles allowed when they take more than their share of the frame, grow it back when they take far less
+  void ParticleEmitter::m_fitBudget(){
+    m_average = m_average + (static_cast<int32_t>(m_cost_us * 16) - static_cast<int32_t>(m_average)) / 8;
+    m_cost_us = 0;
+    const uint32_t budget = m_parent_ui ? m_parent_ui->governor.getBudget() : 0;
+    if (!budget || m_share <= 0.0f){
+      m_limit = m_capacity;
+      return;
+    }
+    const uint32_t allowed = static_cast<uint32_t>(budget * m_share * 16.0f);
+    if (m_average > allowed && m_count){
+      m_limit = std::max<size_t>(std::min(m_limit, m_count) * 3 / 4, 1);
+      m_average = allowed;  //Give the cut a few frames to show before cutting again
+    }
+    else if (m_average * 2 < allowed && m_limit < m_capacity)
+      m_limit = std::min(m_capacity, m_limit + m_capacity / 16 + 1);
+    if (m_count > m_limit)
+      m_count = m_limit;
+  }
+
+  void ParticleEmitter::update(){
+    const uint32_t start = micros();
+    m_fitBudget();
+    m_watch();
+
+    const uint32_t now = Clock::now();
+    const uint32_t elapsed = m_last_time ? std::min<uint32_t>(now - m_last_time, 100000U) : 0; //A long pause doesn't teleport the particles
+    m_last_time = now;
+    m_carry_us += elapsed;
+    const int32_t dt = m_carry_us / 1000;
+    m_carry_us -= dt * 1000;
+    if (!dt || !m_count)
+      return;
+
+    //Particles that leave the area are gone, it also bounds how fast gravity can make them
+    const Rect area = getBounds();
+    const int32_t left = area.x * 65536, top = area.y * 65536, right = area.right() * 65536, bottom = area.bottom() * 65536;
+    for (size_t i = 0; i < m_count;){
+      if (m_life[i] <= dt || m_x[i] < left - m_size[i] * 65536 || m_x[i] >= right || m_y[i] < top - m_size[i] * 65536 || m_y[i] >= bottom){
+        m_kill(i);
+        continue;
+      }
+      m_life[i] -= dt;
+      int32_t vx = m_vx[i];
+      int32_t vy = m_vy[i] + ((m_gravity[i] * dt) >> 4);
+      if (m_drag[i]){
+        const int32_t loss = std::min<int32_t>((m_drag[i] * dt) >> 8, 256); //Fraction of the speed lost this frame, out of 256
+        vx -= (vx * loss) >> 8;
+        vy -= (vy * loss) >> 8;
+      }
+      m_x[i] += (vx * dt) >> 4;
+      m_y[i] += (vy * dt) >> 4;
+      m_vx[i] = vx;
+      m_vy[i] = vy;
+      i++;
+    }
+    m_cost_us += micros() - start;
+  }
+
+  void ParticleEmitter::render(){
+    INSTRUMENTATE(m_parent_ui)
+    if (!m_count)
+      return;
+    const uint32_t start = micros();
+    Adafruit_GFX* target = m_parent_ui->buffer;
+    const PixelAccess access = m_parent_ui->getPixelAccess();
+    const Rect area = getBounds();
+    int left = std::max(area.x, 0), top = std::max(area.y, 0);
+    int right = std::min<int>(area.right(), target->width()), bottom = std::min<int>(area.bottom(), target->height());
+    access.clipLines(top, bottom);
+
+    for (size_t i = 0; i < m_count; i++){
+      const int size = m_size[i];
+      int x0 = m_x[i] >> 16, y0 = m_y[i] >> 16;
+      int x1 = x0 + size, y1 = y0 + size;
+      if (x0 >= right || y0 >= bottom || x1 <= left || y1 <= top)
+        continue;
+      const uint8_t alpha = static_cast<uint8_t>((m_life[i] * m_fade[i] + 1024U) >> 11);
+      const uint16_t color = ColorUtils::blend565(m_end_color[i], m_start_color[i], alpha);
+      x0 = std::max(x0, left);
+      y0 = std::max(y0, top);
+      x1 = std::min(x1, right);
+      y1 = std::min(y1, bottom);
+      if (access.pixels){
+        for (int y = y0; y < y1; y++){
+          uint16_t* line = access.line(y);
+          for (int x = x0; x < x1; x++){
+            line[x] = color;
+          }
+        }
+      }
+      else if (size == 1)
+        target->drawPixel(x0, y0, color);
+      else
+        target->fillRect(x0, y0, x1 - x0, y1 - y0, color);
+    }
+    m_cost_us += micros() - start;
+  }
+
+//--------------------ValueWidget CLASS---------------------------------------------------------------//
+
+  ValueWidget::ValueWidget(ElementType type, Outline style, Point pos, unsigned int width, unsigned int height, uint16_t fill_color, uint16_t track_color,
+                           bool isCentered, FocusStyle focus_style)
+    : UIElement(width, height, pos, isCentered, type, Constraint::TopLeft, focus_style), outline(style), fill_color(fill_color), track_color(track_color)
+  {
+    focus_outline.border_distance = 0U;
+    outline.radius = std::min(outline.radius, std::min(width, height) / 2);
+  }
+
+  void ValueWidget::setValue(float value, bool animate){
+    m_value = std::clamp(value, std::min(m_min, m_max), std::max(m_min, m_max));
+    if (animate && m_duration){
+      anim = Animation(m_shown, m_value, m_duration, m_func); //From wherever the last transition got to
+      anim.Start();
+    }
+    else{
+      anim.Pause();
+      m_shown = m_value;
+    }
+  }
+
+  void ValueWidget::setRange(float min, float max){
+    m_min = min;
+    m_max = max;
+    setValue(m_value, false);
+  }
+
+  void ValueWidget::update(){
+    if (anim.isEnabled()){
+      anim.Update();
+      m_shown = anim.getProgress();
+    }
+    m_drawn = m_at;
+    m_at = m_locate(m_shown);
+  }
+
+//--------------------ProgressBar CLASS---------------------------------------------------------------//
+
+  ProgressBar::ProgressBar(ElementType type, Outline style, Point pos, unsigned int width, unsigned int height, uint16_t fill_color, uint16_t track_color,
+                           Direction grow, bool isCentered, FocusStyle focus_style)
+    : ValueWidget(type, style, pos, width, height, fill_color, track_color, isCentered, focus_style), m_grow(grow){}
+
+  Rect ProgressBar::m_track() const {
+    const int inset = outline.thickness + outline.border_distance;
+    const Point pos = getDrawPoint();
+    return Rect(pos.x + inset, pos.y + inset, static_cast<int>(m_width) - inset*2, static_cast<int>(m_height) - inset*2);
+  }
+
+  int ProgressBar::m_length() const {
+    const Rect track = m_track();
+    return std::max(0, (m_grow == Direction::Right || m_grow == Direction::Left) ? track.width : track.height);
+  }
+
+  int ProgressBar::m_locate(float value) const {
+    const int room = std::max(0, m_length() - m_knob);
+    return static_cast<int>(std::clamp(m_fraction(value), 0.0f, 1.0f) * room + 0.5f);
+  }
+
+  Rect ProgressBar::m_span(int from, int to) const {
+    const Rect track = m_track();
+    switch (m_grow){
+      case Direction::Right:  return Rect(track.x + from, track.y, to - from, track.height);
+      case Direction::Left:   return Rect(track.right() - to, track.y, to - from, track.height);
+      case Direction::Down:   return Rect(track.x, track.y + from, track.width, to - from);
+      default:                return Rect(track.x, track.bottom() - to, track.width, to - from);
+    }
+  }
+
+  //Steps with the same color and the same rounding are filled as one rectangle, only the rounded ends are drawn a line at a time
+  void ProgressBar::m_paint(int from, int to) const {
+    const int length = m_length();
+    from = std::max(from, 0);
+    to = std::min(to, length);
+    if (from >= to)
+      return;
+    const bool horizontal = m_grow == Direction::Right || m_grow == Direction::Left;
+    const Rect track = m_track();
+    const int corner = outline.radius > outline.border_distance ? outline.radius - outline.border_distance : 0;
+    const int radius = std::min({corner, (horizontal ? track.height : track.width) / 2, length / 2});
+    const uint16_t knob_color = m_knobColor();
+    Adafruit_GFX* target = m_parent_ui->buffer;
+
+    int run_start = from, run_inset = 0;
+    uint16_t run_color = 0;
+    for (int step = from; step <= to; step++){
+      int inset = 0;
+      uint16_t color = 0;
+      if (step < to){
+        const int edge = std::min(step, length - 1 - step); //Steps to the closest end of the track
+        if (edge < radius){
+          const float dy = radius - edge - 0.5f;
+          inset = radius - static_cast<int>(sqrtf(radius*radius - dy*dy) + 0.5f);
+        }
+        color = step < m_at ? fill_color : step < m_at + m_knob ? knob_color : track_color;
+        if (step > run_start && inset == run_inset && color == run_color)
+          continue;
+      }
+      if (step > run_start){
+        Rect span = m_span(run_start, step);
+        if (horizontal){
+          span.y += run_inset;
+          span.height -= run_inset*2;
+        }
+        else{
+          span.x += run_inset;
+          span.width -= run_inset*2;
+        }
+        if (!span.isEmpty())
+          target->fillRect(span.x, span.y, span.width, span.height, run_color);
+      }
+      run_start = step;
+      run_inset = inset;
+      run_color = color;
+    }
+  }
+
+  void ProgressBar::render(){
+    INSTRUMENTATE(m_parent_ui)
+    if (outline.thickness){
+      const unsigned int radius = outline.radius != 0 ? outline.radius + outline.thickness : 0;
+      m_parent_ui->drawRing(Rect(getDrawPoint(), m_width, m_height), radius, outline.thickness, outline.color);
+    }
+    m_paint(0, m_length());
+  }
+
+  Rect ProgressBar::getDamage() const {
+    if (m_drawn == m_at)
+      return Rect();
+    return m_span(std::min(m_drawn, m_at), std::max(m_drawn, m_at) + m_knob);
+  }
+
+  void ProgressBar::renderDelta(){
+    INSTRUMENTATE(m_parent_ui)
+    m_paint(std::min(m_drawn, m_at), std::max(m_drawn, m_at) + m_knob);
+  }
+
+//--------------------Slider CLASS---------------------------------------------------------------//
+
+  bool Slider::navigate(unsigned int direction){
+    const unsigned int forward = static_cast<unsigned int>(m_grow);
+    float sign;
+    if (direction == forward)
+      sign = 1.0f;
+    else if (direction == (forward + 180U) % 360U)
+      sign = -1.0f;
+    else
+      return false;
+    const float before = m_value;
+    setValue(m_value + sign * (m_step > 0.0f ? m_step : (m_max - m_min) / 20.0f));
+    if (m_value == before) //At the end of the range, the focus can move on
+      return false;
+    if (m_onChange)
+      m_onChange(m_value);
+    return true;
+  }
+
+//--------------------Gauge CLASS---------------------------------------------------------------//
+
+  Gauge::Gauge(Outline style, Point pos, unsigned int size, unsigned int band, uint16_t fill_color, uint16_t track_color, float start, float sweep, bool isCentered)
+    : ValueWidget(ElementType::Gauge, style, pos, size, size, fill_color, track_color, isCentered, FocusStyle::None),
+      m_band(band), m_start(start), m_sweep(std::clamp(sweep, 0.0f, 360.0f))
+  {
+    focusable = false;
+  }
+
+  float Gauge::m_pseudoAngle(float dx, float dy){
+    if (dx == 0.0f && dy == 0.0f)
+      return 0.0f;
+    if (dy >= 0.0f)
+      return dx >= 0.0f ? dy / (dx + dy) : 1.0f - dx / (dy - dx);
+    return dx < 0.0f ? 2.0f - dy / (-dx - dy) : 3.0f + dx / (dx - dy);
+  }
+
+  int Gauge::m_steps() const {
+    const float radius = m_width * 0.5f - outline.thickness - outline.border_distance;
+    return std::max(1, static_cast<int>(m_sweep * static_cast<float>(M_PI / 180.0) * std::max(radius, 0.0f) + 0.5f));
+  }
+
+  int Gauge::m_locate(float value) const {
+    return static_cast<int>(std::clamp(m_fraction(value), 0.0f, 1.0f) * m_steps() + 0.5f);
+  }
+
+  Gauge::Geometry Gauge::m_geometry() const {
+    Geometry geometry;
+    const Point pos = getDrawPoint();
+    const float radius = m_width * 0.5f;
+    const float inner = std::max(radius - m_band, 0.0f);
+    const float edge = static_cast<float>(outline.thickness + outline.border_distance);
+    const float fill_outer = radius - edge, fill_inner = std::max(inner + edge, 0.0f);
+    geometry.cx = pos.x + radius;
+    geometry.cy = pos.y + radius;
+    geometry.outer = radius * radius;
+    geometry.inner = inner * inner;
+    geometry.line_outer = (radius - outline.thickness) * (radius - outline.thickness);
+    geometry.line_inner = (inner + outline.thickness) * (inner + outline.thickness);
+    geometry.fill_outer = fill_outer > fill_inner ? fill_outer * fill_outer : 0.0f;
+    geometry.fill_inner = fill_outer > fill_inner ? fill_inner * fill_inner : 0.0f;
+    const float start = m_start * static_cast<float>(M_PI / 180.0);
+    geometry.start = m_pseudoAngle(cosf(start), sinf(start));
+    geometry.end = m_offsetOf(geometry, m_steps());
+    return geometry;
+  }
+
+  float Gauge::m_offsetOf(const Geometry& geometry, int position) const {
+    const int steps = m_steps();
+    if (position <= 0)
+      return 0.0f;
+    if (position >= steps && m_sweep >= 360.0f)
+      return 4.0f;
+    const float angle = (m_start - m_sweep * std::min(position, steps) / steps) * static_cast<float>(M_PI / 180.0);
+    const float offset = geometry.start - m_pseudoAngle(cosf(angle), sinf(angle));
+    return offset < 0.0f ? offset + 4.0f : offset;
+  }
+
+  Rect Gauge::m_sector(int from, int to) const {
+    if (from >= to)
+      return Rect();
+    const Point pos = getDrawPoint();
+    const float radius = m_width * 0.5f;
+    const float cx = pos.x + radius, cy = pos.y + radius;
+    const float outer = radius - outline.thickness - outline.border_distance;
+    const float inner = std::max(radius - m_band + outline.thickness + outline.border_distance, 0.0f);
+    const int steps = m_steps();
+    const float first = m_start - m_sweep * std::min(from, steps) / steps;  //The fill sweeps clockwise, so `to` has the smaller angle
+    const float last = m_start - m_sweep * std::min(to, steps) / steps;
+
+    float left = cx + outer * cosf(first * static_cast<float>(M_PI / 180.0)), right = left;
+    float top = cy - outer * sinf(first * static_cast<float>(M_PI / 180.0)), bottom = top;
+    auto include = [&](float degrees, float r){
+      const float angle = degrees * static_cast<float>(M_PI / 180.0);
+      const float x = cx + r * cosf(angle), y = cy - r * sinf(angle);
+      left = std::min(left, x); right = std::max(right, x);
+      top = std::min(top, y); bottom = std::max(bottom, y);
+    };
+    include(first, inner);
+    include(last, outer);
+    include(last, inner);
+    for (float axis = ceilf(last / 90.0f) * 90.0f; axis <= first; axis += 90.0f){ //The arc bulges out where it crosses an axis
+      include(axis, outer);
+    }
+    const Rect sector(static_cast<int>(floorf(left)) - 1, static_cast<int>(floorf(top)) - 1,
+                      static_cast<int>(ceilf(right) - floorf(left)) + 2, static_cast<int>(ceilf(bottom) - floorf(top)) + 2);
+    return sector.intersect(getBounds());
+  }
+
+  /*Every pixel is tested against the squared radii first and its angle only after, with a pseudo angle instead of atan2f.
+  A pixel of the fill takes the fill color if it's before the position drawn this frame, the track color otherwise.*/
+  void Gauge::m_paint(const Rect& area, int from, int to) const {
+    Adafruit_GFX* target = m_parent_ui->buffer;
+    const PixelAccess access = m_parent_ui->getPixelAccess();
+    const int left = std::max(area.x, 0), right = std::min<int>(area.right(), target->width());
+    int top = std::max(area.y, 0), bottom = std::min<int>(area.bottom(), target->height());
+    access.clipLines(top, bottom);
+    const Geometry geometry = m_geometry();
+    const bool whole = from < 0;
+    const float first = whole ? 0.0f : m_offsetOf(geometry, from);
+    const float last = whole ? 4.0f : m_offsetOf(geometry, to);
+    const float filled = m_offsetOf(geometry, m_at);
+
+    for (int y = top; y < bottom; y++){
+      const float dy = geometry.cy - (y + 0.5f);
+      if (dy * dy >= geometry.outer)
+        continue;
+      const float half = sqrtf(geometry.outer - dy * dy); //Only the pixels within the outer circle
+      const int x0 = std::max(left, static_cast<int>(floorf(geometry.cx - half - 0.5f)));
+      const int x1 = std::min(right, static_cast<int>(ceilf(geometry.cx + half - 0.5f)) + 1);
+      uint16_t* line = access.line(y);
+      for (int x = x0; x < x1; x++){
+        const float dx = (x + 0.5f) - geometry.cx;
+        const float distance = dx * dx + dy * dy;
+        if (distance >= geometry.outer || distance < geometry.inner)
+          continue;
+        float offset = geometry.start - m_pseudoAngle(dx, dy);
+        if (offset < 0.0f)
+          offset += 4.0f;
+        if (offset >= geometry.end)
+          continue;
+        uint16_t color;
+        if (distance >= geometry.fill_inner && distance < geometry.fill_outer){
+          if (offset < first || offset >= last)
+            continue;
+          color = offset < filled ? fill_color : track_color;
+        }
+        else if (whole && (distance >= geometry.line_outer || distance < geometry.line_inner))
+          color = outline.color;
+        else
+          continue;
+        if (line)
+          line[x] = color;
+        else
+          target->drawPixel(x, y, color);
+      }
+    }
+  }
+
+  void Gauge::render(){
+    INSTRUMENTATE(m_parent_ui)
+    m_paint(getBounds(), -1, 0);
+  }
+
+  Rect Gauge::getDamage() const {
+    return m_sector(std::min(m_drawn, m_at), std::max(m_drawn, m_at));
+  }
+
+  void Gauge::renderDelta(){
+    INSTRUMENTATE(m_parent_ui)
+    const int from = std::min(m_drawn, m_at), to = std::max(m_drawn, m_at);
+    m_paint(m_sector(from, to), from, to);
+  }
+
+//--------------------SampleRing CLASS---------------------------------------------------------------//
+
+  SampleRing::SampleRing(size_t capacity){
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    m_samples = new float[size];
+    m_mask = size - 1;
+  }
+
+  SampleRing::~SampleRing(){
+    delete[] m_samples;
+  }
+
+  bool SampleRing::push(float value){
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail > m_mask){
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    m_samples[head & m_mask] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t SampleRing::read(float* out, size_t max){
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    const size_t len = std::min(max, head - tail);
+    for (size_t i = 0; i < len; i++){
+      out[i] = m_samples[(tail + i) & m_mask];
+    }
+    m_tail.store(tail + len, std::memory_order_release);
+    return len;
+  }
+
+//--------------------Chart CLASS---------------------------------------------------------------//
+
+  Chart::Chart(SampleRing* source, Point pos, unsigned int width, unsigned int height, float min, float max, unsigned int decimation,
+               uint16_t line_color, uint16_t background, bool isCentered)
+    : UIElement(width, height, pos, isCentered, ElementType::Chart), line_color(line_color), background(background), m_source(source),
+      m_columns(width), m_decimation(decimation ? decimation : 1U), m_min(min), m_max(max)
+  {
+    focusable = false;
+  }
+
+  void Chart::setRange(float min, float max){
+    m_min = min;
+    m_max = max;
+    m_redraw = true;
+  }
+
+  void Chart::clear(){
+    m_filled = 0;
+    m_open_count = 0;
+    m_redraw = true;
+  }
+
+  void Chart::m_push(float value){
+    m_samples++;
+    if (m_open_count++ == 0)
+      m_open = Column{value, value, value};
+    else{
+      m_open.low = std::min(m_open.low, value);
+      m_open.high = std::max(m_open.high, value);
+      m_open.last = value;
+    }
+    if (m_open_count < m_decimation || m_columns.empty())
+      return;
+    if (m_filled){
+      const float joint = m_columns[m_newest].last;
+      m_open.low = std::min(m_open.low, joint);
+      m_open.high = std::max(m_open.high, joint);
+    }
+    m_newest = (m_newest + 1) % m_columns.size();
+    m_columns[m_newest] = m_open;
+    m_open_count = 0;
+    m_filled = std::min(m_filled + 1, m_columns.size());
+    m_shift = std::min(m_shift + 1, m_columns.size());
+  }
+
+  //Only the samples waiting are read, never the history, and at most a ring's worth so a fast producer can't hold the frame
+  void Chart::update(){
+    m_full = m_redraw;
+    m_redraw = false;
+    m_shift = 0;
+    if (!m_source)
+      return;
+    float samples[32];
+    size_t budget = m_source->getCapacity();
+    while (budget){
+      const size_t count = m_source->read(samples, std::min<size_t>(budget, 32U));
+      if (!count)
+        break;
+      for (size_t i = 0; i < count; i++){
+        m_push(samples[i]);
+      }
+      budget -= count;
+    }
+  }
+
+  int Chart::m_lineOf(float value) const {
+    const int span = static_cast<int>(m_height) - 1;
+    const float fraction = m_max != m_min ? (value - m_min) / (m_max - m_min) : 0.0f;
+    const float clamped = fraction > 0.0f ? std::min(fraction, 1.0f) : 0.0f; //A NaN sample lands at the bottom
+    return getDrawPoint().y + span - static_cast<int>(clamped * span + 0.5f);
+  }
+
+  void Chart::m_drawColumn(const PixelAccess& access, size_t age, int x, int top, int bottom) const {
+    int first = bottom, last = bottom - 1; //Lines of the plot, none if the column is empty
+    if (age < m_filled){
+      const Column& column = m_columns[(m_newest + m_columns.size() - age) % m_columns.size()];
+      first = std::max(m_lineOf(column.high), top);
+      last = std::min(m_lineOf(column.low), bottom - 1);
+      if (last < first){ //The plot is out of the lines drawn
+        first = bottom;
+        last = bottom - 1;
+      }
+    }
+    if (access.pixels){
+      for (int y = top; y < bottom; y++){
+        access.line(y)[x] = (y >= first && y <= last) ? line_color : background;
+      }
+      return;
+    }
+    Adafruit_GFX* target = m_parent_ui->buffer;
+    if (first > top)
+      target->drawFastVLine(x, top, std::min(first, bottom) - top, background);
+    if (last >= first)
+      target->drawFastVLine(x, first, last - first + 1, line_color);
+    if (last >= first && last + 1 < bottom)
+      target->drawFastVLine(x, last + 1, bottom - last - 1, background);
+  }
+
+  void Chart::render(){
+    INSTRUMENTATE(m_parent_ui)
+    Adafruit_GFX* target = m_parent_ui->buffer;
+    const PixelAccess access = m_parent_ui->getPixelAccess();
+    const Rect bounds = getBounds();
+    int top = std::max(bounds.y, 0), bottom = std::min<int>(bounds.bottom(), target->height());
+    access.clipLines(top, bottom);
+    if (top >= bottom)
+      return;
+    const int right = std::min<int>(bounds.right(), target->width());
+    for (int x = std::max(bounds.x, 0); x < right; x++){
+      m_drawColumn(access, bounds.right() - 1 - x, x, top, bottom);
+    }
+  }
+
+  //Move what's on screen left by the columns added, then draw those. The chart has to lie within the pixels held
+  void Chart::renderDelta(){
+    INSTRUMENTATE(m_parent_ui)
+    const PixelAccess access = m_parent_ui->getPixelAccess();
+    const Rect bounds = getBounds();
+    const bool held = bounds.x >= 0 && bounds.right() <= access.width && bounds.y >= access.top && bounds.bottom() <= access.top + access.lines;
+    if (m_full || !access.pixels || !held || m_shift >= static_cast<size_t>(bounds.width)){
+      render();
+      return;
+    }
+    const int kept = bounds.width - static_cast<int>(m_shift);
+    for (int y = bounds.y; y < bounds.bottom(); y++){
+      uint16_t* line = access.line(y) + bounds.x;
+      memmove(line, line + m_shift, kept * sizeof(uint16_t));
+    }
+    for (int x = bounds.x + kept; x < bounds.right(); x++){
+      m_drawColumn(access, bounds.right() - 1 - x, x, bounds.y, bounds.bottom());
+    }
+  }
+
+//--------------------UIList CLASS---------------------------------------------------------------//
+
+  UIList::UIList(unsigned int count, const Delegate<void(unsigned int, ListItem&)>& source, Point pos, unsigned int width, unsigned int height, unsigned int row_height)
+    : UIElement(width, height, pos, false, ElementType::List, Constraint::TopLeft, FocusStyle::None), m_source(source), m_count(count), m_row_height(row_height ? row_height : 1)
+  {
+    //One row for every full line of the viewport, plus the two that can peek in at the edges while scrolling
+    m_rows.resize(height / m_row_height + 2);
+    anim = Animation(0.0f, 0.0f, scroll_duration, Interpolation::Sinusoidal);
+  }
+
+  UIList::Row& UIList::m_fetchRow(unsigned int index){
+    Row& row = m_rows[index % m_rows.size()];
+    if (row.index != static_cast<int>(index)){
+      row.index = index;
+      row.item = ListItem();
+      if (m_source)
+        m_source(index, row.item);
+    }
+    return row;
+  }
+
+  void UIList::m_drawRow(Adafruit_GFX* target, const PixelAccess& access, const Row& row, int x, int y, bool selected) const {
+    target->fillRect(x, y, m_width, m_row_height, selected ? highlight : background);
+    const uint16_t color = selected ? highlight_text : row.item.color;
+    int text_x = x + 2;
+
+    if (row.item.icon){
+      const Texture* icon = row.item.icon;
+      const int icon_y = y + (static_cast<int>(m_row_height) - static_cast<int>(icon->height)) / 2;
+      UiUtils::drawTexture(target, access, *icon, Point(text_x, icon_y), color);
+      text_x += icon->width + 2;
+    }
+
+    target->setTextSize(1);
+    target->setTextWrap(false);
+    target->setTextColor(color);
+    target->setCursor(text_x, y + (static_cast<int>(m_row_height) - 8) / 2);
+    target->print(row.item.text.c_str());
+  }
+
+  void UIList::update(){
+    anim.Update();
+    m_scroll = static_cast<int>(round(anim.getProgress()));
+  }
+
+  void UIList::render(){
+    INSTRUMENTATE(m_parent_ui)
+    const Point origin = getDrawPoint();
+    const bool focused = isFocused();
+    const int row_height = m_row_height;
+    const int height = m_height;
+
+    unsigned int index = m_scroll / row_height;
+    for (int y = -(m_scroll % row_height); y < height && index < m_count; y += row_height, index++){
+      const Row& row = m_fetchRow(index);
+      const bool selected = focused && index == m_selected;
+
+      if (y >= 0 && y + row_height <= height){
+        m_drawRow(m_parent_ui->buffer, m_parent_ui->getPixelAccess(), row, origin.x, origin.y + y, selected);
+      }
+      else{ //The row is cut by the edges of the list, draw it aside and copy only the visible lines
+        if (!m_row_canvas)
+          m_row_canvas = std::make_unique<GFXcanvas16>(m_width, m_row_height);
+        PixelAccess scratch;
+        scratch.pixels = m_row_canvas->getBuffer();
+        scratch.width = m_width;
+        scratch.lines = m_row_height;
+        m_drawRow(m_row_canvas.get(), scratch, row, 0, 0, selected);
+
+        const int first_line = std::max(0, -y);
+        const int last_line = std::min(row_height, height - y);
+        m_parent_ui->buffer->drawRGBBitmap(origin.x, origin.y + y + first_line, m_row_canvas->getBuffer() + first_line * m_width, m_width, last_line - first_line);
+      }
+    }
+  }
+
+  bool UIList::navigate(unsigned int direction){
+    if (direction == static_cast<unsigned int>(Direction::Down) && m_selected + 1 < m_count){
+      select(m_selected + 1);
+      return true;
+    }
+    if (direction == static_cast<unsigned int>(Direction::Up) && m_selected > 0){
+      select(m_selected - 1);
+      return true;
+    }
+    return false;
+  }
+
+  /*!
+    @brief Select an item, smoothly scrolling the list until it's fully in view
+    @param index The index of the item to select
+  */
+  void UIList::select(unsigned int index){
+    if (m_count == 0)
+      return;
+    m_selected = std::min(index, m_count - 1);
+
+    const int row_top = m_selected * m_row_height;
+    const int row_bottom = row_top + m_row_height;
+    int target = m_target_scroll;
+    if (row_top < target)
+      target = row_top;
+    else if (row_bottom > target + static_cast<int>(m_height))
+      target = row_bottom - m_height;
+
+    if (target != m_target_scroll){
+      m_target_scroll = target;
+      anim = Animation(m_scroll, target, scroll_duration, Interpolation::Sinusoidal);
+      anim.Start();
+    }
+  }
+
+  void UIList::setCount(unsigned int count){
+    m_count = count;
+    invalidate();
+    select(m_selected);
+  }
+
+  void UIList::invalidate(){
+    for (Row& row : m_rows){
+      row.index = -1;
+    }
+  }
+
+//--------------------ScrollView CLASS---------------------------------------------------------------//
+
+  ScrollView::ScrollView(const Delegate<void(Adafruit_GFX*, const PixelAccess&, Point, const Rect&)>& content, unsigned int content_height,
+                         Point pos, unsigned int width, unsigned int height, unsigned int step, unsigned int band_lines, uint16_t background)
+    : UIElement(width, height, pos, false, ElementType::ScrollView, Constraint::TopLeft, FocusStyle::None), background(background), step(step),
+      m_content(content), m_content_height(content_height), m_band_lines(band_lines ? band_lines : 1U){}
+
+  void ScrollView::scrollTo(int offset, bool animate){
+    m_target = std::clamp(offset, 0, getMaxOffset());
+    if (animate && scroll_duration){
+      anim = Animation(m_offset, m_target, scroll_duration, Interpolation::Sinusoidal); //From wherever the last scroll got to
+      anim.Start();
+    }
+    else
+      anim.Pause();
+  }
+
+  void ScrollView::setContentHeight(unsigned int height){
+    m_content_height = height;
+    m_redraw = true;
+    scrollTo(m_target, false);
+  }
+
+  bool ScrollView::navigate(unsigned int direction){
+    int lines;
+    if (direction == static_cast<unsigned int>(Direction::Down))
+      lines = step;
+    else if (direction == static_cast<unsigned int>(Direction::Up))
+      lines = -static_cast<int>(step);
+    else
+      return false;
+    const int before = m_target;
+    scrollBy(lines);
+    return m_target != before; //At either end of the content, the focus can move on
+  }
+
+  //The scroll is reported from here since render() can run once per strip. Only a view that was on screen last frame, in the same place, moved its lines
+  void ScrollView::update(){
+    int offset = m_target;
+    if (anim.isEnabled()){
+      anim.Update();
+      offset = static_cast<int>(round(anim.getProgress()));
+    }
+    offset = std::clamp(offset, 0, getMaxOffset());
+    const Rect bounds = getBounds();
+    const uint32_t frame = m_parent_ui->getFrameCount();
+    m_full = m_redraw || bounds != m_drawn || frame != m_frame + 1;
+    m_redraw = false;
+    m_shift = offset - m_offset;
+    m_offset = offset;
+    m_drawn = bounds;
+    m_frame = frame;
+    if (m_shift && !m_full)
+      m_parent_ui->reportScroll(bounds, m_shift);
+  }
+
+  //The content is drawn a band at a time, the band canvas clips it, then the lines of the band on screen are copied to the buffer
+  void ScrollView::m_drawLines(int first, int count){
+    Adafruit_GFX* target = m_parent_ui->buffer;
+    const PixelAccess access = m_parent_ui->getPixelAccess();
+    const Point origin = getDrawPoint();
+    int top = std::max(origin.y + first, 0), bottom = std::min<int>(origin.y + first + count, target->height());
+    access.clipLines(top, bottom);
+    const int left = std::max(origin.x, 0), right = std::min<int>(origin.x + m_width, target->width());
+    if (top >= bottom || left >= right)
+      return;
+
+    if (!m_band)
+      m_band = std::make_unique<GFXcanvas16>(m_width, m_band_lines);
+    PixelAccess scratch;
+    scratch.pixels = m_band->getBuffer();
+    scratch.width = m_width;
+    scratch.lines = m_band_lines;
+    for (int y = top; y < bottom; y += m_band_lines){
+      const int lines = std::min<int>(m_band_lines, bottom - y);
+      const int content_y = m_offset + y - origin.y; //Line of the content on the first line of the band
+      m_band->fillRect(0, 0, m_width, lines, background);
+      if (m_content)
+        m_content(m_band.get(), scratch, Point(0, -content_y), Rect(0, content_y, m_width, lines));
+      for (int row = 0; row < lines; row++){
+        uint16_t* source = m_band->getBuffer() + row * m_width + (left - origin.x);
+        if (uint16_t* line = access.line(y + row))
+          memcpy(line + left, source, (right - left) * sizeof(uint16_t));
+        else
+          target->drawRGBBitmap(left, y + row, source, right - left, 1);
+      }
+    }
+  }
+
+  void ScrollView::render(){
+    INSTRUMENTATE(m_parent_ui)
+    m_drawLines(0, m_height);
+  }
+
+  //Move the lines already in the buffer by the scroll, then draw the ones it brought in. The view has to lie within the pixels held
+  void ScrollView::renderDelta(){
+    INSTRUMENTATE(m_parent_ui)
+    const PixelAccess access = m_parent_ui->getPixelAccess();
+    const Rect bounds = getBounds();
+    const int distance = std::abs(m_shift);
+    const bool held = bounds.x >= 0 && bounds.right() <= access.width && bounds.y >= access.top && bounds.bottom() <= access.top + access.lines;
+    if (m_full || !access.pixels || !held || distance >= bounds.height){
+      render();
+      return;
+    }
+    const int kept = bounds.height - distance;
+    const size_t row_bytes = bounds.width * sizeof(uint16_t);
+    if (bounds.x == 0 && bounds.width == access.width){ //Whole lines are contiguous, the view moves as one block
+      const int from = m_shift > 0 ? bounds.y + distance : bounds.y, to = m_shift > 0 ? bounds.y : bounds.y + distance;
+      memmove(access.line(to), access.line(from), kept * row_bytes);
+    }
+    else if (m_shift > 0){
+      for (int y = bounds.y; y < bounds.y + kept; y++){
+        memcpy(access.line(y) + bounds.x, access.line(y + distance) + bounds.x, row_bytes);
+      }
+    }
+    else{ //From the bottom, so no line is overwritten before it's moved
+      for (int y = bounds.bottom() - 1; y >= bounds.y + distance; y--){
+        memcpy(access.line(y) + bounds.x, access.line(y - distance) + bounds.x, row_bytes);
+      }
+    }
+    if (m_shift > 0)
+      m_drawLines(kept, distance);
+    else
+      m_drawLines(0, distance);
+  }
+
+//--------------------Container CLASS---------------------------------------------------------------//
+
+  Container::Container(std::initializer_list<UIElement*> children, Point pos, bool isCentered, unsigned int width, unsigned int height)
+    : UIElement(width, height, pos, isCentered, ElementType::Container), m_children(children), m_anchor(pos), m_centered(isCentered),
+      m_fit_width(width == 0), m_fit_height(height == 0)
+  {
+    focusable = false;
+    for (const auto child : m_children)
+      child->m_parent = this;
+  }
+
+  bool Container::updateLayout(){
+    bool changed = m_dirty;
+
+    if (m_position != m_arranged_pos){ //Moved from the outside
+      if (m_centered)
+        m_anchor = getCenterPoint();
+      changed = true;
+    }
+
+    if (m_child_states.size() != m_children.size()){
+      m_child_states.resize(m_children.size());
+      changed = true;
+    }
+
+    for (size_t i = 0; i < m_children.size(); i++){
+      UIElement* child = m_children[i];
+      if (child->getType() == ElementType::Container)
+        static_cast<Container*>(child)->updateLayout();
+
+      ChildState& state = m_child_states[i];
+      if (state.width != child->m_width || state.height != child->m_height || state.draw != child->draw){
+        state = ChildState{child->m_width, child->m_height, child->draw};
+        changed = true;
+      }
+    }
+
+    if (!changed)
+      return false;
+
+    const Point content = m_measure();
+    m_setSize(m_fit_width ? content.x + m_padding*2 : m_width, m_fit_height ? content.y + m_padding*2 : m_height);
+    m_setScaledSize(m_width, m_height);
+    if (m_centered)
+      m_position = centerToCornerPos(m_anchor.x, m_anchor.y, m_width, m_height);
+
+    m_arrange();
+    m_arranged_pos = m_position;
+    m_pos_dirty = true;
+    m_dirty = false;
+    invalidateBounds();
+    return true;
+  }
+
+  //Move a child, rearranging it right away if it's a container itself
+  void Container::m_place(UIElement* child, Point corner){
+    if (child->getPos() == corner)
+      return;
+    child->setPos(corner);
+    if (child->getType() == ElementType::Container)
+      static_cast<Container*>(child)->updateLayout();
+  }
+
+//--------------------Stack CLASS---------------------------------------------------------------//
+
+  Stack::Stack(Axis axis, std::initializer_list<UIElement*> children, Point pos, bool isCentered, unsigned int spacing, Justify justify, Alignment align, unsigned int width, unsigned int height)
+    : Container(children, pos, isCentered, width, height), m_axis(axis), m_justify(justify), m_align(align)
+  {
+    m_spacing = spacing;
+  }
+
+  Point Stack::m_measure() const {
+    unsigned int main = 0, cross = 0, visible = 0;
+    for (const auto child : m_children){
+      if (!child->draw)
+        continue;
+      const unsigned int child_main = m_axis == Axis::Horizontal ? child->getWidth() : child->getHeight();
+      const unsigned int child_cross = m_axis == Axis::Horizontal ? child->getHeight() : child->getWidth();
+      main += child_main;
+      cross = std::max(cross, child_cross);
+      visible++;
+    }
+    if (visible > 1)
+      main += m_spacing * (visible - 1);
+    return m_axis == Axis::Horizontal ? Point(main, cross) : Point(cross, main);
+  }
+
+  void Stack::m_arrange(){
+    const bool horizontal = m_axis == Axis::Horizontal;
+    const Point content = m_measure();
+    const int avail_main = static_cast<int>(horizontal ? m_width : m_height) - static_cast<int>(m_padding*2);
+    const int avail_cross = static_cast<int>(horizontal ? m_height : m_width) - static_cast<int>(m_padding*2);
+    const int free_space = std::max(0, avail_main - (horizontal ? content.x : content.y));
+
+    unsigned int visible = 0;
+    for (const auto child : m_children){
+      if (child->draw)
+        visible++;
+    }
+
+    float offset = 0.0f, gap = m_spacing;
+    switch (m_justify){
+      case Justify::Start:        break;
+      case Justify::Center:       offset = free_space * 0.5f; break;
+      case Justify::End:          offset = free_space; break;
+      case Justify::SpaceBetween: if (visible > 1) gap += static_cast<float>(free_space) / (visible - 1); break;
+      case Justify::SpaceEvenly:  offset = static_cast<float>(free_space) / (visible + 1); gap += offset; break;
+    }
+
+    const Point origin(m_position.x + m_padding, m_position.y + m_padding);
+    float cursor = offset;
+    for (const auto child : m_children){
+      if (!child->draw)
+        continue;
+      const int child_main = horizontal ? child->getWidth() : child->getHeight();
+      const int child_cross = horizontal ? child->getHeight() : child->getWidth();
+
+      int cross = 0;
+      switch (m_align){
+        case Alignment::Start:  break;
+        case Alignment::Center: cross = (avail_cross - child_cross) / 2; break;
+        case Alignment::End:    cross = avail_cross - child_cross; break;
+      }
+
+      const int main = static_cast<int>(round(cursor));
+      m_place(child, horizontal ? Point(origin.x + main, origin.y + cross) : Point(origin.x + cross, origin.y + main));
+      cursor += child_main + gap;
+    }
+  }
+
+//--------------------Grid CLASS---------------------------------------------------------------//
+
+  Grid::Grid(unsigned int columns, std::initializer_list<UIElement*> children, Point pos, bool isCentered, unsigned int spacing)
+    : Container(children, pos, isCentered), m_columns(columns ? columns : 1)
+  {
+    m_spacing = spacing;
+  }
+
+  Point Grid::m_cellSize() const {
+    Point cell;
+    for (const auto child : m_children){
+      if (!child->draw)
+        continue;
+      cell.x = std::max(cell.x, static_cast<int>(child->getWidth()));
+      cell.y = std::max(cell.y, static_cast<int>(child->getHeight()));
+    }
+    return cell;
+  }
+
+  Point Grid::m_measure() const {
+    unsigned int visible = 0;
+    for (const auto child : m_children){
+      if (child->draw)
+        visible++;
+    }
+    if (visible == 0)
+      return Point();
+
+    const Point cell = m_cellSize();
+    const unsigned int columns = std::min(visible, m_columns);
+    const unsigned int rows = (visible + m_columns - 1) / m_columns;
+    return Point(columns * cell.x + (columns - 1) * m_spacing, rows * cell.y + (rows - 1) * m_spacing);
+  }
+
+  void Grid::m_arrange(){
+    const Point cell = m_cellSize();
+    unsigned int slot = 0;
+    for (const auto child : m_children){
+      if (!child->draw)
+        continue;
+      const int column = slot % m_columns;
+      const int row = slot / m_columns;
+      const int x = m_position.x + m_padding + column * (cell.x + m_spacing) + (cell.x - static_cast<int>(child->getWidth())) / 2;
+      const int y = m_position.y + m_padding + row * (cell.y + m_spacing) + (cell.y - static_cast<int>(child->getHeight())) / 2;
+      m_place(child, Point(x, y));
+      slot++;
+    }
+  }
+
+//--------------------Group CLASS---------------------------------------------------------------//
+
+  Group::Group(std::initializer_list<UIElement*> children, Point pos, bool isCentered)
+    : Container(children, pos, isCentered)
+  {
+    for (const auto child : m_children)
+      m_offsets.push_back(child->getPos());
+  }
+
+  void Group::setOffset(const UIElement* child, Point offset){
+    for (size_t i = 0; i < m_children.size(); i++){
+      if (m_children[i] == child){
+        m_offsets[i] = offset;
+        invalidate();
+        return;
+      }
+    }
+  }
+
+  Point Group::getOffset(const UIElement* child) const {
+    for (size_t i = 0; i < m_children.size(); i++){
+      if (m_children[i] == child)
+        return m_offsets[i];
+    }
+    return Point();
+  }
+
+  Point Group::m_measure() const {
+    int width = 0, height = 0;
+    for (size_t i = 0; i < m_children.size(); i++){
+      const UIElement* child = m_children[i];
+      if (!child->draw)
+        continue;
+      width = std::max(width, m_offsets[i].x + static_cast<int>(child->getWidth()));
+      height = std::max(height, m_offsets[i].y + static_cast<int>(child->getHeight()));
+    }
+    return Point(width, height);
+  }
+
+  //Hidden children are moved as well, so they show up in the right place
+  void Group::m_arrange(){
+    for (size_t i = 0; i < m_children.size(); i++){
+      m_place(m_children[i], Point(m_position.x + m_padding + m_offsets[i].x, m_position.y + m_padding + m_offsets[i].y));
+    }
+  }
+
+
+//--------------------ElementTable CLASS---------------------------------------------------------------//
+
+  size_t ElementTable::add(UIElement* element){
+    m_elements.push_back(element);
+    m_end.push_back(m_elements.size());
+    m_seen.push_back(0);
+    m_seen_tree.push_back(0);
+    m_hit.emplace_back();
+    m_paint.emplace_back();
+    m_tree_hit.emplace_back();
+    m_tree_paint.emplace_back();
+    m_synced = false;
+    return m_elements.size() - 1;
+  }
+
+  void ElementTable::endSubtree(size_t row){
+    m_end[row] = m_elements.size();
+  }
+
+  void ElementTable::reserve(size_t count){
+    m_elements.reserve(count);
+    m_end.reserve(count);
+    m_seen.reserve(count);
+    m_seen_tree.reserve(count);
+    m_hit.reserve(count);
+    m_paint.reserve(count);
+    m_tree_hit.reserve(count);
+    m_tree_paint.reserve(count);
+  }
+
+  void ElementTable::sync(const Outline& outline){
+    const bool force = !m_synced || outline.thickness != m_outline.thickness || outline.border_distance != m_outline.border_distance;
+    m_outline = outline;
+    m_synced = true;
+    for (size_t row = 0; row < m_elements.size(); )
+      row = m_syncSubtree(row, force);
+  }
+
+  //!@return The row after the subtree
+  size_t ElementTable::m_syncSubtree(size_t row, bool force){
+    const UIElement* element = m_elements[row];
+    if (!force && m_seen_tree[row] == element->m_subtree_version)
+      return m_end[row];
+
+    if (force || m_seen[row] != element->m_version){
+      m_hit[row] = Rect(element->getPos(), element->getWidth(), element->getHeight());
+      const Rect bounds = element->getBounds();
+      if (element->focus_style == FocusStyle::Outline){
+        const Outline& used = element->custom_focus_outline ? element->focus_outline : m_outline;
+        m_paint[row] = bounds.expand(used.border_distance + used.thickness + 1);
+      }else{
+        m_paint[row] = bounds;
+      }
+      m_seen[row] = element->m_version;
+    }
+
+    Rect hit = m_hit[row], paint = m_paint[row];
+    for (size_t child = row + 1; child < m_end[row]; ){
+      const size_t next = m_syncSubtree(child, force);
+      hit = hit.unite(m_tree_hit[child]);
+      paint = paint.unite(m_tree_paint[child]);
+      child = next;
+    }
+    m_tree_hit[row] = hit;
+    m_tree_paint[row] = paint;
+    m_seen_tree[row] = element->m_subtree_version;
+    return m_end[row];
+  }
+
+  UIElement* ElementTable::focusableAt(Point point, const UIElement* exclude) const {
+    //Row by row, jumping straight to the end of a subtree would make every step wait for the load of m_end
+    size_t skip_to = 0;
+    for (size_t row = 0; row < m_elements.size(); row++){
+      if (row < skip_to)
+        continue;
+      const Rect& tree = m_tree_hit[row];
+      if (point.x < tree.x || point.x > tree.right() || point.y < tree.y || point.y > tree.bottom()){
+        skip_to = m_end[row];
+        continue;
+      }
+      const Rect& hit = m_hit[row];
+      if (point.x >= hit.x && point.x <= hit.right() && point.y >= hit.y && point.y <= hit.bottom()){
+        UIElement* element = m_elements[row];
+        if (element != exclude && element->focusable)
+          return element;
       }
     }
+    return nullptr;
   }
 
 
@@ -304,19 +1609,75 @@ void AnimatedApp::render(){
   Scene::Scene(std::initializer_list<UIElement*> elementGroup, UIElement* first_focus){
 
     for(const auto elem : elementGroup){
-      elements.insert({elem->getId(),elem});
+      m_addElement(elem, true);
     }
 
     primaryElementID = first_focus ? first_focus->getId() : "";
   }
 
   
+  //Register an element, along with the whole content if it's a container
+  void Scene::m_addElement(UIElement* element, bool isRoot){
+    if (!elements.insert({element->getId(), element}).second)
+      return;
+    const size_t row = m_table.add(element);
+    if (element->getType() == ElementType::Container){
+      Container* container = static_cast<Container*>(element);
+      if (isRoot)
+        m_layouts.push_back(container);
+      for (const auto child : container->getChildren()){
+        m_addElement(child, false);
+      }
+    }
+    m_table.endSubtree(row);
+  }
+
+  void Scene::prepareLayout(){
+    for (const auto layout : m_layouts){
+      layout->updateLayout();
+    }
+  }
+
+  void Scene::updateScene(){
+    if (m_update_script)
+      m_update_script();
+    prepareLayout();
+    for (size_t i = 0; i < m_table.size(); i++){
+      UIElement* element = m_table[i];
+      if (element->draw)
+        element->update();
+    }
+    syncElements();
+  }
+
+  void Scene::syncElements() const {
+    m_table.sync(settings.focus.outline);
+  }
+
   void Scene::renderScene() const {
-      if(!settings.scriptOnTop)
+    m_render(nullptr);
+  }
+
+  void Scene::renderScene(const Rect& clip) const {
+    m_render(&clip);
+  }
+
+  void Scene::m_render(const Rect* clip) const {
+      if(m_script && !settings.scriptOnTop){
         m_script();
+        if (clip)
+          syncElements(); //The script may have moved something
+      }
 
-      for (const auto&[id, element] : elements)
+      for (size_t i = 0; i < m_table.size(); i++)
       {
+        if (clip && !clip->intersects(m_table.getSubtreeBounds(i))){
+          i = m_table.getSubtreeEnd(i) - 1; //Nothing below touches the clip either
+          continue;
+        }
+        if (clip && !clip->intersects(m_table.getPaintBounds(i)))
+          continue;
+        UIElement* element = m_table[i];
         if(element->draw){
           element->render();
           if(element->isFocused()&&element->focus_style==FocusStyle::Outline)
@@ -324,11 +1685,27 @@ void AnimatedApp::render(){
         }
       }
 
-      if(settings.scriptOnTop)
+      if(m_script && settings.scriptOnTop){
         m_script();
+        if (clip)
+          syncElements();
+      }
+    }
+
+  //!@return The neighbour resolved at compile time for a direction, nullptr if there's none or the direction isn't Up, Down, Left or Right
+  UIElement* Scene::m_graphNeighbour(UIElement* from, unsigned int direction) const {
+    if (direction % 90 != 0 || direction >= 360)
+      return nullptr;
+    for (size_t i = 0; i < m_graph_size; i++){
+      if (m_graph_elements[i] == from){
+        const int next = m_focus_graph[i].next[direction / 90];
+        return next >= 0 ? m_graph_elements[next] : nullptr;
+      }
     }
+    return nullptr;
+  }
 
-  UIElement* Scene::getElementByUUID(std::string UUID) const {
+  UIElement* Scene::getElementByUUID(const std::string& UUID) const {
     if(!UUID.empty())
       return elements.at(UUID);
     else
@@ -341,14 +1718,83 @@ void AnimatedApp::render(){
     }
   }
 
+//--------------------StaticScene CLASS---------------------------------------------------------------//
+
+  /*!
+    @brief Construct the element described by a spec in place
+    @param spec      The description of the element
+    @param storage   Where the element is constructed, large enough for any element a spec can describe
+    @param textures  Two textures the element can point to, they must live as long as the element
+    @return The element, owned by whoever owns the storage
+  */
+  UIElement* buildStaticElement(const ElementSpec& spec, void* storage, Texture* textures){
+    switch (spec.type){
+      case ElementType::AnimatedApp:
+        textures[0] = spec.textures[0].toTexture();
+        textures[1] = spec.textures[1].toTexture();
+        return new (storage) AnimatedApp(&textures[0], &textures[1], spec.pos, spec.centered, spec.duration, spec.func, spec.constraint);
+      case ElementType::UIImage:
+        textures[0] = spec.textures[0].toTexture();
+        return new (storage) UIImage(&textures[0], spec.pos, spec.centered, spec.focus_style);
+      case ElementType::Checkbox:
+        return new (storage) Checkbox(spec.outline, spec.pos, spec.width, spec.height, spec.color, spec.centered, spec.focus_style);
+      default:
+        assert(false && "This element type can't be described by an ElementSpec");
+        return new (storage) UIElement(spec.width, spec.height, spec.pos, spec.centered);
+    }
+  }
+
 //--------------------UI CLASS---------------------------------------------------------------//
 
-  UI::UI(Scene* first_scene, GFXcanvas16* framebuffer) : focus(Focus(first_scene->primaryElementID)), buffer(framebuffer)
+  UI::UI(Scene* first_scene, Adafruit_GFX* framebuffer, AssetStore* store) : focus(Focus(first_scene->primaryElementID)), buffer(framebuffer),
+    assets(store ? store : &AssetStore::shared())
   {
     AddScene(first_scene);
     focus.focusScene(first_scene);
   }
 
+  PixelAccess UI::getPixelAccess() const {
+    PixelAccess access;
+    if (m_strip){
+      access.pixels = m_strip->getPixels();
+      access.width = m_strip->width();
+      access.top = m_strip->getTop();
+      access.lines = m_strip->getLines();
+    }
+    else if (m_canvas16){
+      access.pixels = m_canvas16->getBuffer();
+      access.width = m_canvas16->width();
+      access.lines = m_canvas16->height();
+    }
+    else if (m_framebuffer){
+      if (m_framebuffer->getFormat() == ColorFormat::RGB565){
+        access.pixels = reinterpret_cast<uint16_t*>(m_framebuffer->getBuffer());
+        access.width = m_framebuffer->width();
+        access.lines = m_framebuffer->height();
+      }
+      else
+        access.framebuffer = m_framebuffer;
+    }
+    return access;
+  }
+
+  void UI::drawTexture(const Texture& texture, Point pos, uint16_t mono_color){
+    UiUtils::drawTexture(buffer, getPixelAccess(), texture, pos, mono_color);
+  }
+
+  void UI::drawTexture(const Texture& texture, const TextureTransform& transform, uint16_t mono_color){
+    const TextureSampling sampling = governor.getKnobs().filtered_scaling ? TextureSampling::Bilinear : TextureSampling::Nearest;
+    UiUtils::drawTexture(buffer, getPixelAccess(), texture, transform, mono_color, sampling);
+  }
+
+  void UI::drawRing(const Rect& outer, unsigned int radius, unsigned int thickness, uint16_t color){
+    UiUtils::drawRing(buffer, getPixelAccess(), outer, radius, thickness, color, governor.getKnobs().antialias);
+  }
+
+  const Texture& UI::animatedTexture(const Texture& source, const Animation& anim){
+    return assets->scaled(source, animatedScale(anim), governor.getKnobs().filtered_scaling);
+  }
+
   void UI::AddScene(Scene* scene){
       scenes.push_back(scene);                 //KEEP IN MIND "REALLOCATES"
       for(const auto&[id, element] : scene->elements){
@@ -358,11 +1804,12 @@ void AnimatedApp::render(){
 
   void UI::FocusScene(Scene* scene){
       focus.focusScene(scene);
+      invalidate();
     }
 
   void UI::Back(){
+    invalidate();
     if (focus.previousScene){
-      Serial.println("Back!");
       if ( !(focus.activeScene->parents.empty()) ) {
         focus.focusScene(focus.previousScene);
       }
@@ -372,6 +1819,8 @@ void AnimatedApp::render(){
   }
 
   void UI::Click(){
+    invalidate();
+    m_clicks++;
     UIElement* focused = getFocused();
     if(focused)
       focused->click();
@@ -397,17 +1846,305 @@ void AnimatedApp::render(){
   }
 
   void UI::Render(){
-    focus.activeScene->renderScene();
+    const uint32_t start = micros();
+    m_frames++;
+    const bool knobs_changed = governor.beginFrame(start);
+    if (knobs_changed)
+      m_applyKnobs();
+    const uint32_t presented = m_presented_us;
+
+    const bool own_clock = m_strip && !Clock::isTicking(); //Every strip has to see the same animation time
+    if (own_clock)
+      Clock::Tick();
+
+    Scene* scene = focus.activeScene;
+    const bool deadline_due = m_has_deadline && static_cast<int32_t>(start - m_deadline) >= 0;
+    //Nothing but the elements that redraw part of themselves may have changed since the last frame
+    bool partial = m_partial_redraw && !knobs_changed && !m_dirty && scene == m_rendered_scene && !scene->isDirty() && !deadline_due
+                   && m_canRenderPartial(scene);
+
+    //Whatever asks for a frame from now on, scripts included, asks for the next one
+    m_dirty = false;
+    scene->m_dirty = false;
+    m_rendered_scene = scene;
+    if (deadline_due)
+      m_has_deadline = false;
+
+    m_syncPreloader();
+    m_syncLoader();
+    scene->updateScene();
+    Rect damage;
+    if (partial)
+      partial = m_collectDamage(scene, damage);
+    if (partial)
+      m_partial_frames++;
+    if (m_strip)
+      m_renderStrips(partial ? &damage : nullptr);
+    else if (partial)
+      m_renderDamage(scene);
+    else{
+      if (m_partial_redraw)
+        buffer->fillScreen(background);
+      scene->renderScene();
+    }
     m_updateFocus();
+
+    if (own_clock)
+      Clock::Release();
+    governor.addRenderTime(micros() - start - (m_presented_us - presented)); //Strips are presented while rendering
+  }
+
+  bool UI::needsFrame() const {
+    const Scene* scene = focus.activeScene;
+    if (m_dirty || scene != m_rendered_scene || scene->isDirty())
+      return true;
+    if (m_has_deadline && static_cast<int32_t>(micros() - m_deadline) >= 0)
+      return true;
+    const ElementTable& table = scene->getTable();
+    for (size_t i = 0; i < table.size(); i++){
+      const UIElement* element = table[i];
+      if (element->draw && element->isAnimating())
+        return true;
+    }
+    return false;
+  }
+
+  void UI::invalidate(){
+    m_dirty = true;
+    m_wake();
+  }
+
+  //Wake the task blocked in waitForFrame(), without forcing the next frame to be drawn whole
+  void UI::m_wake(){
+    const TaskHandle_t waiter = m_waiter;
+    if (waiter)
+      xTaskNotifyGive(waiter);
+  }
+
+  void UI::scheduleFrame(uint32_t delay_us){
+    const uint32_t deadline = micros() + delay_us;
+    if (!m_has_deadline || static_cast<int32_t>(deadline - m_deadline) < 0){
+      m_deadline = deadline;
+      m_has_deadline = true;
+    }
+  }
+
+  bool UI::waitForFrame(uint32_t max_wait_us){
+    if (needsFrame())
+      return true;
+    uint32_t wait = max_wait_us;
+    if (m_has_deadline)
+      wait = std::min<uint32_t>(wait, std::max<int32_t>(0, static_cast<int32_t>(m_deadline - micros())));
+
+    m_waiter = xTaskGetCurrentTaskHandle();
+    //Rounded up, a wait shorter than a tick would not block at all and the caller would spin
+    const uint32_t tick_us = portTICK_PERIOD_MS * 1000;
+    const TickType_t ticks = (wait + tick_us - 1) / tick_us;
+    if (!needsFrame()) //An invalidation between the first check and the registration would be lost otherwise
+      ulTaskNotifyTake(pdTRUE, ticks);
+    m_waiter = nullptr;
+    return needsFrame();
+  }
+
+  void UI::m_present(Adafruit_GFX* target){
+    const uint32_t start = micros();
+    if (m_display)
+      m_display(target);
+    const uint32_t elapsed = micros() - start;
+    m_presented_us += elapsed;
+    governor.addPresentTime(elapsed);
+  }
+
+  //The cache of scaled textures is the only knob that lives outside of the UI
+  void UI::m_applyKnobs(){
+    if (!m_base_scaled_budget)
+      m_base_scaled_budget = assets->getScaledBudget();
+    assets->setScaledBudget(m_base_scaled_budget * governor.getKnobs().cache_factor);
+  }
+
+  void UI::bindLoader(TextureLoader* loader){
+    if (m_loader && m_loaded_scene)
+      m_loader->deactivate(m_loaded_scene);
+    m_loader = loader;
+    m_loaded_scene = nullptr;
+    m_syncLoader();
+  }
+
+  //Scenes can be changed from anywhere (FocusScene, Back, scripts), the loader is told only when a frame is about to show the change
+  void UI::m_syncLoader(){
+    if (!m_loader || m_loaded_scene == focus.activeScene)
+      return;
+    if (m_loaded_scene)
+      m_loader->deactivate(m_loaded_scene); //First, so its textures can make room for the new ones
+    m_loaded_scene = focus.activeScene;
+    m_loader->activate(m_loaded_scene);
+  }
+
+  void UI::m_syncPreloader(){
+    if (!m_preloader)
+      return;
+    const UIElement* focused = getFocused();
+    if (focus.activeScene == m_preload_scene && focused == m_preload_focus)
+      return;
+    if (focus.activeScene != m_preload_scene) //The new scene may be the one being prepared, the preloader must let go of it
+      m_preloader->cancel();
+    m_preload_scene = focus.activeScene;
+    m_preload_focus = focused;
+
+    std::vector<Scene*> targets;
+    if (focused && focused->getType() == ElementType::AnimatedApp){
+      Scene* target = static_cast<const AnimatedApp*>(focused)->getTarget();
+      if (target && target != focus.activeScene)
+        targets.push_back(target);
+    }
+    for (Scene* scene : scenes){
+      const bool is_child = std::find(scene->parents.begin(), scene->parents.end(), focus.activeScene) != scene->parents.end();
+      if (is_child && std::find(targets.begin(), targets.end(), scene) == targets.end())
+        targets.push_back(scene);
+    }
+    m_preloader->request(targets);
+  }
+
+  //!@return True if nothing but the elements that can redraw part of themselves may change in the next frame
+  bool UI::m_canRenderPartial(const Scene* scene) const {
+    if (scene->m_script) //It can draw anywhere
+      return false;
+    const ElementTable& table = scene->getTable();
+    for (size_t i = 0; i < table.size(); i++){
+      const UIElement* element = table[i];
+      if (element->draw && element->isAnimating() && !element->canRenderDelta())
+        return false;
+    }
+    return true;
+  }
+
+  /*!
+    @brief Gather the areas the elements that redraw part of themselves changed this frame
+    @param damage  Grown to cover them all
+    @return False if another element is drawn over a change, the whole frame has to be drawn then. Strips are always drawn whole
+  */
+  bool UI::m_collectDamage(const Scene* scene, Rect& damage) const {
+    const ElementTable& table = scene->getTable();
+    for (size_t i = 0; i < table.size(); i++){
+      const UIElement* element = table[i];
+      if (!element->draw || !element->canRenderDelta())
+        continue;
+      const Rect changed = element->getDamage();
+      if (changed.isEmpty())
+        continue;
+      damage = damage.unite(changed);
+      if (m_strip)
+        continue;
+      for (size_t j = i + 1; j < table.size(); j++){ //Containers don't draw anything themselves
+        if (table[j]->draw && table[j]->getType() != ElementType::Container && table.getPaintBounds(j).intersects(changed))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  //Only the part of the area on screen counts, the display scrolls whole lines so it has to span them
+  void UI::reportScroll(const Rect& area, int lines){
+    const Rect shown = area.intersect(Rect(0, 0, buffer->width(), buffer->height()));
+    if (!m_scroller || shown.isEmpty() || shown.x != 0 || shown.width != buffer->width())
+      return;
+    m_scroller(shown.y, shown.height, lines);
+  }
+
+  //Bring the last frame up to date, only the elements that changed draw and only what changed
+  void UI::m_renderDamage(const Scene* scene){
+    const ElementTable& table = scene->getTable();
+    for (size_t i = 0; i < table.size(); i++){
+      UIElement* element = table[i];
+      if (element->draw && element->canRenderDelta() && !element->getDamage().isEmpty())
+        element->renderDelta();
+    }
+  }
+
+  //Render and present every strip, or only the ones a damage touches. The panel keeps showing the others
+  void UI::m_renderStrips(const Rect* damage){
+    if (m_mirror)
+      m_mirror->nextFrame();
+    for (int16_t top = 0; top < m_strip->height(); top += m_strip->getStripHeight()){
+      const int lines = std::min<int>(m_strip->getStripHeight(), m_strip->height() - top);
+      if (damage && (top + lines <= damage->y || top >= damage->bottom()))
+        continue;
+      m_strip->setBand(top);
+      m_strip->fillScreen(background);
+      focus.activeScene->renderScene(Rect(0, top, m_strip->width(), m_strip->getLines()));
+      m_present(m_strip);
+      m_mirrorBand(reinterpret_cast<const uint8_t*>(m_strip->getPixels()), top, m_strip->getLines());
+    }
+  }
+
+  void UI::Present(){
+    if (m_strip)
+      return;
+    m_present(buffer);
+    if (m_mirror){
+      m_mirror->nextFrame();
+      const uint8_t* pixels = m_canvas16 ? reinterpret_cast<const uint8_t*>(m_canvas16->getBuffer()) : m_framebuffer->getBuffer();
+      m_mirrorBand(pixels, 0, buffer->height());
+    }
+  }
+
+  bool UI::bindMirror(FrameMirror* mirror){
+    m_mirror = nullptr;
+    if (!mirror)
+      return true;
+    bool ready = false;
+    if (m_strip || m_canvas16)
+      ready = mirror->begin(buffer->width(), buffer->height(), 16, buffer->width() * sizeof(uint16_t));
+    else if (m_framebuffer)
+      ready = mirror->begin(buffer->width(), buffer->height(), static_cast<uint8_t>(m_framebuffer->getFormat()), m_framebuffer->getStride());
+    if (ready)
+      m_mirror = mirror;
+    return ready;
+  }
+
+  //Hand a band of the buffer to the mirror, with the palette of the indexed formats
+  void UI::m_mirrorBand(const uint8_t* lines, int16_t top, int16_t count){
+    if (!m_mirror)
+      return;
+    if (m_framebuffer && m_framebuffer->getFormat() == ColorFormat::Palette4){
+      const FrameBuffer4* indexed = static_cast<const FrameBuffer4*>(m_framebuffer);
+      m_mirror->setPalette(indexed->getPalette(), indexed->getPaletteSize());
+    }
+    else if (m_framebuffer && m_framebuffer->getFormat() == ColorFormat::Mono){
+      const FrameBuffer1* mono = static_cast<const FrameBuffer1*>(m_framebuffer);
+      const uint16_t colors[2] = {mono->background, mono->foreground};
+      m_mirror->setPalette(colors, 2);
+    }
+    m_mirror->capture(lines, top, count);
+  }
+
+  void UI::Frame(){
+    if (!m_strip && !m_partial_redraw) //Render() clears it when the whole frame is drawn
+      buffer->fillScreen(background);
+    Render();
+    Present();
   }
 
   void UI::m_focusDir(unsigned int direction, FocusingAlgorithm alg){
     if(isFocusingFree()){
       m_focusing_busy = true;
 
+      UIElement* focused = getFocused();
+      if (focused && focused->navigate(direction)){
+        //An element that redraws part of itself reports what the input changed, the rest of the frame can be kept
+        if (focused->canRenderDelta())
+          m_wake();
+        else
+          invalidate();
+        return;
+      }
+      invalidate();
+
       UIElement* next_element;
       if (focus.activeScene->elements.empty())
         return;
+      else if (focus.activeScene->m_focus_graph && direction % 90 == 0)
+        next_element = focus.activeScene->m_graphNeighbour(focused, direction);
       else
         next_element = UiUtils::SignedDistance(direction, focus.activeScene, focus.activeScene->getElementByUUID(focus.focusedElementID));
 
@@ -416,6 +2153,8 @@ void AnimatedApp::render(){
         focus.focusedElementID = next_element->getId();
       }
     }
+    else
+      invalidate(); //The focus is still moving, the input is dropped but the frame is drawn again as it always was
   }
 
   void UI::m_updateFocus(){
@@ -438,9 +2177,548 @@ void AnimatedApp::render(){
   }
   #endif
 
+//--------------------UIGroup CLASS---------------------------------------------------------------//
+
+  void UIGroup::Render(){
+    Clock::Tick();
+    for (const auto ui : m_uis){
+      ui->Frame();
+    }
+    Clock::Release();
+  }
+
+//--------------------UITelemetry CLASS---------------------------------------------------------------//
+
+  void UITelemetry::sample(){
+    if (!m_ui || !m_channel)
+      return;
+    if (m_hello_requested.exchange(false))
+      hello(m_hello_mhz);
+    m_sampleFocus();
+
+    const uint32_t now = micros();
+    const FrameStats& stats = m_ui->governor.getStats();
+    if ((m_reported && now - m_last_report < m_interval) || stats.frames == m_last_frame)
+      return;
+    m_reported = true;
+    m_last_report = now;
+    m_last_frame = stats.frames;
+    m_channel->post(TelemetryRecord(TelemetryType::Frame).number(stats.frames).number(stats.render_us).number(stats.present_us)
+                    .number(stats.average_us).number(stats.worst_us).number(static_cast<uint32_t>(m_ui->governor.getQuality())).number(stats.over_budget));
+    m_channel->post(TelemetryRecord::heap());
+    if (m_transport){
+      const TransportStats& sent = m_transport->getStats();
+      m_channel->post(TelemetryRecord(TelemetryType::Transport).number(sent.frames).number(sent.regions).number(sent.command_bytes).number(sent.pixel_bytes));
+    }
+    #if PERFORMANCE_PROFILING
+    for (const auto& [name, time] : m_ui->getPerfStats()){
+      m_channel->post(TelemetryRecord(TelemetryType::Perf).number(time).text(name.c_str()));
+    }
+    #endif
+  }
+
+  //Post the focused element when it changes, and the state of its animation when that changes
+  void UITelemetry::m_sampleFocus(){
+    if (!m_ui->focus.activeScene)
+      return;
+    UIElement* focused = m_ui->getFocused();
+    if (!focused)
+      return;
+    const std::string& id = m_ui->focus.focusedElementID;
+    const bool moved = id != m_focused;
+    if (moved){
+      m_focused = id;
+      m_channel->post(TelemetryRecord(TelemetryType::Focus).number(static_cast<uint32_t>(focused->getType())).text(id.c_str()));
+    }
+    const AnimState state = focused->anim.getState();
+    const bool direction = focused->anim.getDirection();
+    if (moved || state != m_anim_state || direction != m_anim_direction){
+      m_anim_state = state;
+      m_anim_direction = direction;
+      m_channel->post(TelemetryRecord(TelemetryType::Animation).number(static_cast<uint32_t>(state)).number(direction)
+                      .signedNumber(static_cast<int32_t>(lroundf(focused->anim.getProgress() * 1000.0f))).text(id.c_str()));
+    }
+  }
+
+  void UITelemetry::hello(uint32_t cpu_mhz){
+    if (m_channel)
+      m_channel->post(TelemetryRecord(TelemetryType::Hello).number(TelemetryCodec::version).number(millis()).number(cpu_mhz));
+  }
+
+//--------------------FrameGovernor CLASS---------------------------------------------------------------//
+
+  FrameGovernor::FrameGovernor(uint32_t budget_us){
+    RenderKnobs& low = m_tiers[static_cast<int>(Quality::Low)];
+    low.scale_step = 1.0f / 16.0f;
+    low.antialias = false;
+    low.cache_factor = 4;
+    RenderKnobs& medium = m_tiers[static_cast<int>(Quality::Medium)];
+    medium.scale_step = 1.0f / 32.0f;
+    medium.cache_factor = 2;
+    RenderKnobs& high = m_tiers[static_cast<int>(Quality::High)];
+    high.filtered_scaling = true;
+    setBudget(budget_us);
+  }
+
+  void FrameGovernor::setBudget(uint32_t budget_us){
+    m_budget = budget_us;
+    for (int i = 0; i < 3; i++)
+      m_tiers[i].frame_interval = static_cast<uint32_t>(budget_us * m_interval_factors[i]);
+    m_quality = Quality::Medium;
+    m_slow_frames = m_fast_frames = 0;
+    m_changed = true;
+  }
+
+  void FrameGovernor::setKnobs(Quality quality, const RenderKnobs& knobs, float interval_factor){
+    const int tier = static_cast<int>(quality);
+    m_tiers[tier] = knobs;
+    m_interval_factors[tier] = interval_factor;
+    m_tiers[tier].frame_interval = static_cast<uint32_t>(m_budget * interval_factor);
+    m_changed = true;
+  }
+
+  bool FrameGovernor::beginFrame(uint32_t now_us){
+    bool changed = m_changed;
+    m_changed = false;
+
+    if (m_measuring){
+      const uint32_t total = m_render_us + m_present_us;
+      //A spike counts at most as twice the budget, so one slow frame can't keep the average high for long
+      const uint32_t sample = m_budget ? std::min(total, m_budget * 2) : total;
+      m_stats.frames++;
+      m_stats.render_us = m_render_us;
+      m_stats.present_us = m_present_us;
+      m_stats.average_us = m_stats.frames == 1 ? std::min(sample, m_budget ? m_budget : sample)
+                                               : m_stats.average_us + (static_cast<int32_t>(sample) - static_cast<int32_t>(m_stats.average_us)) / 8;
+      m_stats.worst_us = std::max(m_stats.worst_us, total);
+
+      if (m_budget){
+        if (total > m_budget)
+          m_stats.over_budget++;
+        //Hysteresis: the average has to stay over the budget for a few frames to lower the quality,
+        //and well under it for a lot longer to raise it again
+        if (m_stats.average_us > m_budget){
+          m_fast_frames = 0;
+          if (++m_slow_frames >= 8 && m_quality != Quality::Low){
+            m_setQuality(static_cast<Quality>(static_cast<int>(m_quality) - 1));
+            changed = true;
+          }
+        }
+        else if (m_stats.average_us < m_budget * 3 / 4){
+          m_slow_frames = 0;
+          if (++m_fast_frames >= 90 && m_quality != Quality::High){
+            m_setQuality(static_cast<Quality>(static_cast<int>(m_quality) + 1));
+            changed = true;
+          }
+        }
+        else{
+          m_slow_frames = m_fast_frames = 0;
+        }
+      }
+    }
+
+    m_render_us = m_present_us = 0;
+    m_frame_start = now_us;
+    m_measuring = true;
+    return changed;
+  }
+
+  void FrameGovernor::m_setQuality(Quality quality){
+    m_quality = quality;
+    m_slow_frames = m_fast_frames = 0;
+    m_stats.quality_changes++;
+  }
+
+  float FrameGovernor::sampleScale(const Animation& anim) const {
+    const float value = anim.getProgress();
+    const float step = getKnobs().scale_step;
+    if (step <= 0.0f || anim.getState() != AnimState::Running)
+      return value;
+    return roundf(value / step) * step;
+  }
+
+//--------------------ScenePreloader CLASS---------------------------------------------------------------//
+
+  ScenePreloader::~ScenePreloader(){
+    if (m_task_handle){
+      m_stopper = xTaskGetCurrentTaskHandle();
+      m_stop = true;
+      m_cancel = true;
+      xTaskNotifyGive(m_task_handle);
+      while (!m_exited) //The task deletes itself once it's done with the preloader, this task may be notified for other reasons
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+
+  bool ScenePreloader::start(unsigned int priority, int core, uint32_t stack_size){
+    if (m_task_handle)
+      return true;
+    return xTaskCreatePinnedToCore(m_task, "Preloader", stack_size, this, priority, &m_task_handle, core) == pdPASS;
+  }
+
+  void ScenePreloader::m_task(void* preloader){
+    ScenePreloader* self = static_cast<ScenePreloader*>(preloader);
+    while (!self->m_stop){
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      while (!self->m_stop && self->poll());
+    }
+    const TaskHandle_t stopper = self->m_stopper;
+    self->m_exited = true;  //The preloader can be gone right after this
+    xTaskNotifyGive(stopper);
+    vTaskDelete(nullptr);
+  }
+
+  void ScenePreloader::request(const std::vector<Scene*>& scenes){
+    {
+      std::lock_guard<std::mutex> lock(m_request_lock);
+      m_pending = scenes;
+      m_has_pending = true;
+      m_cancel = true;  //Whatever is being prepared is stale now
+    }
+    if (m_task_handle)
+      xTaskNotifyGive(m_task_handle);
+  }
+
+  void ScenePreloader::cancel(){
+    {
+      std::lock_guard<std::mutex> lock(m_request_lock);
+      m_pending.clear();
+      m_has_pending = false;
+      m_cancel = true;
+    }
+    std::lock_guard<std::mutex> work(m_work_lock);
+  }
+
+  bool ScenePreloader::poll(){
+    std::lock_guard<std::mutex> work(m_work_lock);
+    std::vector<Scene*> scenes;
+    {
+      std::lock_guard<std::mutex> lock(m_request_lock);
+      if (!m_has_pending)
+        return false;
+      scenes.swap(m_pending);
+      m_has_pending = false;
+      m_cancel = false;
+    }
+
+    size_t budget = m_budget;
+    for (Scene* scene : scenes){
+      if (m_cancel)
+        return true;
+      const size_t decoded = m_loader->preload(scene, budget, &m_cancel);
+      budget -= std::min(decoded, budget);
+    }
+    if (m_cancel)
+      return true;
+    m_completed++;
+    return true;
+  }
+
 //--------------------UiUtils NAMESPACE---------------------------------------------------------------//
 
   namespace UiUtils{
+    void blendPixel(Adafruit_GFX* target, const PixelAccess& access, int16_t x, int16_t y, uint16_t color, uint8_t alpha){
+      if (alpha == 0 || x < 0 || x >= target->width())
+        return;
+      if (access.pixels){
+        uint16_t* line = access.line(y);
+        if (line)
+          line[x] = alpha >= 32 ? color : ColorUtils::blend565(line[x], color, alpha);
+      }
+      else if (access.framebuffer){
+        if (y >= 0 && y < target->height())
+          target->drawPixel(x, y, alpha >= 32 ? color : ColorUtils::blend565(access.framebuffer->getPixel(x, y), color, alpha));
+      }
+      else if (alpha >= 16){
+        target->drawPixel(x, y, color);
+      }
+    }
+
+    void drawTexture(Adafruit_GFX* target, const PixelAccess& access, const Texture& texture, Point pos, uint16_t mono_color){
+      if (!texture.data.mono) //The pixels of a loaded texture aren't resident
+        return;
+      switch (texture.data.colorspace){
+        case PixelType::Mono:
+          if (texture.getStride() == texture.width){
+            target->drawBitmap(pos.x, pos.y, texture.data.mono, texture.width, texture.height, mono_color);
+            break;
+          }
+          for (unsigned int ty = 0; ty < texture.height; ty++){ //A view of an atlas, its rows are further apart than its width
+            const uint8_t* row = texture.data.mono + ty * ((texture.getStride() + 7) / 8);
+            for (unsigned int tx = 0; tx < texture.width; tx++){
+              if (row[tx / 8] & (0x80 >> (tx % 8)))
+                target->drawPixel(pos.x + tx, pos.y + ty, mono_color);
+            }
+          }
+          break;
+        case PixelType::RGB565:
+          if (texture.getStride() == texture.width){
+            target->drawRGBBitmap(pos.x, pos.y, texture.data.rgb565, texture.width, texture.height);
+            break;
+          }
+          for (unsigned int ty = 0; ty < texture.height; ty++)
+            target->drawRGBBitmap(pos.x, pos.y + ty, texture.data.rgb565 + ty * texture.getStride(), texture.width, 1);
+          break;
+        case PixelType::RGB565A4:{
+          //Only the part of the texture that lands on the canvas is blended
+          const int first_x = std::max(0, -pos.x);
+          const int last_x = std::min<int>(texture.width, target->width() - pos.x);
+          if (last_x <= first_x)
+            return;
+          const unsigned int stride = texture.getStride();
+          const unsigned int alpha_stride = (stride + 1) / 2;
+
+          for (unsigned int ty = 0; ty < texture.height; ty++){
+            const int16_t y = pos.y + ty;
+            const uint16_t* src = texture.data.rgb565 + ty * stride;
+            const uint8_t* alpha = texture.data.alpha + ty * alpha_stride;
+            if (access.pixels){
+              uint16_t* line = access.line(y);
+              if (line)
+                ColorUtils::blendSpan565A4(line + pos.x + first_x, src + first_x, alpha, first_x, last_x - first_x);
+              continue;
+            }
+            for (int tx = first_x; tx < last_x; tx++)
+              blendPixel(target, access, pos.x + tx, y, src[tx], ColorUtils::alpha4To32(texture.data.getAlpha(tx, ty, stride)));
+          }
+          break;
+        }
+      }
+    }
+
+    static int64_t floorDiv(int64_t num, int64_t den){
+      return num >= 0 ? num / den : -((-num + den - 1) / den);
+    }
+
+    //Narrow [first, last) to the steps k where start + k * step stays within [0, limit)
+    static void clipSpan(int64_t start, int64_t step, int64_t limit, int& first, int& last){
+      int64_t low, high;
+      if (step == 0){
+        if (start < 0 || start >= limit)
+          last = first;
+        return;
+      }
+      if (step > 0){
+        low = -floorDiv(start, step);
+        high = floorDiv(limit - 1 - start, step) + 1;
+      }
+      else{
+        low = -floorDiv(limit - 1 - start, -step);
+        high = floorDiv(start, -step) + 1;
+      }
+      first = static_cast<int>(std::max<int64_t>(first, low));
+      last = static_cast<int>(std::min<int64_t>(last, high));
+    }
+
+    //Mix four RGB565 pixels, the weights are 5 bit fractions of the distance to the second pixel on each axis
+    static uint16_t bilinear565(uint16_t p00, uint16_t p01, uint16_t p10, uint16_t p11, uint32_t wx, uint32_t wy){
+      auto spread = [](uint16_t c){ return (c | (uint32_t(c) << 16)) & 0x07E0F81F; };
+      const uint32_t top = ((spread(p00) * (32 - wx) + spread(p01) * wx) >> 5) & 0x07E0F81F;
+      const uint32_t bottom = ((spread(p10) * (32 - wx) + spread(p11) * wx) >> 5) & 0x07E0F81F;
+      const uint32_t mixed = ((top * (32 - wy) + bottom * wy) >> 5) & 0x07E0F81F;
+      return static_cast<uint16_t>(mixed | (mixed >> 16));
+    }
+
+    //The screen lines a transformed texture covers, and where the texture is at the center of the first pixel of each one
+    struct TransformedSpans{
+      TextureTransform inverse;
+      int first_x, last_x, first_y, last_y;
+    };
+
+    /*!
+      @brief Draw the spans of a transformed texture, specialized on its pixel type and sampling so the inner loop doesn't branch on them
+    */
+    template<PixelType Type, bool Bilinear>
+    static void drawTransformed(Adafruit_GFX* target, const PixelAccess& access, const Texture& texture, const TransformedSpans& spans, uint16_t mono_color){
+      const TextureTransform& inverse = spans.inverse;
+      const unsigned int stride = texture.getStride();
+      const unsigned int mono_stride = (stride + 7) / 8;
+      const int32_t max_u = static_cast<int32_t>(texture.width - 1), max_v = static_cast<int32_t>(texture.height - 1);
+      auto monoBit = [&](int32_t x, int32_t y) -> uint32_t { return (texture.data.mono[y * mono_stride + x / 8] >> (7 - x % 8)) & 1; };
+      auto opacity = [&](int32_t x, int32_t y) -> uint32_t { return ColorUtils::alpha4To32(texture.data.getAlpha(x, y, stride)); };
+
+      for (int y = spans.first_y; y < spans.last_y; y++){
+        //Texture position of the center of the first pixel, then one step per pixel to the right
+        const int64_t u = ((static_cast<int64_t>(inverse.a) * (2 * spans.first_x + 1) + static_cast<int64_t>(inverse.b) * (2 * y + 1)) >> 1) + inverse.tx;
+        const int64_t v = ((static_cast<int64_t>(inverse.c) * (2 * spans.first_x + 1) + static_cast<int64_t>(inverse.d) * (2 * y + 1)) >> 1) + inverse.ty;
+        int first = 0, last = spans.last_x - spans.first_x;
+        clipSpan(u, inverse.a, static_cast<int64_t>(texture.width) << 16, first, last);
+        clipSpan(v, inverse.c, static_cast<int64_t>(texture.height) << 16, first, last);
+        if (first >= last)
+          continue;
+        int32_t fu = static_cast<int32_t>(u + static_cast<int64_t>(inverse.a) * first);
+        int32_t fv = static_cast<int32_t>(v + static_cast<int64_t>(inverse.c) * first);
+        uint16_t* line = access.line(y);
+
+        for (int x = spans.first_x + first; x < spans.first_x + last; x++, fu += inverse.a, fv += inverse.c){
+          uint16_t color = mono_color;
+          uint32_t alpha = 32;
+          if constexpr (!Bilinear){
+            const int32_t su = fu >> 16, sv = fv >> 16;
+            if constexpr (Type == PixelType::Mono)
+              alpha = monoBit(su, sv) << 5;
+            else
+              color = texture.data.rgb565[sv * stride + su];
+            if constexpr (Type == PixelType::RGB565A4)
+              alpha = opacity(su, sv);
+          }
+          else{
+            //Pixel centers are half a pixel in, the edges repeat the outer pixels
+            const int32_t cu = std::max<int32_t>(fu - 32768, 0), cv = std::max<int32_t>(fv - 32768, 0);
+            const int32_t x0 = std::min(cu >> 16, max_u), y0 = std::min(cv >> 16, max_v);
+            const int32_t x1 = std::min(x0 + 1, max_u), y1 = std::min(y0 + 1, max_v);
+            const uint32_t wx = (cu >> 11) & 0x1F, wy = (cv >> 11) & 0x1F;
+            auto mix = [&](uint32_t p00, uint32_t p01, uint32_t p10, uint32_t p11){
+              return ((p00 * (32 - wx) + p01 * wx) * (32 - wy) + (p10 * (32 - wx) + p11 * wx) * wy) >> 10;
+            };
+            if constexpr (Type == PixelType::Mono){
+              alpha = mix(monoBit(x0, y0) << 5, monoBit(x1, y0) << 5, monoBit(x0, y1) << 5, monoBit(x1, y1) << 5);
+            }
+            else{
+              const uint16_t* top = texture.data.rgb565 + y0 * stride;
+              const uint16_t* bottom = texture.data.rgb565 + y1 * stride;
+              color = bilinear565(top[x0], top[x1], bottom[x0], bottom[x1], wx, wy);
+            }
+            if constexpr (Type == PixelType::RGB565A4)
+              alpha = mix(opacity(x0, y0), opacity(x1, y0), opacity(x0, y1), opacity(x1, y1));
+          }
+          if (alpha == 0)
+            continue;
+          if (line)
+            line[x] = alpha >= 32 ? color : ColorUtils::blend565(line[x], color, alpha);
+          else if (alpha >= 32)
+            target->drawPixel(x, y, color);
+          else
+            blendPixel(target, access, x, y, color, alpha);
+        }
+      }
+    }
+
+    void drawTexture(Adafruit_GFX* target, const PixelAccess& access, const Texture& texture, const TextureTransform& transform, uint16_t mono_color, TextureSampling sampling){
+      TransformedSpans spans;
+      if (!texture.data.mono || texture.width == 0 || texture.height == 0 || !transform.inverse(spans.inverse))
+        return;
+
+      //Screen bounds of the texture's corners, clipped to the canvas and to the lines it holds
+      int32_t min_x = INT32_MAX, min_y = INT32_MAX, max_x = INT32_MIN, max_y = INT32_MIN;
+      for (int corner = 0; corner < 4; corner++){
+        const int64_t u = (corner & 1) ? texture.width : 0, v = (corner & 2) ? texture.height : 0;
+        const int32_t x = static_cast<int32_t>(transform.a * u + transform.b * v + transform.tx);
+        const int32_t y = static_cast<int32_t>(transform.c * u + transform.d * v + transform.ty);
+        min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+      }
+      spans.first_x = std::max<int32_t>(min_x >> 16, 0);
+      spans.last_x = std::min<int32_t>((max_x >> 16) + 1, target->width());
+      spans.first_y = std::max<int32_t>(min_y >> 16, 0);
+      spans.last_y = std::min<int32_t>((max_y >> 16) + 1, target->height());
+      access.clipLines(spans.first_y, spans.last_y);
+      if (spans.first_x >= spans.last_x || spans.first_y >= spans.last_y)
+        return;
+
+      const bool bilinear = sampling == TextureSampling::Bilinear;
+      switch (texture.data.colorspace){
+        case PixelType::Mono:
+          bilinear ? drawTransformed<PixelType::Mono, true>(target, access, texture, spans, mono_color)
+                   : drawTransformed<PixelType::Mono, false>(target, access, texture, spans, mono_color);
+          break;
+        case PixelType::RGB565:
+          bilinear ? drawTransformed<PixelType::RGB565, true>(target, access, texture, spans, mono_color)
+                   : drawTransformed<PixelType::RGB565, false>(target, access, texture, spans, mono_color);
+          break;
+        case PixelType::RGB565A4:
+          bilinear ? drawTransformed<PixelType::RGB565A4, true>(target, access, texture, spans, mono_color)
+                   : drawTransformed<PixelType::RGB565A4, false>(target, access, texture, spans, mono_color);
+          break;
+      }
+    }
+
+    //Integer square root, rounded down
+    static uint32_t isqrt(uint32_t value){
+      uint32_t root = 0;
+      uint32_t bit = 1u << 30;
+      while (bit > value)
+        bit >>= 2;
+      while (bit){
+        if (value >= root + bit){
+          value -= root + bit;
+          root = (root >> 1) + bit;
+        }
+        else
+          root >>= 1;
+        bit >>= 2;
+      }
+      return root;
+    }
+
+    void drawRing(Adafruit_GFX* target, const PixelAccess& access, const Rect& outer, unsigned int radius, unsigned int thickness, uint16_t color, bool antialias){
+      const int w = outer.width;
+      const int h = outer.height;
+      if (w <= 0 || h <= 0 || thickness == 0)
+        return;
+      const int t = std::min<int>(thickness, (std::min(w, h) + 1) / 2);
+      const int r = std::min<int>(radius, std::min(w, h) / 2);
+      const int inner_r = r - t;      //Corners of the hole are square when the ring is thicker than the radius
+      //Distances are in 1/16 of a pixel, measured from the pixel centers
+      const int r16 = r * 16;
+      const int inner_r16 = inner_r * 16;
+
+      for (int j = 0; j < h; j++){
+        const int16_t y = outer.y + j;
+        const bool full_row = j < t || j >= h - t;
+
+        int dy16 = -1;
+        if (j < r)
+          dy16 = r16 - (j * 16 + 8);
+        else if (j >= h - r)
+          dy16 = (j * 16 + 8) - (h - r) * 16;
+
+        if (dy16 < 0){ //Straight part of the ring, only spans
+          if (full_row)
+            target->drawFastHLine(outer.x, y, w, color);
+          else{
+            target->drawFastHLine(outer.x, y, t, color);
+            target->drawFastHLine(outer.x + w - t, y, t, color);
+          }
+          continue;
+        }
+
+        if (full_row && w > 2*r)
+          target->drawFastHLine(outer.x + r, y, w - 2*r, color);
+
+        //Skip the columns that are certainly outside of the outer arc, walk inwards until the hole is reached
+        const int outer_x16 = static_cast<int>(isqrt(r16 * r16 - dy16 * dy16));
+        bool inside_ring = false;
+        for (int i = std::max(0, (r16 - outer_x16 - 16) / 16); i < r; i++){
+          const int dx16 = r16 - (i * 16 + 8);
+          const int d16 = static_cast<int>(isqrt(dx16 * dx16 + dy16 * dy16));
+          int coverage = std::min(16, std::max(0, r16 - d16 + 8));
+          if (inner_r > 0)
+            coverage = std::min(coverage, std::max(0, d16 - inner_r16 + 8));
+
+          if (coverage == 0){
+            if (inside_ring)
+              break;
+            continue;
+          }
+          inside_ring = true;
+          const int16_t left = outer.x + i;
+          const int16_t right = outer.x + w - 1 - i;
+          if (coverage == 16 || (!antialias && coverage >= 8)){
+            target->drawPixel(left, y, color);
+            target->drawPixel(right, y, color);
+          }
+          else if (!antialias){
+            continue;
+          }
+          else{
+            blendPixel(target, access, left, y, color, coverage * 2);
+            blendPixel(target, access, right, y, color, coverage * 2);
+          }
+        }
+      }
+    }
+
     bool isPointInElement(Point point, UIElement* element){
         const Point element_pos = element->getPos();
         if ((point.x >= element_pos.x && point.x <= element_pos.x + element->getWidth()) && (point.y >= element_pos.y && point.y <= element_pos.y + element->getHeight())){
@@ -535,49 +2813,45 @@ void AnimatedApp::render(){
     }
 
     UIElement* findElementInCone(UIElement* focused, Scene* currentScene, const Cone& cone){
-      focused->focusable = false;
+      currentScene->syncElements();
+      const ElementTable& table = currentScene->getTable();
 
       const int half_aperture = static_cast<int>(cone.aperture * 0.5);
       const int starting_angle = cone.bisector - half_aperture;
       const int end_angle = cone.bisector + half_aperture;
+      const int radius = static_cast<int>(cone.radius);
       const Point centerPoint = focused->getCenterPoint();
 
 
       Point tempPoint;
       for (int i = starting_angle; i < end_angle; i += cone.aperture_step)
       {
-        for (int b = 0; b < cone.radius; b += cone.rad_step)
+        for (int b = 0; b < radius; b += cone.rad_step)
         {
           tempPoint = polarToCartesian(b, i);
           tempPoint += centerPoint;
-          for(const auto&[id, element] : currentScene->elements){
-            if (element->focusable && isPointInElement(tempPoint, element)){
-              focused->focusable = true;
-              return element;
-            }
-          }
+          UIElement* element = table.focusableAt(tempPoint, focused);
+          if (element)
+            return element;
         }
       }
-      focused->focusable = true;
       return nullptr;
     }
 
     UIElement* findElementInRay(UIElement* focused, Scene* currentScene, const Ray& ray){
-      focused->focusable = false;
+      currentScene->syncElements();
+      const ElementTable& table = currentScene->getTable();
       const Point centerPoint = focused->getCenterPoint();
+      const int length = static_cast<int>(ray.ray_length);
       Point tempPoint;
       
-      for(int i = 0; i<ray.ray_length; i+=ray.step){
+      for(int i = 0; i<length; i+=ray.step){
         tempPoint = polarToCartesian(i, ray.direction);
         tempPoint += centerPoint;
-        for(const auto&[id, element] : currentScene->elements){
-          if (element->focusable && isPointInElement(tempPoint, element)){
-            focused->focusable = true;
-            return element;
-          }
-        }
+        UIElement* element = table.focusableAt(tempPoint, focused);
+        if (element)
+          return element;
       }
-      focused->focusable = true;
       return nullptr;
     }
   };
@@ -2,11 +2,22 @@
 #include "Texture.h"
 #include "UUIDbuddy.h"
 #include "Animation.h"
+#include "Assets.h"
+#include "FrameBuffer.h"
+#include "TextureLoader.h"
+#include "Delegate.h"
+#include "Transport.h"
+#include "Telemetry.h"
+#include "Mirror.h"
 #include <vector>
 #include <unordered_map>
 #include <Adafruit_GFX.h>
 #include <set>
-#include <functional>
+#include <memory>
+#include <array>
+#include <type_traits>
+#include <mutex>
+#include <atomic>
 
 #define PERFORMANCE_PROFILING 0
 #define LOG(x) Serial.println(x)
@@ -28,21 +39,51 @@
 namespace SimpleUI
 {
   class UI;
+  class UIGroup;
+  class UITelemetry;
+  class ScenePreloader;
+  class FrameGovernor;
+  struct RenderKnobs;
+  struct FrameStats;
   class UIElement;
   class AnimatedApp;
   class UIImage;
+  class AnimatedSprite;
+  class ParticleEmitter;
+  class ValueWidget;
+  class ProgressBar;
+  class Slider;
+  class Gauge;
+  class SampleRing;
+  class Chart;
+  class UIList;
+  class ScrollView;
+  class Container;
+  class HStack;
+  class VStack;
+  class Grid;
+  class Group;
+  class ElementTable;
+  struct ListItem;
   struct Point;
+  struct Rect;
   struct Cone;
   struct Ray;
   struct Scene;
+  struct TextureSpec;
+  struct ElementSpec;
+  struct FocusLinks;
   struct Focus;
   struct FocusingSettings;
   struct Outline;
+  struct ParticleEffect;
   enum class Quality;
   enum class Direction;
   enum class FocusingAlgorithm;
   enum class FocusStyle;
   enum class Constraint;
+  enum class Alignment;
+  enum class Justify;
 }
 
 
@@ -52,7 +93,16 @@ namespace SimpleUI{
     UIElement,
     AnimatedApp,
     UIImage,
-    Checkbox
+    Checkbox,
+    List,
+    Container,
+    Sprite,
+    Emitter,
+    ProgressBar,
+    Slider,
+    Gauge,
+    Chart,
+    ScrollView
   };
   enum class Quality{Low, Medium, High};
   enum class Direction{Up=90, Down=270, Left=180, Right=0};
@@ -65,6 +115,10 @@ namespace SimpleUI{
 
     BottomLeft, Bottom,   BottomRight
   };
+  //Where children sit on the cross axis of a container
+  enum class Alignment{Start, Center, End};
+  //How the free space on the main axis of a container is distributed among its children
+  enum class Justify{Start, Center, End, SpaceBetween, SpaceEvenly};
 
   struct Point{
     int x;   //X coordinate of the point 
@@ -75,11 +129,17 @@ namespace SimpleUI{
       @param    x   X coordinate of the point
       @param    y   Y coordinate of the point
     */
-    Point(int posx=0, int posy=0) : x(posx), y(posy){};
+    constexpr Point(int posx=0, int posy=0) : x(posx), y(posy){};
 
     bool operator<(const Point &other) const{
       return std::tie(x, y) < std::tie(other.x, other.y);
     }
+    bool operator==(const Point &other) const{
+      return x == other.x && y == other.y;
+    }
+    bool operator!=(const Point &other) const{
+      return !(*this == other);
+    }
     Point& operator+=(int value) {
       x += value;
       y += value;
@@ -112,6 +172,42 @@ namespace SimpleUI{
     }
   };
 
+  //An axis-aligned rectangle with integer coordinates
+  struct Rect{
+    int x, y;           //Top left corner
+    int width, height;
+
+    constexpr Rect(int posx = 0, int posy = 0, int w = 0, int h = 0) : x(posx), y(posy), width(w), height(h){}
+    constexpr Rect(Point pos, int w, int h) : x(pos.x), y(pos.y), width(w), height(h){}
+
+    inline int right() const { return x + width; }
+    inline int bottom() const { return y + height; }
+    inline bool isEmpty() const { return width <= 0 || height <= 0; }
+    inline bool intersects(const Rect& other) const {
+      return !isEmpty() && !other.isEmpty() && x < other.right() && other.x < right() && y < other.bottom() && other.y < bottom();
+    }
+    inline bool contains(Point point) const {
+      return point.x >= x && point.x < right() && point.y >= y && point.y < bottom();
+    }
+    //!@return The smallest rectangle containing both
+    Rect unite(const Rect& other) const {
+      if (isEmpty()) return other;
+      if (other.isEmpty()) return *this;
+      const int left = std::min(x, other.x), top = std::min(y, other.y);
+      return Rect(left, top, std::max(right(), other.right()) - left, std::max(bottom(), other.bottom()) - top);
+    }
+    //!@return The area shared by both, empty if they don't overlap
+    Rect intersect(const Rect& other) const {
+      const int left = std::max(x, other.x), top = std::max(y, other.y);
+      const int w = std::min(right(), other.right()) - left, h = std::min(bottom(), other.bottom()) - top;
+      return (w > 0 && h > 0) ? Rect(left, top, w, h) : Rect();
+    }
+    //!@return The same rectangle grown by a margin on every side
+    inline Rect expand(int margin) const { return Rect(x - margin, y - margin, width + margin*2, height + margin*2); }
+    bool operator==(const Rect& other) const { return x == other.x && y == other.y && width == other.width && height == other.height; }
+    bool operator!=(const Rect& other) const { return !(*this == other); }
+  };
+
   // Holds the parameters necessary for computing a 2D cone with whatever level of detail desired
   struct Cone{
     unsigned int bisector;        //The angle that indicates the bisector of its aperture (Degrees)
@@ -158,7 +254,7 @@ namespace SimpleUI{
       @param radius     Radius in pixels of the corners
       @param color      RGB565 color of the outline
     */
-    Outline(unsigned int thickness=1, unsigned int distance=0, unsigned int radius = 0, uint16_t color=0xffff) : thickness(thickness), border_distance(distance), color(color), radius(radius){}
+    constexpr Outline(unsigned int thickness=1, unsigned int distance=0, unsigned int radius = 0, uint16_t color=0xffff) : thickness(thickness), border_distance(distance), radius(radius), color(color){}
   };
 
   //Generic UI element, all interactable elements inherit from this
@@ -178,8 +274,11 @@ namespace SimpleUI{
     public:
       friend class UI;
       friend class Scene;
+      friend class Container;
+      friend class ElementTable;
+      template<const auto&> friend class StaticScene;
       UIElement(unsigned int w=0, unsigned int h=0, Point pos={0,0}, bool isCentered = false, ElementType element = ElementType::UIElement, Constraint constraint = Constraint::TopLeft, FocusStyle style = FocusStyle::None)
-      : m_type(element), m_width(w), m_height(h), focus_style(style), m_UUID(UUIDbuddy::generateUUID()), m_s_width(w), m_s_height(h), scale_constraint(constraint)
+      : m_type(element), m_width(w), m_height(h), focus_style(style), m_s_width(w), m_s_height(h), scale_constraint(constraint)
         {
           m_position = isCentered ? centerToCornerPos(pos.x, pos.y, w, h) : pos;
         };
@@ -188,9 +287,14 @@ namespace SimpleUI{
 
       void InitAnim(float initial, float final, unsigned int duration){anim = Animation(initial, final, duration);}
 
-      inline void setPosX(unsigned int X) { m_position.x = X; }
-      inline void setPosY(unsigned int Y) { m_position.y = Y; }
-      inline void setPos(Point pos){m_position=pos;}
+      inline void setPosX(unsigned int X) { m_position.x = X; m_pos_dirty = true; invalidateBounds(); }
+      inline void setPosY(unsigned int Y) { m_position.y = Y; m_pos_dirty = true; invalidateBounds(); }
+      inline void setPos(Point pos){m_position=pos; m_pos_dirty = true; invalidateBounds();}
+      /*!
+        @brief Tell the scenes showing the element that its bounds changed, along with the bounds of every container above it.
+        The setters do it on their own, call it only after changing scale_constraint, focus_style or the focus outline at runtime
+      */
+      void invalidateBounds();
       /*!
         @brief Set the UI listener, this allows the element to access its parent UI's attributes and API
         @param listener A pointer to the UI object that "owns" the element
@@ -198,35 +302,71 @@ namespace SimpleUI{
       inline void setUiListener(UI *listener) { m_parent_ui = listener; }
 
       //!@return The element's UUID
-      inline std::string getId() const { return m_UUID; }
+      inline std::string getId() const { return m_id(); }
       inline ElementType getType() const { return m_type; }
       inline Point getPos() const { return m_position; }
       inline unsigned int getWidth() const { return m_width; }
       inline unsigned int getHeight() const { return m_height; }
       inline UI* getParentUI() const { return m_parent_ui; }
+      //!@return The container the element is a child of, nullptr if it's at the root of its scene
+      inline UIElement* getParent() const { return m_parent; }
       Point getDrawPoint() const;
       Point getCenterPoint() const;
       Point getConstraintedPos() const;
+      //!@return The area the element draws into, focus outlines excluded
+      virtual Rect getBounds() const;
       
-      
+      //Advance the element's state by one frame, called once per frame before any drawing
+      virtual void update(){return;}
+      //Draw the element, it can be called more than once per frame so it shouldn't change the element's state
       virtual void render();
       // Interact with the element
       virtual void click(){return;}
+      /*!
+        @brief Lets the focused element consume a directional input before the scene looks for another element to focus
+        @param direction The direction in counter clockwise degrees (Right is 0)
+        @return True if the element handled the input, false to let the focus move away
+      */
+      virtual bool navigate(unsigned int /*direction*/){return false;}
       
-      inline bool isAnimating() const {return anim.getState() == AnimState::Running;}
+      //!@return True if the element will look different in the next frame even without any input, the UI can't idle while it is
+      virtual bool isAnimating() const {return anim.isEnabled() && (anim.getState() != AnimState::Finished || anim.isLooping());}
+      /*!
+        @brief Tell if the element can bring the last frame up to date by redrawing only what changed, see UI::setPartialRedraw().
+        Such an element reports its changes through isAnimating() and getDamage(), and renderDelta() paints every pixel of the damage
+      */
+      virtual bool canRenderDelta() const {return false;}
+      //!@return The area that changed since the last frame, empty if nothing did. Asked after update()
+      virtual Rect getDamage() const {return getBounds();}
+      //Draw over the last frame only what changed since then, the area returned by getDamage()
+      virtual void renderDelta(){render();}
       inline bool isFocused() const;
       
       static Point centerToCornerPos(unsigned int x_pos, unsigned int y_pos, unsigned int w, unsigned int h);
       void drawFocusOutline(const Outline& outline = Outline()) const;
 
+      protected:
+      const std::string& m_id() const;
+      void m_assignShortId();
+      void m_setScaledSize(unsigned int w, unsigned int h);
+      void m_setSize(unsigned int w, unsigned int h);
+
       protected:
       Point m_position;
       bool m_overrideAnimationScaling = false;
       unsigned int m_width, m_height;
       unsigned int m_s_width, m_s_height; //With scaling applied
-      std::string m_UUID;
+      mutable std::string m_UUID;   //Generated the first time it's needed, elements of a StaticScene get a short one instead
       ElementType m_type;
       UI* m_parent_ui;
+      UIElement* m_parent = nullptr;
+      uint32_t m_version = 0;           //Changes every time the bounds change
+      uint32_t m_subtree_version = 0;   //Changes every time the bounds of the element or of anything below it change
+
+      //The constrainted position only changes with the position, the sizes or the constraint, so it's cached between frames
+      mutable Point m_constrainted_pos;
+      mutable Constraint m_cached_constraint;
+      mutable bool m_pos_dirty = true;
   };
 
   //Used to represent any Image with the tools provided by the library
@@ -238,13 +378,14 @@ namespace SimpleUI{
     inline void setScale(float scale){m_scale_fac = scale;
                                       m_overrideAnimationScaling = (scale < 0) ? false : true;}
     inline void setColor(uint16_t hue) { m_mono_color = hue; }
-    inline void setImg(Texture *img){m_body = img; m_width = img->width; m_height = img->height;}
+    inline void setImg(Texture *img){m_body = img; m_setSize(img->width, img->height);}
 
     /// @param scale If negative, the scale is controlled by the animation.
     inline float getScale() const { return m_scale_fac; }
     inline Texture *getImg() const { return m_body; }
     
 
+    void update() override;
     void render() override;
 
   protected:
@@ -269,18 +410,29 @@ namespace SimpleUI{
         anim.Pause();
       }
       
+      void update() override;
       void render() override;
       inline Texture* getActive() const {return m_showing;}
       inline void setColor(uint16_t hue){m_mono_color = hue;}
       void click() override{
-        m_onClick();
+        if (m_onClick)
+          m_onClick();
       }
-      void bind(const std::function<void()>& func){m_onClick = func;}
+      void bind(const Delegate<void()>& func){m_onClick = func;}
+      /*!
+        @brief Bind the click event and tell which scene it opens, a ScenePreloader prepares it while the app is focused
+        @param func    Called when the app is clicked
+        @param target  The scene the event focuses
+      */
+      void bind(const Delegate<void()>& func, Scene* target){m_onClick = func; m_target = target;}
+      //!@return The scene opened by the click event, nullptr if unknown
+      inline Scene* getTarget() const {return m_target;}
       
       
     protected:
       void m_computeAnimation();
-      std::function<void()> m_onClick = [](){return;};
+      Delegate<void()> m_onClick;
+      Scene* m_target = nullptr;
     protected:
       Interpolation m_func;
       unsigned int m_duration;
@@ -325,8 +477,753 @@ namespace SimpleUI{
     bool m_state;
   };
 
+  /*Plays the cells of an atlas one after the other, like a flip book. The frame is picked from the shared animation Clock,
+  so sprites started together stay in step, and a late frame skips ahead instead of slowing the animation down.
+  Only a view of the current cell is kept, whatever the number of frames.*/
+  class AnimatedSprite : public UIElement{
+    public:
+    /*!
+      @param atlas       The frames, in order. It must outlive the sprite
+      @param frame_time  How long every frame is shown in milliseconds
+      @param pos         Top left corner coordinates, or the center if isCentered is true
+      @param isCentered  Is the sprite centered around the provided coordinates?
+      @param loop        Start again from the first frame after the last one, or stop on the last one
+    */
+    AnimatedSprite(const TextureAtlas* atlas, unsigned int frame_time = 100U, Point pos = {0,0}, bool isCentered = false, bool loop = true);
 
-  
+    void update() override;
+    void render() override;
+    bool isAnimating() const override { return m_playing; }
+
+    //Play from the current frame, from the first one if a sprite that doesn't loop already reached the end
+    void play();
+    inline void pause(){ m_playing = false; }
+    //Show a frame, playback goes on from it
+    void setFrame(size_t index);
+    inline void setFrameTime(unsigned int frame_time){ m_frame_us = (frame_time ? frame_time : 1U) * 1000U; if (m_playing) play(); }
+    inline void setColor(uint16_t hue){ m_mono_color = hue; }
+    inline size_t getFrame() const { return m_frame; }
+    inline bool isPlaying() const { return m_playing; }
+
+    protected:
+    void m_show(size_t index);
+
+    protected:
+    const TextureAtlas* m_atlas;
+    Texture m_view;             //The cell currently shown
+    uint32_t m_frame_us;
+    uint32_t m_started = 0;     //Clock time at which the first frame would have been shown
+    size_t m_frame = 0;
+    bool m_playing = false;
+    bool m_loop;
+    uint16_t m_mono_color = 0xffff;
+  };
+
+
+  //How a burst of particles looks and moves, speeds are in pixels per second and times in milliseconds
+  struct ParticleEffect{
+    uint16_t count;           //Particles per burst, 0 disables the effect
+    uint16_t start_color;     //RGB565 color of a new particle
+    uint16_t end_color;       //RGB565 color it fades to by the end of its life
+    float speed_min, speed_max;
+    uint16_t life_min, life_max;
+    float direction = 90.0f;  //Counter clockwise degrees the particles leave in (Right is 0)
+    float spread = 360.0f;    //Width in degrees of the cone around the direction
+    float gravity = 0.0f;     //Pixels per second squared, positive pulls down
+    float drag = 0.0f;        //Fraction of the speed lost every second
+    uint8_t size = 1;         //Side of the square drawn for each particle
+
+    constexpr ParticleEffect(uint16_t count = 0, uint16_t start_color = 0xFFFF, uint16_t end_color = 0x0000, float speed_min = 20.0f, float speed_max = 60.0f,
+                             uint16_t life_min = 300U, uint16_t life_max = 600U)
+    : count(count), start_color(start_color), end_color(end_color), speed_min(speed_min), speed_max(speed_max), life_min(life_min), life_max(life_max){}
+  };
+
+  /*Draws bursts of particles over an area, for feedback like sparks on a click or a flash on the element gaining focus.
+  The particles live in a pool allocated once, as one array per attribute, and are moved in fixed point by the animation Clock
+  in a single pass, so emitting and rendering them never allocates and the frame rate doesn't change their speed.
+  When the canvas exposes its pixels they're written straight into its lines.
+
+  Bursts are played by burst(), or on their own by setting click_effect and focus_effect: the emitter watches the UI
+  of its scene, put it last so it's drawn over the other elements. With a frame budget, the emitter measures its own time
+  and caps the live particles to stay within its share of the budget.*/
+  class ParticleEmitter : public UIElement{
+    public:
+    ParticleEffect click_effect;  //Played on the focused element when the UI is clicked, none by default
+    ParticleEffect focus_effect;  //Played on an element when it gains focus, none by default
+
+    public:
+    /*!
+      @param capacity  Most particles alive at once
+      @param area      Where the particles are drawn, in screen coordinates. Usually the whole screen
+    */
+    ParticleEmitter(size_t capacity, const Rect& area);
+    ~ParticleEmitter();
+    ParticleEmitter(const ParticleEmitter&) = delete;
+    ParticleEmitter& operator=(const ParticleEmitter&) = delete;
+
+    /*!
+      @brief Emit a burst of particles from a point of the screen
+      @return How many were emitted, the ones that don't fit in the pool or the budget are dropped
+    */
+    size_t burst(const ParticleEffect& effect, Point at);
+    inline void clear(){ m_count = 0; }
+    //Share of the governor's frame budget the particles may take, 0 for no limit
+    inline void setBudgetShare(float share){ m_share = share; }
+    inline size_t getCount() const { return m_count; }
+    inline size_t getCapacity() const { return m_capacity; }
+    //!@return How many particles the budget currently allows
+    inline size_t getLimit() const { return m_limit; }
+
+    void update() override;
+    void render() override;
+    bool isAnimating() const override { return m_count > 0; }
+
+    protected:
+    void m_watch();
+    void m_fitBudget();
+    void m_kill(size_t index);
+    uint32_t m_random();
+
+    protected:
+    size_t m_capacity;
+    size_t m_count = 0;
+    size_t m_limit;
+    uint8_t* m_pool;        //Every array below lives in this block
+    int32_t* m_x;           //16.16 pixels
+    int32_t* m_y;
+    int32_t* m_vx;          //12.20 pixels per millisecond
+    int32_t* m_vy;
+    int16_t* m_gravity;     //8.24 pixels per millisecond squared
+    uint16_t* m_drag;       //16 bit fraction of the speed lost every millisecond
+    uint16_t* m_life;       //Milliseconds left
+    uint16_t* m_fade;       //65535 / the life the particle started with, turns the life left into a fraction without dividing
+    uint16_t* m_start_color;
+    uint16_t* m_end_color;
+    uint8_t* m_size;
+    uint32_t m_seed = 0x9E3779B9;
+    uint32_t m_last_time = 0;
+    uint32_t m_carry_us = 0;        //Time not yet turned into whole milliseconds
+    float m_share = 0.1f;
+    uint32_t m_cost_us = 0;         //Time spent on the particles this frame
+    uint32_t m_average = 0;         //Smoothed time per frame, in sixteenths of a microsecond so short times still register
+    bool m_watching = false;        //The state below was seen on the previous frame
+    uint32_t m_ui_frame = 0;
+    uint32_t m_clicks = 0;
+    const UIElement* m_focused = nullptr;
+  };
+
+  /*Base of the elements that show a value within a range: ProgressBar, Slider and Gauge. A new value isn't shown at once,
+  the element moves to it through its animation, and each frame it only redraws the part between where it was drawn last
+  and where it is now (see UI::setPartialRedraw()), so a frame costs in proportion to how far the value moved.
+  Positions are counted in whole pixels along the track, a change smaller than a pixel doesn't redraw anything.*/
+  class ValueWidget : public UIElement{
+    public:
+    Outline outline;        //Drawn around the track
+    uint16_t fill_color;    //RGB565 color of the track up to the value
+    uint16_t track_color;   //RGB565 color of the rest of the track
+
+    public:
+    /*!
+      @brief Set the value, clamped to the range
+      @param animate  Move to it through the transition, or show it at once
+    */
+    void setValue(float value, bool animate = true);
+    //Change the range, the value is clamped to it and shown at once
+    void setRange(float min, float max);
+    //How the shown value moves to a new one, a duration of 0 shows it at once
+    inline void setTransition(unsigned int duration, Interpolation func = Interpolation::Linear){ m_duration = duration; m_func = func; }
+    inline float getValue() const { return m_value; }
+    //!@return The value drawn, it trails getValue() during a transition
+    inline float getShownValue() const { return m_shown; }
+    inline float getMin() const { return m_min; }
+    inline float getMax() const { return m_max; }
+
+    void update() override;
+    bool isAnimating() const override { return UIElement::isAnimating() || m_locate(m_shown) != m_at; }
+    bool canRenderDelta() const override { return true; }
+
+    protected:
+    ValueWidget(ElementType type, Outline style, Point pos, unsigned int width, unsigned int height, uint16_t fill_color, uint16_t track_color,
+                bool isCentered, FocusStyle focus_style);
+    //!@return Where a value sits along the track, in the element's own steps
+    virtual int m_locate(float value) const = 0;
+    inline float m_fraction(float value) const { return m_max != m_min ? (value - m_min) / (m_max - m_min) : 0.0f; }
+
+    protected:
+    float m_min = 0.0f, m_max = 1.0f;
+    float m_value = 0.0f;
+    float m_shown = 0.0f;
+    unsigned int m_duration = 250U;
+    Interpolation m_func = Interpolation::Sinusoidal;
+    int m_at = 0;       //Position drawn by this frame
+    int m_drawn = 0;    //Position drawn by the last frame
+  };
+
+  /*A bar filled in proportion to its value. The track sits inside the outline, border_distance pixels away from it,
+  and the fill grows from one end of the track towards the direction given.*/
+  class ProgressBar : public ValueWidget{
+    public:
+    /*!
+      @param style        Outline around the track, its radius rounds the track as well
+      @param pos          Top left corner coordinates
+      @param width        Total width in pixels
+      @param height       Total height in pixels
+      @param fill_color   RGB565 color of the filled part
+      @param track_color  RGB565 color of the empty part
+      @param grow         Which way the fill grows
+      @param isCentered   Is the element centered around the provided coordinates?
+    */
+    ProgressBar(Outline style = Outline(), Point pos = {0, 0}, unsigned int width = 0, unsigned int height = 0, uint16_t fill_color = 0xFFFF,
+                uint16_t track_color = 0x0000, Direction grow = Direction::Right, bool isCentered = false)
+    : ProgressBar(ElementType::ProgressBar, style, pos, width, height, fill_color, track_color, grow, isCentered, FocusStyle::None){ focusable = false; }
+
+    void render() override;
+    Rect getDamage() const override;
+    void renderDelta() override;
+
+    protected:
+    ProgressBar(ElementType type, Outline style, Point pos, unsigned int width, unsigned int height, uint16_t fill_color, uint16_t track_color,
+                Direction grow, bool isCentered, FocusStyle focus_style);
+    int m_locate(float value) const override;
+    virtual uint16_t m_knobColor() const { return fill_color; }
+    Rect m_track() const;
+    //!@return How many steps the track has, one per pixel along the direction of the fill
+    int m_length() const;
+    //!@return The area covered by the steps [from, to) of the track
+    Rect m_span(int from, int to) const;
+    //Paint the steps [from, to) of the track with the colors they have this frame
+    void m_paint(int from, int to) const;
+
+    protected:
+    Direction m_grow;
+    int m_knob = 0;     //Steps taken by the knob, drawn right after the fill
+  };
+
+  /*A progress bar with a knob at the end of the fill that the focus can move: Right and Left (Up and Down if the slider is vertical)
+  change the value by a step instead of moving the focus away, until the value reaches the end of the range.
+  The knob is drawn inside the track.*/
+  class Slider : public ProgressBar{
+    public:
+    uint16_t knob_color;  //RGB565 color of the knob
+
+    public:
+    /*!
+      @param style        Outline around the track, its radius rounds the track as well
+      @param pos          Top left corner coordinates
+      @param width        Total width in pixels
+      @param height       Total height in pixels
+      @param fill_color   RGB565 color of the filled part
+      @param track_color  RGB565 color of the empty part
+      @param knob_color   RGB565 color of the knob
+      @param knob_size    Length of the knob along the track in pixels
+      @param grow         Which way the value grows
+      @param isCentered   Is the element centered around the provided coordinates?
+      @param focus_style  What method is used to signal a focus
+    */
+    Slider(Outline style = Outline(), Point pos = {0, 0}, unsigned int width = 0, unsigned int height = 0, uint16_t fill_color = 0xFFFF,
+           uint16_t track_color = 0x0000, uint16_t knob_color = 0xFFFF, unsigned int knob_size = 4U, Direction grow = Direction::Right,
+           bool isCentered = false, FocusStyle focus_style = FocusStyle::Outline)
+    : ProgressBar(ElementType::Slider, style, pos, width, height, fill_color, track_color, grow, isCentered, focus_style), knob_color(knob_color)
+    { m_knob = static_cast<int>(knob_size); }
+
+    bool navigate(unsigned int direction) override;
+    //How much an input moves the value, 0 for a twentieth of the range
+    inline void setStep(float step){ m_step = step; }
+    inline float getStep() const { return m_step; }
+    //Called with the new value every time an input changes it
+    inline void bind(const Delegate<void(float)>& func){ m_onChange = func; }
+
+    protected:
+    uint16_t m_knobColor() const override { return knob_color; }
+
+    protected:
+    float m_step = 0.0f;
+    Delegate<void(float)> m_onChange;
+  };
+
+  /*A value shown along an arc, like a dial. The arc is a band of the circle that fits the element, the outline runs along both
+  of its edges and the fill sweeps clockwise from the start angle. The pixels of the arc are drawn without blending,
+  so the part between two values can be painted over the last frame with the same result as drawing it whole.*/
+  class Gauge : public ValueWidget{
+    public:
+    /*!
+      @param style        Outline along the edges of the arc, its border_distance separates it from the fill
+      @param pos          Top left corner coordinates
+      @param size         Width and height in pixels
+      @param band         Width of the arc in pixels, outline included
+      @param fill_color   RGB565 color of the filled part
+      @param track_color  RGB565 color of the empty part
+      @param start        Counter clockwise degrees where the arc starts (Right is 0)
+      @param sweep        Clockwise degrees the arc spans, up to 360
+      @param isCentered   Is the element centered around the provided coordinates?
+    */
+    Gauge(Outline style = Outline(), Point pos = {0, 0}, unsigned int size = 0, unsigned int band = 8U, uint16_t fill_color = 0xFFFF,
+          uint16_t track_color = 0x0000, float start = 225.0f, float sweep = 270.0f, bool isCentered = false);
+
+    void render() override;
+    Rect getDamage() const override;
+    void renderDelta() override;
+
+    protected:
+    //Where a pixel sits on the arc, shared by render() and renderDelta() so both paint the same pixels
+    struct Geometry{
+      float cx, cy;                     //Center of the circle
+      float outer, inner;               //Squared radii of the arc band
+      float line_outer, line_inner;     //Squared radii where the outline along each edge stops
+      float fill_outer, fill_inner;     //Squared radii of the fill, inside the outline
+      float start;                      //Pseudo angle of the start of the arc
+      float end;                        //Clockwise pseudo angle from the start to the end of the arc
+    };
+    int m_locate(float value) const override;
+    //!@return How many positions the fill can take, one per pixel along the outer edge of the fill
+    int m_steps() const;
+    Geometry m_geometry() const;
+    //!@return The clockwise pseudo angle from the start of the arc to a position
+    float m_offsetOf(const Geometry& geometry, int position) const;
+    //!@return The screen area the fill covers between two positions
+    Rect m_sector(int from, int to) const;
+    //Paint the pixels of an area that belong to the arc, only those of the fill between two positions if `from` isn't negative
+    void m_paint(const Rect& area, int from, int to) const;
+    /*!
+      @return A value that grows with the counter clockwise angle of a vector like the angle does, from 0 to 4.
+      Cheaper than atan2f and enough to tell which side of the fill a pixel is on
+    */
+    static float m_pseudoAngle(float dx, float dy);
+
+    protected:
+    unsigned int m_band;
+    float m_start, m_sweep;
+  };
+
+  /*The samples a Chart plots, queued by the task that measures them until the chart reads them in Chart::update(). A sample
+  is a single float and the capacity a power of two, so a slot is found by masking the count of samples pushed or read.
+  When the chart falls behind the newest samples are the ones lost, getDropped() tells how many: the plot keeps going on
+  from what was queued instead of jumping ahead. Meant for one measuring task and the render task, not several producers.*/
+  class SampleRing{
+    public:
+    /*!
+      @param capacity  Most samples waiting at once, rounded up to a power of two
+    */
+    SampleRing(size_t capacity = 256U);
+    ~SampleRing();
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    //!@return False if the sample was dropped for lack of room
+    bool push(float value);
+    /*!
+      @brief Take the oldest samples out of the ring
+      @return How many were copied
+    */
+    size_t read(float* out, size_t max);
+    //!@return How many samples wait to be read
+    inline size_t getPending() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+    inline size_t getCapacity() const { return m_mask + 1; }
+    inline uint32_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+    float* m_samples;
+    size_t m_mask;
+    std::atomic<size_t> m_head{0};  //Samples ever pushed, only the producer moves it
+    std::atomic<size_t> m_tail{0};  //Samples ever read, only the reader moves it
+    std::atomic<uint32_t> m_dropped{0};
+  };
+
+  /*Plots a stream of samples as it arrives, the newest on the right. Every column of pixels shows the lowest and highest of
+  the samples it covers (several when they arrive faster than one column per frame is worth), joined to the column before it,
+  and only those envelopes are kept: drawing the chart costs the same whatever the number of samples it went through.
+  With partial redraw (see UI::setPartialRedraw()) the plot already on screen is shifted left in place and only the new columns
+  are drawn, when the canvas exposes RGB565 pixels and the chart fits in it. Otherwise the columns are drawn again, one span each.*/
+  class Chart : public UIElement{
+    public:
+    uint16_t line_color;    //RGB565 color of the plot
+    uint16_t background;    //RGB565 color the chart area is filled with
+
+    public:
+    /*!
+      @param source       Where the samples come from, read every frame
+      @param pos          Top left corner coordinates
+      @param width        Width in pixels, one column each
+      @param height       Height in pixels
+      @param min          Value plotted at the bottom
+      @param max          Value plotted at the top
+      @param decimation   How many samples every column covers
+      @param line_color   RGB565 color of the plot
+      @param background   RGB565 color of the chart area
+      @param isCentered   Is the element centered around the provided coordinates?
+    */
+    Chart(SampleRing* source, Point pos = {0, 0}, unsigned int width = 0, unsigned int height = 0, float min = 0.0f, float max = 1.0f,
+          unsigned int decimation = 1U, uint16_t line_color = 0xFFFF, uint16_t background = 0x0000, bool isCentered = false);
+
+    //Change the values plotted at the bottom and top, the whole chart is drawn again
+    void setRange(float min, float max);
+    //Change how many samples every new column covers
+    inline void setDecimation(unsigned int decimation){ m_decimation = decimation ? decimation : 1U; }
+    //Forget every sample plotted
+    void clear();
+    inline unsigned int getDecimation() const { return m_decimation; }
+    //!@return How many samples were plotted since the chart was created
+    inline uint32_t getSampleCount() const { return m_samples; }
+
+    void update() override;
+    void render() override;
+    bool isAnimating() const override { return m_redraw || (m_source && m_source->getPending()); }
+    bool canRenderDelta() const override { return true; }
+    Rect getDamage() const override { return (m_full || m_shift) ? getBounds() : Rect(); }
+    void renderDelta() override;
+
+    protected:
+    //The envelope of the samples a column covers
+    struct Column{
+      float low, high;  //Grown to reach the last sample of the column before, so the plot has no gaps
+      float last;       //The last sample, where the next column joins
+    };
+    void m_push(float value);
+    //!@return The screen line a value is plotted at
+    int m_lineOf(float value) const;
+    //Draw the column `age` columns older than the newest one at screen column x, between two lines
+    void m_drawColumn(const PixelAccess& access, size_t age, int x, int top, int bottom) const;
+
+    protected:
+    SampleRing* m_source;
+    std::vector<Column> m_columns;  //One per pixel of width, used as a ring
+    size_t m_newest = 0;            //Slot of the newest column
+    size_t m_filled = 0;            //Columns holding samples
+    Column m_open;                  //The column being gathered
+    unsigned int m_open_count = 0;
+    unsigned int m_decimation;
+    float m_min, m_max;
+    uint32_t m_samples = 0;
+    size_t m_shift = 0;             //Columns added since the last frame
+    bool m_full = true;             //This frame draws the whole chart again
+    bool m_redraw = true;           //The next frame has to
+  };
+
+  // The content of a single list row, filled in by the list's data source
+  struct ListItem{
+    std::string text;
+    Texture* icon = nullptr;    //Optional icon drawn on the left of the text
+    uint16_t color = 0xffff;    //RGB565 color of the text and of mono icons
+  };
+
+  /*A scrolling list that can hold any number of items while only keeping the rows in view in memory.
+  Rows are recycled as the list scrolls, and their content is requested from the data source only when a new item comes into view.*/
+  class UIList : public UIElement{
+    public:
+    uint16_t background = 0x0000;       //RGB565 color behind the rows
+    uint16_t highlight = 0xffff;        //RGB565 color of the selected row when the list is focused
+    uint16_t highlight_text = 0x0000;   //RGB565 color of the selected row's text
+    unsigned int scroll_duration = 120; //How long a scroll takes in milliseconds
+
+    public:
+    /*!
+      @brief Create a virtualized list element.
+      @param count       How many items the list holds
+      @param source      Called with an item index and the row to fill whenever a row needs new content
+      @param pos         Top left corner coordinates
+      @param width       Total width in pixels
+      @param height      Total height in pixels
+      @param row_height  Height of every row in pixels
+    */
+    UIList(unsigned int count = 0, const Delegate<void(unsigned int, ListItem&)>& source = nullptr, Point pos = {0,0}, 
+           unsigned int width = 0, unsigned int height = 0, unsigned int row_height = 12);
+
+    void update() override;
+    void render() override;
+    bool navigate(unsigned int direction) override;
+    void click() override{ if (m_onClick) m_onClick(m_selected); }
+    void bind(const Delegate<void(unsigned int)>& func){m_onClick = func;}
+
+    void select(unsigned int index);
+    void setCount(unsigned int count);
+    //Drops the content of every row, forcing the data source to be asked again
+    void invalidate();
+
+    inline unsigned int getSelected() const { return m_selected; }
+    inline unsigned int getCount() const { return m_count; }
+    inline unsigned int getRowHeight() const { return m_row_height; }
+    inline int getScroll() const { return m_scroll; }
+
+    protected:
+    struct Row{
+      int index = -1;   //The item currently bound to the row, -1 if none
+      ListItem item;
+    };
+    Row& m_fetchRow(unsigned int index);
+    void m_drawRow(Adafruit_GFX* target, const PixelAccess& access, const Row& row, int x, int y, bool selected) const;
+
+    protected:
+    Delegate<void(unsigned int, ListItem&)> m_source;
+    Delegate<void(unsigned int)> m_onClick;
+    std::vector<Row> m_rows;                     //Pool of recycled rows, just enough to cover the viewport
+    std::unique_ptr<GFXcanvas16> m_row_canvas;   //Scratch row used to clip the rows that are only partially visible
+    unsigned int m_count;
+    unsigned int m_row_height;
+    unsigned int m_selected = 0;
+    int m_scroll = 0;                            //Current scroll offset in pixels
+    int m_target_scroll = 0;                     //Scroll offset the list is animating towards
+  };
+
+  /*A viewport over content taller than itself, moved up and down by scrolling. The content is drawn by a delegate through a band canvas
+  a few lines tall, so whatever falls outside of the view is clipped, and the delegate is told which part of the content the band shows.
+  With partial redraw (see UI::setPartialRedraw()) a scroll moves the lines already in the buffer and draws only the ones it brought in,
+  when the canvas exposes RGB565 pixels and the view fits in it. A view as wide as the screen also reports every scroll to the display
+  (see UI::bindScroller()), so a panel that scrolls in hardware only needs the new lines.*/
+  class ScrollView : public UIElement{
+    public:
+    uint16_t background;                //RGB565 color behind the content
+    unsigned int step;                  //How far Up and Down scroll the view when it's focused
+    unsigned int scroll_duration = 120; //How long a scroll takes in milliseconds
+
+    public:
+    /*!
+      @param content         Draws the content with its top left corner at the given point of the target. The rectangle is the part
+                             of the content needed, in the content's own coordinates: anything drawn elsewhere is clipped
+      @param content_height  Height of the content in pixels
+      @param pos             Top left corner coordinates
+      @param width           Width of the view in pixels
+      @param height          Height of the view in pixels
+      @param step            How far Up and Down scroll the view
+      @param band_lines      Lines of the band canvas the content is drawn through
+      @param background      RGB565 color behind the content
+    */
+    ScrollView(const Delegate<void(Adafruit_GFX*, const PixelAccess&, Point, const Rect&)>& content = nullptr, unsigned int content_height = 0,
+               Point pos = {0, 0}, unsigned int width = 0, unsigned int height = 0, unsigned int step = 16, unsigned int band_lines = 8,
+               uint16_t background = 0x0000);
+
+    /*!
+      @brief Scroll until a line of the content is at the top of the view, clamped so the view stays within the content
+      @param animate  Move there in scroll_duration, or jump
+    */
+    void scrollTo(int offset, bool animate = true);
+    inline void scrollBy(int lines, bool animate = true){ scrollTo(m_target + lines, animate); }
+    //Change the height of the content, the view is drawn again
+    void setContentHeight(unsigned int height);
+    //Draw the content again, after it changed
+    inline void refresh(){ m_redraw = true; }
+    //!@return The line of the content at the top of the view
+    inline int getOffset() const { return m_offset; }
+    inline int getMaxOffset() const { return std::max(0, static_cast<int>(m_content_height) - static_cast<int>(m_height)); }
+    inline unsigned int getContentHeight() const { return m_content_height; }
+
+    void update() override;
+    void render() override;
+    bool navigate(unsigned int direction) override;
+    bool isAnimating() const override { return UIElement::isAnimating() || m_redraw || (!anim.isEnabled() && m_offset != m_target); }
+    bool canRenderDelta() const override { return true; }
+    Rect getDamage() const override { return (m_full || m_shift) ? getBounds() : Rect(); }
+    void renderDelta() override;
+
+    protected:
+    //Draw the lines [first, first + count) of the view, counted from its top
+    void m_drawLines(int first, int count);
+
+    protected:
+    Delegate<void(Adafruit_GFX*, const PixelAccess&, Point, const Rect&)> m_content;
+    std::unique_ptr<GFXcanvas16> m_band;  //Created the first time the view is drawn
+    unsigned int m_content_height;
+    unsigned int m_band_lines;
+    int m_offset = 0;         //Line of the content at the top of the view this frame
+    int m_target = 0;         //Where the view is scrolling to
+    int m_shift = 0;          //How far the content moved up since the last frame
+    Rect m_drawn;             //Bounds of the view the last frame
+    uint32_t m_frame = 0;     //Frame the view was last updated in
+    bool m_full = true;       //This frame draws the whole view again
+    bool m_redraw = true;     //The next frame has to
+  };
+
+  /*Base of every layout element. A container doesn't draw anything, it positions its children in two passes: measure computes the size
+  of the content, arrange places every child. The result is cached and recomputed only when a child's size or visibility changes,
+  or when the container itself is moved. Layout uses the unscaled size of the children, so scaling animations never trigger it.*/
+  class Container : public UIElement{
+    public:
+    /*!
+      @param children    The elements to position, in order
+      @param pos         Top left corner coordinates, or the center if isCentered is true
+      @param isCentered  Is the container centered around the provided coordinates?
+      @param width       Total width in pixels, 0 to fit the content
+      @param height      Total height in pixels, 0 to fit the content
+    */
+    Container(std::initializer_list<UIElement*> children, Point pos = {0,0}, bool isCentered = false, unsigned int width = 0, unsigned int height = 0);
+
+    void render() override {return;}
+    /*!
+      @brief Run the layout passes if anything changed since the last time, nested containers are updated first
+      @return True if the children were moved
+    */
+    bool updateLayout();
+    //Force the next updateLayout() to run the layout passes
+    inline void invalidate(){ m_dirty = true; }
+    inline void setSpacing(unsigned int spacing){ m_spacing = spacing; invalidate(); }
+    inline void setPadding(unsigned int padding){ m_padding = padding; invalidate(); }
+    inline const std::vector<UIElement*>& getChildren() const { return m_children; }
+
+    protected:
+    //Compute the width and height needed by the content, padding excluded
+    virtual Point m_measure() const = 0;
+    //Move every child to its place inside the content area
+    virtual void m_arrange() = 0;
+    void m_place(UIElement* child, Point corner);
+
+    protected:
+    struct ChildState{
+      unsigned int width, height;
+      bool draw;
+    };
+    std::vector<UIElement*> m_children;
+    std::vector<ChildState> m_child_states; //The state of each child the last time the layout ran
+    Point m_anchor;                         //The requested position, the center if m_centered is true
+    Point m_arranged_pos;                   //Where the container was when it last arranged its children
+    unsigned int m_spacing = 0;
+    unsigned int m_padding = 0;
+    bool m_centered;
+    bool m_fit_width, m_fit_height;
+    bool m_dirty = true;
+  };
+
+  //Arranges its children in a row or a column
+  class Stack : public Container{
+    public:
+    enum class Axis{Horizontal, Vertical};
+    /*!
+      @param axis        The direction children are laid out in
+      @param children    The elements to position, in order
+      @param pos         Top left corner coordinates, or the center if isCentered is true
+      @param isCentered  Is the container centered around the provided coordinates?
+      @param spacing     Minimum distance in pixels between two children
+      @param justify     How the free space on the main axis is distributed
+      @param align       Where children sit on the cross axis
+      @param width       Total width in pixels, 0 to fit the content
+      @param height      Total height in pixels, 0 to fit the content
+    */
+    Stack(Axis axis, std::initializer_list<UIElement*> children, Point pos = {0,0}, bool isCentered = false, unsigned int spacing = 0,
+          Justify justify = Justify::Start, Alignment align = Alignment::Center, unsigned int width = 0, unsigned int height = 0);
+
+    inline void setJustify(Justify justify){ m_justify = justify; invalidate(); }
+    inline void setAlignment(Alignment align){ m_align = align; invalidate(); }
+
+    protected:
+    Point m_measure() const override;
+    void m_arrange() override;
+
+    protected:
+    Axis m_axis;
+    Justify m_justify;
+    Alignment m_align;
+  };
+
+  //Lays its children out from left to right
+  class HStack : public Stack{
+    public:
+    HStack(std::initializer_list<UIElement*> children, Point pos = {0,0}, bool isCentered = false, unsigned int spacing = 0,
+           Justify justify = Justify::Start, Alignment align = Alignment::Center, unsigned int width = 0, unsigned int height = 0)
+    : Stack(Axis::Horizontal, children, pos, isCentered, spacing, justify, align, width, height){}
+  };
+
+  //Lays its children out from top to bottom
+  class VStack : public Stack{
+    public:
+    VStack(std::initializer_list<UIElement*> children, Point pos = {0,0}, bool isCentered = false, unsigned int spacing = 0,
+           Justify justify = Justify::Start, Alignment align = Alignment::Center, unsigned int width = 0, unsigned int height = 0)
+    : Stack(Axis::Vertical, children, pos, isCentered, spacing, justify, align, width, height){}
+  };
+
+  //Lays its children out in rows of equally sized cells, every cell is as big as the largest child and children are centered in it
+  class Grid : public Container{
+    public:
+    /*!
+      @param columns     How many cells fit in a row
+      @param children    The elements to position, in order from left to right and top to bottom
+      @param pos         Top left corner coordinates, or the center if isCentered is true
+      @param isCentered  Is the container centered around the provided coordinates?
+      @param spacing     Distance in pixels between two cells
+    */
+    Grid(unsigned int columns, std::initializer_list<UIElement*> children, Point pos = {0,0}, bool isCentered = false, unsigned int spacing = 0);
+
+    protected:
+    Point m_measure() const override;
+    void m_arrange() override;
+    Point m_cellSize() const;
+
+    protected:
+    unsigned int m_columns;
+  };
+
+  /*Keeps its children at fixed offsets from its own top left corner, so a whole subtree moves with a single setPos(),
+  like a panel sliding in. The offsets are the positions the children have when the group is built, unless changed with setOffset().
+  The group fits the area its visible children cover.*/
+  class Group : public Container{
+    public:
+    /*!
+      @param children    The elements to move together, their current positions become their offsets
+      @param pos         Top left corner coordinates, or the center if isCentered is true
+      @param isCentered  Is the group centered around the provided coordinates?
+    */
+    Group(std::initializer_list<UIElement*> children, Point pos = {0,0}, bool isCentered = false);
+
+    //Move a child relative to the group, nothing happens if it isn't one of its children
+    void setOffset(const UIElement* child, Point offset);
+    //!@return The offset of a child from the group's corner, {0,0} if it isn't one of its children
+    Point getOffset(const UIElement* child) const;
+
+    protected:
+    Point m_measure() const override;
+    void m_arrange() override;
+
+    protected:
+    std::vector<Point> m_offsets;
+  };
+
+  /*The geometry of a scene's elements packed in parallel arrays: what render culling and focus search read on every pass.
+  The elements stay the authoritative copy and keep the cold data, like the UUID, the textures or the outline settings.
+  Rows are in the order the elements were added, containers before their children, which is also the order they're drawn in,
+  and every row knows where its subtree ends and the bounds of the whole subtree. Syncing only visits the path to what changed,
+  and culling or focus search skip a subtree whose bounds miss what they look for.
+  The draw and focusable flags are read from the element itself, only where the geometry already matched.*/
+  class ElementTable{
+    public:
+    //!@return The row of the element, its children have to be added next
+    size_t add(UIElement* element);
+    //Close the subtree of a row, once all of its descendants have been added
+    void endSubtree(size_t row);
+    void reserve(size_t count);
+    /*!
+      @brief Copy the bounds of the elements that changed since the last sync
+      @param outline  The outline of the scene, used by the elements that don't have a custom one
+    */
+    void sync(const Outline& outline);
+
+    inline size_t size() const { return m_elements.size(); }
+    inline UIElement* operator[](size_t row) const { return m_elements[row]; }
+    //!@return The area an element can touch when it's drawn, including its focus outline
+    inline const Rect& getPaintBounds(size_t row) const { return m_paint[row]; }
+    //!@return The area the element and all of its descendants can touch when they're drawn
+    inline const Rect& getSubtreeBounds(size_t row) const { return m_tree_paint[row]; }
+    //!@return The row after the last descendant of an element
+    inline size_t getSubtreeEnd(size_t row) const { return m_end[row]; }
+    /*!
+      @brief Find the element a focus search lands on
+      @param point    The point to test, an element covers its unscaled area with the right and bottom edges included
+      @param exclude  An element to skip, usually the focused one
+      @return The first focusable element containing the point, nullptr if there's none
+    */
+    UIElement* focusableAt(Point point, const UIElement* exclude = nullptr) const;
+
+    private:
+    size_t m_syncSubtree(size_t row, bool force);
+
+    private:
+    std::vector<UIElement*> m_elements;
+    std::vector<uint32_t> m_end;          //The row after the last descendant
+    std::vector<uint32_t> m_seen;         //The version of the element when its row was last synced
+    std::vector<uint32_t> m_seen_tree;    //The subtree version of the element when its subtree was last synced
+    std::vector<Rect> m_hit;              //Unscaled position and size, what focus search tests against
+    std::vector<Rect> m_paint;            //Drawn bounds grown by the focus outline
+    std::vector<Rect> m_tree_hit;         //Union of the hit areas of the subtree
+    std::vector<Rect> m_tree_paint;       //Union of the paint bounds of the subtree
+    Outline m_outline;                    //The scene outline of the last sync, a different one resyncs everything
+    bool m_synced = false;
+  };
 
   //This is one of the most fundamental blocks of the library, it groups together elements and allows for extreme versatility
   class Scene{
@@ -355,15 +1252,269 @@ namespace SimpleUI{
 
     public:
     Scene(std::initializer_list<UIElement*> elementGroup = {}, UIElement* first_focus = nullptr);
-    Scene(const std::function<void()>& script, bool on_top = false) : m_script(script), primaryElementID(""){ settings.scriptOnTop=on_top; }
+    Scene(const Delegate<void()>& script, bool on_top = false) : m_script(script), primaryElementID(""){ settings.scriptOnTop=on_top; }
+    //Update the layouts and every visible element, once per frame
+    void updateScene();
+    //Lay out the containers, only the ones that changed are measured again
+    void prepareLayout();
     void renderScene() const;
-    UIElement* getElementByUUID(std::string UUID) const;
+    //Render only the elements that touch an area of the screen
+    void renderScene(const Rect& clip) const;
+    UIElement* getElementByUUID(const std::string& UUID) const;
     void addParents(std::initializer_list<Scene*> scenes);
-    inline void Script(const std::function<void()>& script, bool on_top = false)  { m_script = script; settings.scriptOnTop = on_top;}
-    inline void UnbindScript(){ m_script = [](){return;};}
+    //Bring the table up to date with the elements that changed, done by updateScene() and before every focus search
+    void syncElements() const;
+    //!@return The packed geometry of the elements, in the order they were added
+    inline const ElementTable& getTable() const { return m_table; }
+    /*!
+      @brief Draw something of your own with the scene, under or on top of its elements
+      In strip mode the script runs once for every band of the frame, so it has to only draw: whatever it advances or moves
+      goes in the update script instead
+      @param update  Runs once per frame before the elements are updated, nullptr if the script has nothing to advance
+    */
+    inline void Script(const Delegate<void()>& script, bool on_top = false, const Delegate<void()>& update = nullptr)
+    { m_script = script; m_update_script = update; settings.scriptOnTop = on_top; m_dirty = true;}
+    //Ask for another frame, a script that animates has to call it every time it runs or the UI may stop rendering the scene
+    inline void invalidate(){ m_dirty = true; }
+    inline bool isDirty() const { return m_dirty; }
+    inline void UnbindScript(){ m_script = nullptr; m_update_script = nullptr; m_dirty = true;}
+
+    protected:
+    void m_addElement(UIElement* element, bool isRoot);
+    void m_render(const Rect* clip) const;
+    UIElement* m_graphNeighbour(UIElement* from, unsigned int direction) const;
+
+    protected:
+    Delegate<void()> m_script;
+    Delegate<void()> m_update_script;
+    bool m_dirty = false;
+    mutable ElementTable m_table;
+    std::vector<Container*> m_layouts; //Outermost containers, updated before every render
+    const FocusLinks* m_focus_graph = nullptr;      //Focus graph resolved at compile time, only for a StaticScene
+    UIElement* const* m_graph_elements = nullptr;   //The elements the graph's indices refer to
+    size_t m_graph_size = 0;
+  };
+
+  //Compile-time description of a texture, the pixels stay in flash
+  struct TextureSpec{
+    unsigned int width = 0, height = 0;
+    const uint8_t* mono = nullptr;
+    const uint16_t* rgb565 = nullptr;
+
+    constexpr TextureSpec(){}
+    constexpr TextureSpec(unsigned int w, unsigned int h, const uint8_t* data) : width(w), height(h), mono(data){}
+    constexpr TextureSpec(unsigned int w, unsigned int h, const uint16_t* data) : width(w), height(h), rgb565(data){}
+    Texture toTexture() const { return rgb565 ? Texture(width, height, rgb565) : Texture(width, height, mono); }
+  };
+
+  //Compile-time description of an element of a StaticScene, built with App(), Image() or Check()
+  struct ElementSpec{
+    ElementType type = ElementType::UIElement;
+    Point pos;
+    bool centered = false;
+    unsigned int width = 0, height = 0;
+    TextureSpec textures[2];      //Unfocused and focused texture of an AnimatedApp, the image of a UIImage
+    Outline outline;              //Outline of a Checkbox
+    FocusStyle focus_style = FocusStyle::None;
+    Constraint constraint = Constraint::TopLeft;
+    unsigned int duration = 1000U;
+    Interpolation func = Interpolation::Linear;
+    uint16_t color = 0xffff;      //Fill of a Checkbox
+
+    //Describe an AnimatedApp, see its constructor
+    static constexpr ElementSpec App(TextureSpec unfocused, TextureSpec focused, Point pos, bool isCentered = false, unsigned int duration = 1000U,
+                                     Interpolation func = Interpolation::Linear, Constraint constraint = Constraint::TopLeft){
+      ElementSpec spec;
+      spec.type = ElementType::AnimatedApp;
+      spec.pos = pos; spec.centered = isCentered;
+      spec.width = unfocused.width; spec.height = unfocused.height;
+      spec.textures[0] = unfocused; spec.textures[1] = focused;
+      spec.focus_style = FocusStyle::Animation;
+      spec.duration = duration; spec.func = func; spec.constraint = constraint;
+      return spec;
+    }
+    //Describe a UIImage, see its constructor
+    static constexpr ElementSpec Image(TextureSpec img, Point pos, bool isCentered = false, FocusStyle focus_style = FocusStyle::None){
+      ElementSpec spec;
+      spec.type = ElementType::UIImage;
+      spec.pos = pos; spec.centered = isCentered;
+      spec.width = img.width; spec.height = img.height;
+      spec.textures[0] = img;
+      spec.focus_style = focus_style;
+      return spec;
+    }
+    //Describe a Checkbox, see its constructor
+    static constexpr ElementSpec Check(Outline style, Point pos, unsigned int width, unsigned int height, uint16_t fillColor = 0xFFFF,
+                                       bool isCentered = false, FocusStyle focus_style = FocusStyle::Outline){
+      ElementSpec spec;
+      spec.type = ElementType::Checkbox;
+      spec.pos = pos; spec.centered = isCentered;
+      spec.width = width; spec.height = height;
+      spec.outline = style; spec.color = fillColor;
+      spec.focus_style = focus_style;
+      return spec;
+    }
+
+    //!@return The center of the element
+    constexpr Point center() const {
+      return centered ? pos : Point(pos.x + static_cast<int>(width / 2), pos.y + static_cast<int>(height / 2));
+    }
+  };
+
+  //For every direction, the index of the element that receives the focus, -1 if there's none
+  struct FocusLinks{
+    int8_t next[4] = {-1, -1, -1, -1}; //Right, Up, Left, Down, in the same order as Direction
+  };
+
+  /*!
+    @brief Resolve at compile time which element gets the focus in every direction, using the same 90 degrees cone as the runtime search
+    @param specs         The elements of the scene
+    @param max_distance  How far the focus can jump in pixels
+  */
+  template<size_t N>
+  constexpr std::array<FocusLinks, N> resolveFocusGraph(const std::array<ElementSpec, N>& specs, int max_distance = 64){
+    std::array<FocusLinks, N> graph{};
+    for (size_t i = 0; i < N; i++){
+      const Point from = specs[i].center();
+      for (int dir = 0; dir < 4; dir++){
+        int best = -1, best_score = 0;
+        for (size_t j = 0; j < N; j++){
+          if (j == i)
+            continue;
+          const Point to = specs[j].center();
+          const int dx = to.x - from.x;
+          const int dy = from.y - to.y; //Screen coordinates grow downwards, directions grow counter clockwise
+          const int main = dir == 0 ? dx : dir == 1 ? dy : dir == 2 ? -dx : -dy;
+          const int cross = (dir % 2 == 0) ? (dy < 0 ? -dy : dy) : (dx < 0 ? -dx : dx);
+          if (main <= 0 || cross > main || main > max_distance)
+            continue;
+          const int score = main + cross*2;
+          if (best < 0 || score < best_score){
+            best = static_cast<int>(j);
+            best_score = score;
+          }
+        }
+        graph[i].next[dir] = static_cast<int8_t>(best);
+      }
+    }
+    return graph;
+  }
+
+  UIElement* buildStaticElement(const ElementSpec& spec, void* storage, Texture* textures);
+
+  /*A scene described at compile time by a constexpr std::array of ElementSpec. The elements live inside the scene object itself,
+  so a global StaticScene is laid out in static RAM, its description and focus graph in flash, and building it doesn't allocate
+  UUIDs or elements on the heap. Only AnimatedApp, UIImage and Checkbox can be described this way.
+
+    constexpr std::array<ElementSpec, 2> menuSpec{{ ElementSpec::Check(Outline(2), {0, 5}, 16, 16), ElementSpec::Check(Outline(2), {20, 5}, 16, 16) }};
+    StaticScene<menuSpec> menu;
+  */
+  template<const auto& Specs>
+  class StaticScene : public Scene{
+    public:
+    static constexpr size_t count = Specs.size();
+    static_assert(count > 0 && count <= 127, "A StaticScene holds between 1 and 127 elements");
+    static constexpr std::array<FocusLinks, count> graph = resolveFocusGraph(Specs);
+
+    /*!
+      @param first_focus  Index of the element focused when the scene is entered
+    */
+    StaticScene(size_t first_focus = 0){
+      elements.reserve(count);
+      m_table.reserve(count);
+      for (size_t i = 0; i < count; i++){
+        m_elements[i] = buildStaticElement(Specs[i], &m_slots[i], m_textures[i]);
+        m_elements[i]->m_assignShortId();
+        m_addElement(m_elements[i], true);
+      }
+      primaryElementID = m_elements[first_focus < count ? first_focus : 0]->getId();
+      m_focus_graph = graph.data();
+      m_graph_elements = m_elements;
+      m_graph_size = count;
+    }
+    StaticScene(const StaticScene&) = delete;
+    StaticScene& operator=(const StaticScene&) = delete;
+    ~StaticScene(){
+      for (const auto element : m_elements){
+        element->~UIElement();
+      }
+    }
+
+    //!@return The element built from the spec at the given index
+    inline UIElement* operator[](size_t index) const { return m_elements[index]; }
+    //!@return The element built from the spec at the given index, cast to its type
+    template<class T> inline T* get(size_t index) const { return static_cast<T*>(m_elements[index]); }
 
     private:
-    std::function<void()> m_script = [](){return;};
+    std::aligned_union_t<0, AnimatedApp, UIImage, Checkbox> m_slots[count];
+    Texture m_textures[count][2];
+    UIElement* m_elements[count];
+  };
+
+  //The settings a FrameGovernor trades between quality and speed, the defaults are the full quality a UI renders at without a governor
+  struct RenderKnobs{
+    float scale_step = 0.0f;          //Animated scales are rounded to multiples of this while running, 0 samples every frame exactly
+    bool filtered_scaling = false;    //Scale textures bilinearly instead of picking the nearest pixel
+    bool antialias = true;            //Blend the edges of outlines
+    unsigned int cache_factor = 1;    //How many times its own budget the cache of scaled textures may use
+    uint32_t frame_interval = 0;      //Minimum time between two frames in microseconds, 0 for uncapped
+  };
+
+  struct FrameStats{
+    uint32_t frames = 0;
+    uint32_t render_us = 0;           //Render time of the last frame
+    uint32_t present_us = 0;          //Present time of the last frame
+    uint32_t average_us = 0;          //Smoothed render and present time
+    uint32_t worst_us = 0;
+    uint32_t over_budget = 0;         //Frames that took longer than the budget
+    uint32_t quality_changes = 0;
+  };
+
+  /*Measures how long every frame takes to render and present, and lowers or raises the quality of the UI to stay within a time budget.
+  A quality is a set of RenderKnobs, changed only after the smoothed frame time stays out of bounds for a while, so a single slow frame
+  (like a heavy scene script) doesn't make the quality flicker. Frames are paced with the frame interval of the current quality.*/
+  class FrameGovernor{
+    public:
+    /*!
+      @param budget_us  The frame time to stay within (FPS30, FPS60...), FPS_UNCAPPED disables the governor
+    */
+    FrameGovernor(uint32_t budget_us = FPS_UNCAPPED);
+    //Change the budget, the governor starts again from Quality::Medium
+    void setBudget(uint32_t budget_us);
+    inline uint32_t getBudget() const { return m_budget; }
+    //Replace the knobs used at a quality, the frame interval is a multiple of the budget: 1.0 paces at the budget
+    void setKnobs(Quality quality, const RenderKnobs& knobs, float interval_factor = 1.0f);
+    inline const RenderKnobs& getKnobs() const { return m_budget ? m_tiers[static_cast<int>(m_quality)] : m_default; }
+    inline Quality getQuality() const { return m_quality; }
+    inline const FrameStats& getStats() const { return m_stats; }
+    inline void resetStats(){ m_stats = FrameStats(); }
+
+    //Called by the UI, the time spent rendering and presenting are added up until the next frame starts
+    inline void addRenderTime(uint32_t us){ m_render_us += us; }
+    inline void addPresentTime(uint32_t us){ m_present_us += us; }
+    //Close the measurements of the previous frame, @return True if the quality changed
+    bool beginFrame(uint32_t now_us);
+    //!@return True if enough time passed since the last frame started
+    inline bool isFrameDue(uint32_t now_us) const { return now_us - m_frame_start >= getKnobs().frame_interval; }
+    //!@return The animation value rounded to the current scale step, exact when the animation isn't running
+    float sampleScale(const Animation& anim) const;
+
+    private:
+    void m_setQuality(Quality quality);
+
+    private:
+    RenderKnobs m_tiers[3];
+    float m_interval_factors[3] = {1.5f, 1.0f, 1.0f};
+    RenderKnobs m_default;
+    FrameStats m_stats;
+    Quality m_quality = Quality::Medium;
+    uint32_t m_budget = 0;
+    uint32_t m_render_us = 0, m_present_us = 0;
+    uint32_t m_frame_start = 0;
+    bool m_measuring = false;
+    bool m_changed = false;           //The knobs changed outside of beginFrame()
+    unsigned int m_slow_frames = 0;   //Consecutive frames with the average over the budget
+    unsigned int m_fast_frames = 0;   //Consecutive frames with the average well under the budget
   };
 
   /*This is the object that has the power over the final frame, this reads inputs, handles focusing, and is responsible for calling the rendering
@@ -372,24 +1523,124 @@ namespace SimpleUI{
     public:
     Focus focus;
     std::vector<Scene*> scenes;
-    GFXcanvas16 *buffer;
+    Adafruit_GFX *buffer;       //Any canvas works, a FrameBuffer allows for lower bit depths
+    AssetStore *assets;         //Where textures and their scaled copies are stored, can be shared with other UIs
+    uint16_t background = 0x0000; //RGB565 color the buffer is cleared with by Frame()
+    FrameGovernor governor;       //Adapts the render quality to a frame time budget, disabled until it's given one
     
     
     public:
-    UI(Scene* first_scene = nullptr, GFXcanvas16* framebuffer = nullptr);
+    UI(Scene* first_scene = nullptr, Adafruit_GFX* framebuffer = nullptr, AssetStore* store = nullptr);
+    /*!
+      @brief Create a UI on a canvas it knows how to read back, picked by the type of the canvas:
+      - A StripBuffer renders in horizontal strips instead of a full framebuffer, RAM use is proportional to the strip size.
+        Every strip is presented as soon as it's rendered, and the next one is rendered into the other half of the strip buffer meanwhile.
+        The scene script runs once per strip and must draw into the UI's buffer.
+      - On a GFXcanvas16 translucent textures and antialiased outlines are blended with what's underneath.
+      - On a FrameBuffer blending reads back the pixels of any format.
+      Any other canvas is drawn on without being read.
+      @param first_scene The scene focused at the start
+      @param canvas      Where the frame is rendered
+      @param store       Where textures are stored, AssetStore::shared() if nullptr
+    */
+    template<class Canvas, class = std::enable_if_t<std::is_base_of_v<Adafruit_GFX, Canvas>>>
+    UI(Scene* first_scene, Canvas* canvas, AssetStore* store = nullptr) : UI(first_scene, static_cast<Adafruit_GFX*>(canvas), store){
+      if constexpr (std::is_base_of_v<StripBuffer, Canvas>)
+        m_strip = canvas;
+      else if constexpr (std::is_base_of_v<GFXcanvas16, Canvas>)
+        m_canvas16 = canvas;
+      else if constexpr (std::is_base_of_v<FrameBuffer, Canvas>)
+        m_framebuffer = canvas;
+    }
     void AddScene(Scene* scene);
     void FocusScene(Scene* scene);
     inline const Scene* getActiveScene() const { return focus.activeScene; }
     void Render();
+    /*!
+      @brief Set what sends the finished buffer to the display
+      @param present Called with the framebuffer every time the UI presents a frame
+    */
+    inline void bindDisplay(const Delegate<void(Adafruit_GFX*)>& present){ m_display = present; }
+    /*!
+      @brief Let a loader know which scene is shown, so the textures it loaded for the other scenes can be evicted
+      @param loader  The loader, nullptr to unbind it. The active scene is checked at every Render()
+    */
+    void bindLoader(TextureLoader* loader);
+    //Prepare the scenes that can be opened from the focused element while the current one is shown, nullptr to unbind
+    inline void bindPreloader(ScenePreloader* preloader){ m_preloader = preloader; m_preload_scene = nullptr; }
+    /*!
+      @brief Mirror every presented frame, so it can be watched remotely. A strip UI mirrors each strip as it's presented
+      @param mirror  The mirror, nullptr to unbind it. It keeps a copy of the frame in its own format
+      @return False if the canvas can't be read back or the copy couldn't be allocated
+    */
+    bool bindMirror(FrameMirror* mirror);
+    //Send the buffer to the display bound with bindDisplay(), in strip mode every strip is already presented by Render()
+    void Present();
+    //Clear the buffer, render the active scene and present the result
+    void Frame();
+    /*!
+      @brief Redraw only what changed, when the only elements that changed can redraw part of themselves (see UIElement::canRenderDelta()),
+      like value widgets. Anything else that asks for a frame (an input, invalidate(), a script, another animation) draws it whole,
+      and so do changes with an element drawn over them. A strip UI renders only the strips the changes touch.
+      Otherwise the buffer keeps the last frame: Render() clears it on its own before drawing a whole frame, don't clear it before.
+    */
+    inline void setPartialRedraw(bool enabled){ m_partial_redraw = enabled; invalidate(); }
+    inline bool isPartialRedraw() const { return m_partial_redraw; }
+    //!@return How many frames only redrew what changed
+    inline uint32_t getPartialFrameCount() const { return m_partial_frames; }
+    /*!
+      @brief Set what's told when an element scrolls lines of the screen, so a display that scrolls in hardware (see DisplayTransport::scroll())
+      can move the lines it already shows instead of receiving them again. Only scrolls as wide as the buffer are reported
+      @param scroller  Called with the first line and the number of lines that scrolled, and how far their content moved up (negative if down)
+    */
+    inline void bindScroller(const Delegate<void(int16_t, uint16_t, int16_t)>& scroller){ m_scroller = scroller; }
+    //Called by the elements that scroll their content, from update(), once the content of an area of the screen moved up by some lines
+    void reportScroll(const Rect& area, int lines);
+    //!@return How the pixels of the buffer can be read back, nothing is readable if the canvas type wasn't known at construction
+    PixelAccess getPixelAccess() const;
+    //Draw a texture of any pixel type into the buffer, a RGB565A4 texture is blended with the pixels underneath
+    void drawTexture(const Texture& texture, Point pos, uint16_t mono_color = 0xFFFF);
+    //Draw a texture rotated, scaled or mirrored by a transform, sampled bilinearly when the governor allows filtering
+    void drawTexture(const Texture& texture, const TextureTransform& transform, uint16_t mono_color = 0xFFFF);
+    //Draw a rounded rectangle outline into the buffer, antialiased unless the governor turned it off, see UiUtils::drawRing()
+    void drawRing(const Rect& outer, unsigned int radius, unsigned int thickness, uint16_t color);
+    /*!
+      @brief Get a texture scaled by an animation, with the sampling and filtering chosen by the governor
+      @return The scaled texture, valid until the assets are asked for another one
+    */
+    const Texture& animatedTexture(const Texture& source, const Animation& anim);
+    //!@return The scale an animated texture is drawn at this frame
+    inline float animatedScale(const Animation& anim) const { return governor.sampleScale(anim); }
+    /*!
+      @brief Tell if the next frame would be any different from the last one: an animation is running, there was an input,
+      the scene changed, its script invalidated it, invalidate() was called or a scheduled frame is due.
+      When it's false the loop can skip rendering and presenting altogether.
+    */
+    bool needsFrame() const;
+    //Ask for a new frame, for changes the UI can't see (like an element edited from code). Any task can call it, it wakes waitForFrame()
+    void invalidate();
+    //Ask for a frame after a delay even if nothing else changes, for content that updates on a timer. Only the earliest request is kept
+    void scheduleFrame(uint32_t delay_us);
+    /*!
+      @brief Block the calling task until a frame is needed, so the CPU can idle (and light sleep, if power management allows it)
+      @param max_wait_us  Longest time to wait, so the caller can still poll its inputs
+      @return True if a frame is needed
+    */
+    bool waitForFrame(uint32_t max_wait_us);
     void FocusDirection(unsigned int direction);
     void FocusDirection(Direction direction);
     void Back();
     void Click();
     inline bool isFocusingFree() const { return !m_focusing_busy; }
+    //!@return How many times Click() was called, elements compare it between frames to react to clicks
+    inline uint32_t getClickCount() const { return m_clicks; }
+    //!@return How many frames were rendered
+    inline uint32_t getFrameCount() const { return m_frames; }
     inline UIElement* getFocused() const { return focus.activeScene->getElementByUUID(focus.focusedElementID); }
     
     #if PERFORMANCE_PROFILING
     void printPerfStats();
+    inline const std::unordered_map<std::string, uint32_t>& getPerfStats() const { return m_perfValues; }
     private:
     std::unordered_map<std::string, uint32_t> m_perfValues;
     void m_addPerf(std::string key, uint32_t time);
@@ -400,7 +1651,146 @@ namespace SimpleUI{
     private:
     void m_focusDir(unsigned int direction, FocusingAlgorithm alg);
     void m_updateFocus();
+    void m_renderStrips(const Rect* damage);
+    bool m_canRenderPartial(const Scene* scene) const;
+    bool m_collectDamage(const Scene* scene, Rect& damage) const;
+    void m_renderDamage(const Scene* scene);
+    void m_wake();
+    void m_syncLoader();
+    void m_syncPreloader();
+    void m_applyKnobs();
+    void m_present(Adafruit_GFX* target);
+    void m_mirrorBand(const uint8_t* lines, int16_t top, int16_t count);
     bool m_focusing_busy = false; //You could see this as sort of a "mutex" to prevent multiple focuses from happening in the same cycle, which could break a UI
+    uint32_t m_clicks = 0;
+    uint32_t m_frames = 0;
+    bool m_partial_redraw = false;
+    uint32_t m_partial_frames = 0;
+    Delegate<void(Adafruit_GFX*)> m_display;
+    Delegate<void(int16_t, uint16_t, int16_t)> m_scroller;
+    size_t m_base_scaled_budget = 0;  //Scaled cache budget before the governor multiplied it
+    uint32_t m_presented_us = 0;      //Time spent presenting since the UI was created
+    std::atomic<bool> m_dirty{true};              //Something the elements can't report changed, like an input
+    std::atomic<TaskHandle_t> m_waiter{nullptr};  //The task blocked in waitForFrame()
+    const Scene* m_rendered_scene = nullptr;
+    uint32_t m_deadline = 0;
+    bool m_has_deadline = false;
+    TextureLoader* m_loader = nullptr;
+    const Scene* m_loaded_scene = nullptr; //The scene the loader was last told about
+    ScenePreloader* m_preloader = nullptr;
+    const Scene* m_preload_scene = nullptr;       //Scene and element the preloader's targets were chosen from
+    const UIElement* m_preload_focus = nullptr;
+    StripBuffer* m_strip = nullptr;
+    GFXcanvas16* m_canvas16 = nullptr;
+    FrameBuffer* m_framebuffer = nullptr;
+    FrameMirror* m_mirror = nullptr;
+  };
+
+  /*Drives several UIs, each one with its own display and resolution, from a single loop. They all share the same animation clock,
+  so a frame looks consistent across displays, and by default the same AssetStore, so shared textures are stored once.
+  UIs are rendered and presented one after the other: when a display sends its frame in the background, the next UI renders meanwhile.*/
+  class UIGroup{
+    public:
+    UIGroup(std::initializer_list<UI*> uis = {}) : m_uis(uis){}
+    inline void add(UI* ui){ m_uis.push_back(ui); }
+    //Render and present a frame on every UI, all at the same animation time
+    void Render();
+    inline const std::vector<UI*>& getUIs() const { return m_uis; }
+
+    private:
+    std::vector<UI*> m_uis;
+  };
+
+  /*Reports what a UI is doing on a TelemetryChannel: its frame times and the heap at a steady rate, and the focused element
+  and the state of its animation as soon as they change. Sampling only posts a few bytes to the channel, it's cheap enough
+  to run after every frame on the render core, the channel is drained and sent by another task.
+  The channel takes records from a single task, so only the render task posts: other tasks ask for a Hello record with
+  requestHello() and change the interval, and the next sample() acts on it.*/
+  class UITelemetry{
+    public:
+    /*!
+      @param ui           The UI to watch
+      @param channel      Where the records are posted
+      @param interval_us  Time between two Frame and Heap records, 0 for a Frame record every frame
+      @param transport    Also report what this transport sent, at the same rate
+    */
+    UITelemetry(UI* ui, TelemetryChannel* channel, uint32_t interval_us = 100000U, const DisplayTransport* transport = nullptr)
+    : m_ui(ui), m_channel(channel), m_transport(transport), m_interval(interval_us){}
+    //Call after every frame, from the task that renders
+    void sample();
+    //Post a Hello record, the receiver learns the protocol version and when the board started. From the task that renders
+    void hello(uint32_t cpu_mhz = 0);
+    //Have the next sample() post a Hello record, from any task
+    inline void requestHello(uint32_t cpu_mhz = 0){ m_hello_mhz = cpu_mhz; m_hello_requested = true; }
+    //Can be called from any task
+    inline void setInterval(uint32_t interval_us){ m_interval = interval_us; }
+    inline uint32_t getInterval() const { return m_interval; }
+
+    private:
+    void m_sampleFocus();
+
+    private:
+    UI* m_ui;
+    TelemetryChannel* m_channel;
+    const DisplayTransport* m_transport;
+    std::atomic<uint32_t> m_interval;
+    std::atomic<uint32_t> m_hello_mhz{0};
+    std::atomic<bool> m_hello_requested{false};
+    uint32_t m_last_report = 0;
+    uint32_t m_last_frame = 0;        //Frame number of the last Frame record
+    bool m_reported = false;
+    std::string m_focused;            //Id of the element focused at the last sample
+    AnimState m_anim_state = AnimState::Start;
+    bool m_anim_direction = false;
+  };
+
+  /*Prepares the scenes a UI is likely to show next on a background task, so the first frame of a scene doesn't stall when it's entered.
+  The UI picks the scene bound to the focused AnimatedApp and the scenes that have the active one among their parents.
+  Their textures are decoded by the TextureLoader within a memory budget. Layouts are left to the render task, which owns the
+  element positions and measures a scene's containers on its first frame.
+  A new request cancels the one in progress, and the UI cancels preloading altogether when it switches scene.*/
+  class ScenePreloader{
+    public:
+    /*!
+      @param loader  Where the textures of the scenes were loaded
+      @param budget  How many bytes of textures a request is allowed to decode
+    */
+    ScenePreloader(TextureLoader* loader, size_t budget = 16384U) : m_loader(loader), m_budget(budget){}
+    ~ScenePreloader();
+    /*!
+      @brief Start the background task, until then requests are worked on only by poll()
+      @param priority    FreeRTOS priority of the task, keep it below the one rendering the UI
+      @param core        The core the task runs on
+      @param stack_size  Stack of the task in bytes, PNG decoding needs about 3kb
+      @return True if the task was created
+    */
+    bool start(unsigned int priority = 1, int core = 0, uint32_t stack_size = 4096);
+    //Preload these scenes, in order of likelihood, instead of the ones requested before
+    void request(const std::vector<Scene*>& scenes);
+    //Drop the pending request and return once the scene being prepared, if any, is released
+    void cancel();
+    //Work on the pending request on the calling task, @return True if there was one
+    bool poll();
+    inline void setBudget(size_t bytes){ m_budget = bytes; }
+    //!@return How many requests were completed without being cancelled
+    inline uint32_t getCompleted() const { return m_completed; }
+
+    private:
+    static void m_task(void* preloader);
+
+    private:
+    TextureLoader* m_loader;
+    size_t m_budget;
+    std::mutex m_request_lock;    //Guards the pending request
+    std::mutex m_work_lock;       //Held while a request is worked on
+    std::vector<Scene*> m_pending;
+    bool m_has_pending = false;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_exited{false};    //Set by the task right before it deletes itself
+    std::atomic<uint32_t> m_completed{0};
+    TaskHandle_t m_task_handle = nullptr;
+    TaskHandle_t m_stopper = nullptr;     //The task destroying the preloader, notified when the task exits
   };
 
   #if PERFORMANCE_PROFILING
@@ -427,5 +1817,34 @@ namespace SimpleUI{
     UIElement* findElementInRay(UIElement* focused, Scene* currentScene, const Ray& ray);
 
     std::set<Point> computeConePoints(Point vertex, Cone cone);
+
+    /*!
+      @brief Blend a color over a pixel, with the best method the canvas allows
+      @param alpha  Opacity from 0 to 32, canvases that can't be read back draw the pixel only if it's at least half opaque
+    */
+    void blendPixel(Adafruit_GFX* target, const PixelAccess& access, int16_t x, int16_t y, uint16_t color, uint8_t alpha);
+    /*!
+      @brief Draw a texture of any pixel type, RGB565A4 textures are blended a line at a time when the canvas exposes its pixels
+      @param mono_color  Color of the set bits of a Mono texture
+    */
+    void drawTexture(Adafruit_GFX* target, const PixelAccess& access, const Texture& texture, Point pos, uint16_t mono_color);
+    /*!
+      @brief Draw a texture of any pixel type through an affine transform, clipped to the canvas
+      The screen is walked one line at a time, only over the span the texture covers, and the texture position of each pixel
+      is stepped in fixed point. Semi-transparent pixels are blended when the canvas can be read back.
+      @param transform  Where the texture goes, see TextureTransform
+      @param sampling   Bilinear also smooths the edges of Mono textures and the alpha of RGB565A4 ones
+    */
+    void drawTexture(Adafruit_GFX* target, const PixelAccess& access, const Texture& texture, const TextureTransform& transform, uint16_t mono_color, TextureSampling sampling = TextureSampling::Nearest);
+    /*!
+      @brief Draw a rounded rectangle outline in a single pass, the edges of the corners are antialiased by their coverage
+      Straight parts are drawn as spans, only the pixels crossed by the arcs are blended.
+      @param outer      Outer bounds of the ring
+      @param radius     Radius of the outer corners, 0 for square corners
+      @param thickness  Thickness of the ring in pixels, the corners of the hole have radius - thickness
+      @param color      RGB565 color
+      @param antialias  False to draw the pixels at least half covered and skip blending
+    */
+    void drawRing(Adafruit_GFX* target, const PixelAccess& access, const Rect& outer, unsigned int radius, unsigned int thickness, uint16_t color, bool antialias = true);
   }
 }
@@ -22,6 +22,8 @@ using namespace SimpleUI;
 SPIClass spi(VSPI);
 Adafruit_ST7735 tft(&spi, -1, DC, RST);
 GFXcanvas16 canvas(SCREENWIDTH, SCREENHEIGHT);
+SPIDisplayBus bus(spi, DC, -1, 78000000);
+DisplayTransport transport(bus, 1024, 2, 1); //The memory of the green tab panel starts at column 2, row 1
 
 
 //--------------------------UI SETUP-----------------------------//
@@ -39,81 +41,80 @@ Texture largeSettings(HOME_LARGE_SETTINGS_SIZE, HOME_LARGE_SETTINGS_SIZE, home_l
 Texture smallSettings(HOME_SMALL_SETTINGS_SIZE, HOME_SMALL_SETTINGS_SIZE, home_small_settings);
 
 
-AnimatedApp play    (&smallPlayTest, &playTest,     {64, 32},  true, 80U, Interpolation::Sinusoidal, Constraint::Center);
-AnimatedApp settings(&smallSettings, &largeSettings,{25, 32},  true, 80U, Interpolation::Sinusoidal, Constraint::Center);
-AnimatedApp gallery (&smallGallery , &largeGallery, {103, 32}, true, 80U, Interpolation::Sinusoidal, Constraint::Center);
-Scene home({&play, &settings, &gallery}, &play);
+AnimatedApp play    (&smallPlayTest, &playTest,     {0, 0}, false, 80U, Interpolation::Sinusoidal, Constraint::Center);
+AnimatedApp settings(&smallSettings, &largeSettings,{0, 0}, false, 80U, Interpolation::Sinusoidal, Constraint::Center);
+AnimatedApp gallery (&smallGallery , &largeGallery, {0, 0}, false, 80U, Interpolation::Sinusoidal, Constraint::Center);
+HStack homeIcons({&settings, &play, &gallery}, {64, 32}, true, 14);
+ParticleEmitter homeEffects(96, Rect(0, 0, SCREENWIDTH, SCREENHEIGHT)); //Sparks on focus and clicks, drawn over the icons
+Scene home({&homeIcons, &homeEffects}, &play);
 
-Checkbox check1(Outline(2, 2, 5, 0xFFFF), {0 ,5}, 16, 16, 0xFFFF);
-Checkbox check2(Outline(2, 2, 5, 0xFFFF), {20,5}, 16, 16, 0xFFFF);
-Checkbox check3(Outline(2, 2, 5, 0xFFFF), {40,5}, 16, 16, 0xFFFF);
-Scene test({&check1, &check2, &check3}, &check1);
+constexpr std::array<ElementSpec, 3> testSpec{{
+  ElementSpec::Check(Outline(2, 2, 5, 0xFFFF), {0 ,5}, 16, 16, 0xFFFF),
+  ElementSpec::Check(Outline(2, 2, 5, 0xFFFF), {20,5}, 16, 16, 0xFFFF),
+  ElementSpec::Check(Outline(2, 2, 5, 0xFFFF), {40,5}, 16, 16, 0xFFFF)
+}};
+StaticScene<testSpec> test(0);
 
 UI ui(&home, &canvas);
 //--------------------------UI SETUP-----------------------------//
 
 TaskHandle_t serialComms;
+TelemetryChannel telemetry(2048);
+UITelemetry uiTelemetry(&ui, &telemetry, 100000, &transport); //Frame times and the heap ten times a second, focus and animations as they change
+FrameMirror mirror(&telemetry, 1000, 512); //What the panel shows, on demand. At most 1ms a frame, and room left for the telemetry
+
+//Set by the comms task, the UI and the mirror are only touched by loop()
+std::atomic<bool> backRequested{false};
+enum class MirrorRequest : uint8_t{None, Start, Stop};
+std::atomic<MirrorRequest> mirrorRequest{MirrorRequest::None};
+
+/*Streams the telemetry posted by the render core as binary records, see tools/TelemetryDecoder to read them on a computer.
+Only as many bytes as the serial buffer can take are written, so this task never waits on the link either.
+Commands: "hello" posts the uptime and CPU frequency, "rate <ms>" changes the reporting interval, "mirror" starts mirroring the
+screen (or sends it whole again), "mirror off" stops it, "back" and "reset".
+The telemetry channel takes records from the render core only, this task asks for them and loop() posts them.*/
 void handleComms( void *pvParameters){
-  Serial.setTimeout(250);
+  Serial.setTimeout(20);
+  uint8_t chunk[64];
 
   while(true){
+    size_t room;
+    while ((room = std::min(static_cast<size_t>(Serial.availableForWrite()), sizeof(chunk))) > 0){
+      const size_t len = telemetry.read(chunk, room);
+      if (len == 0)
+        break;
+      Serial.write(chunk, len);
+    }
+
     if (Serial.available()){
       String input = Serial.readString();
       input.trim();
-      if (input == "freemem")
-      {
-        Serial.printf("Used heap: %fkb / %fkb\n", (static_cast<float>(ESP.getHeapSize()) / 1000.0) - static_cast<float>(ESP.getFreeHeap()) / 1000.0, static_cast<float>(ESP.getHeapSize()) / 1000.0);
-      }
-      else if(input == "version"){
-        Serial.println(ESP.getSdkVersion());
-      }
-      else if (input == "reset")
+      if (input == "hello")
       {
-        Serial.println("Rebooting...");
-        ESP.restart();
+        uiTelemetry.requestHello(ESP.getCpuFreqMHz());
       }
-      else if (input == "uptime")
+      else if (input.startsWith("rate "))
       {
-        Serial.printf("Uptime: %lu seconds\n", millis() / 1000);
+        uiTelemetry.setInterval(input.substring(5).toInt() * 1000);
       }
-      else if (input == "freq")
+      else if (input == "mirror")
       {
-        Serial.printf("Frequency: %dMHz\n", ESP.getCpuFreqMHz());
+        mirrorRequest = MirrorRequest::Start;
       }
-      else if (input == "debugui")
+      else if (input == "mirror off")
       {
-        UIElement *obj = ui.getFocused();
-        Serial.printf("ID: %s\n", ui.focus.focusedElementID.c_str());
-        switch(obj->anim.getState()){
-          case AnimState::Start: Serial.println("AnimState: Start"); break;
-          case AnimState::Running: Serial.println("AnimState: Running"); break;
-          case AnimState::Finished: Serial.println("AnimState: Finished"); break;
-        }
-        Serial.printf("Reverse: %s\n", obj->anim.getDirection() ? "true" : "false");
-        Serial.printf("Draw: %s\n", obj->draw ? "true" : "false");
-        if(obj->getType() == ElementType::UIElement)
-          Serial.println("Type: UIElement");
-        else if (obj->getType() == ElementType::UIImage)
-          Serial.println("Type: UIImage");
-        else if (obj->getType() == ElementType::Checkbox)
-          Serial.println("Type: Checkbox");
-        else 
-          Serial.println("Type: AnimatedApp");
+        mirrorRequest = MirrorRequest::Stop;
       }
-      else if (input == "perfstats")
+      else if (input == "reset")
       {
-        #if PERFORMANCE_PROFILING
-          ui.printPerfStats();
-        #else
-          Serial.println("Performance profiling is turned off!");
-        #endif
+        ESP.restart();
       }
       else if (input == "back")
       {
-        ui.Back();
+        backRequested = true;
       }
     }
-    vTaskDelay(pdMS_TO_TICKS(100));
+    vTaskDelay(pdMS_TO_TICKS(10));
   }
 }
 
@@ -138,9 +139,13 @@ auto loadTest = [&](){
 
 auto testSceneScript = [&](){
   canvas.fillRect(int(myAnimation.getProgress()), 0, 10, 10, ST7735_ORANGE);
+};
+
+auto testSceneUpdate = [&](){
   myAnimation.Update();
     if(myAnimation == AnimState::Finished)
       myAnimation.Flip();
+  test.invalidate(); //The square never stops moving
 };
 
 //-------------SETTINGS----------------//
@@ -174,13 +179,15 @@ void initLCD(){
   tft.initR(INITR_GREENTAB);
   tft.setSPISpeed(78000000); //Absolute fastest speed tested, errors at 80000000
   tft.fillScreen(ST7735_BLACK);
+  transport.setRotation(PanelRotation::Deg0, SCREENWIDTH, SCREENHEIGHT); //The canvas is always drawn upright, a panel mounted turned only changes this
+  transport.setScrollable(162); //The ST7735 scrolls over its 162 rows of memory, a full width ScrollView only sends the lines it brings in
 }
 
 inline __attribute__((always_inline))
 void blit()
 {
-  tft.setAddrWindow(0, 0, 128, 64);
-  tft.writePixels(canvas.getBuffer(), 8192, false);
+  transport.queueChanged(canvas.getBuffer(), SCREENWIDTH, SCREENHEIGHT); //Only the lines that changed since the last frame are sent
+  transport.flush();
 }
 
 
@@ -192,16 +199,27 @@ void setup() {
 
 
   home.settings.focus.outline = Outline(2, 2, 3);
+  homeEffects.focus_effect = ParticleEffect(16, hex("#ff8e00"), 0x0000, 15.0f, 40.0f, 150U, 300U);
+  homeEffects.click_effect = ParticleEffect(48, 0xFFFF, hex("#ff8e00"), 40.0f, 90.0f, 250U, 450U);
+  homeEffects.click_effect.gravity = 120.0f;
   test.settings.focus.outline = Outline(1, 1, 7, hex("#6b6b6b"));
 
 
   ui.AddScene(&test);
-  play.bind(loadTest);
+  play.bind(loadTest, &test);
   test.addParents({&home});
 
 
-  test.Script(testSceneScript, true);
+  test.Script(testSceneScript, true, testSceneUpdate);
   myAnimation.setLoop(true);
+
+  ui.bindDisplay([](Adafruit_GFX*){ blit(); });
+  ui.bindScroller([](int16_t top, uint16_t height, int16_t lines){ transport.scroll(top, height, lines); });
+  mirror.setEnabled(false);
+  ui.bindMirror(&mirror);
+  mirror.useDirtyHints(true); //The transport already knows which lines changed, the mirror only looks at those
+  transport.onChangedLines([](uint16_t y, uint16_t count){ mirror.markDirty(y, count); });
+  ui.governor.setBudget(fpsTarget); //The quality adapts to the frame rate target, an uncapped UI always renders at full quality
 }
 
 
@@ -221,8 +239,29 @@ void loop() {
   if(button3.clickedOnce){
     ui.Click();
   }
+  if (backRequested.exchange(false)){
+    ui.Back();
+  }
+  switch (mirrorRequest.exchange(MirrorRequest::None)){
+    case MirrorRequest::Start:
+      mirror.setEnabled(true);
+      mirror.resync();  //Already mirroring, the whole screen is sent again
+      ui.invalidate();  //With the next frame, even if nothing moves
+      break;
+    case MirrorRequest::Stop:
+      mirror.setEnabled(false);
+      break;
+    default:
+      break;
+  }
+
+  if (!ui.needsFrame()){
+    rememberButtons(buttons); //The edges seen in this pass were handled, the next pass must not see them again
+    ui.waitForFrame(10000); //Nothing would change on screen, sleep until there's something to draw or the buttons need polling
+    return;
+  }
 
-  if (deltaTime >= fpsTarget){
+  if (ui.governor.isFrameDue(micros())){
     lastFrame = micros();
     
     canvas.fillScreen(0x0000); //Fill the background with a black frame
@@ -235,7 +274,8 @@ void loop() {
     computeTime(render_frametime);
     framerate(render_frametime);  //Render the framerate in the bottom-left corner on top of everything
 
-    blit(); //RENDER THE FRAME
+    ui.Present(); //RENDER THE FRAME
+    uiTelemetry.sample();
 
     //TEMPORAL VARIABLES AND FUNCTIONS
     rememberButtons(buttons);
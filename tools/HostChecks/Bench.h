@@ -0,0 +1,14 @@
+//Timing helper of the benchmarks, run them with bench.sh so the library is built with optimisations
+#pragma once
+#include <chrono>
+
+namespace HostChecks{
+    //!@return The average time of a call to func in microseconds, over the given number of calls
+    template<class Func>
+    double timeUs(int calls, Func&& func){
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; i++)
+            func();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / calls;
+    }
+}
@@ -0,0 +1,18 @@
+//Counts the expectations that failed, a check returns the count from main() so run.sh sees it in the exit code
+#pragma once
+#include <stdio.h>
+
+namespace HostChecks{
+    inline int& failures(){
+        static int count = 0;
+        return count;
+    }
+}
+
+#define EXPECT(condition) \
+    do{ \
+        if (!(condition)){ \
+            HostChecks::failures()++; \
+            printf("%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
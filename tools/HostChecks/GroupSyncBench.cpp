@@ -0,0 +1,62 @@
+/*Times the sync of a scene of 10 panels of 10 rows of 10 elements (1110 rows) when nothing changed, after one element moved and
+after a whole panel slid, the figures quoted when the table started skipping subtrees that didn't change. A flat scene of the
+same elements is synced after one move for comparison. Run with `tools/HostChecks/bench.sh GroupSyncBench`.*/
+#include "Bench.h"
+#include "SimpleUI.h"
+#include <stdio.h>
+#include <vector>
+
+using namespace SimpleUI;
+
+namespace{
+    //A scene filled at run time, the public constructors take a fixed list
+    class BuiltScene : public Scene{
+        public:
+        BuiltScene() : Scene({}){}
+        void add(UIElement* element){ m_addElement(element, true); }
+    };
+
+    Group* group(UIElement** children, Point pos){
+        return new Group({children[0], children[1], children[2], children[3], children[4],
+                          children[5], children[6], children[7], children[8], children[9]}, pos);
+    }
+}
+
+int main(){
+    std::vector<UIElement*> elements;
+    std::vector<Group*> panels;
+    BuiltScene nested;
+    for (int p = 0; p < 10; p++){
+        UIElement* rows[10];
+        for (int r = 0; r < 10; r++){
+            UIElement* row[10];
+            for (int i = 0; i < 10; i++){
+                row[i] = new UIElement(6, 6, {int16_t(i * 8), 0});
+                elements.push_back(row[i]);
+            }
+            rows[r] = group(row, {0, int16_t(r * 8)});
+        }
+        panels.push_back(group(rows, {int16_t(p % 5 * 64), int16_t(p / 5 * 120)}));
+        nested.add(panels.back());
+    }
+    nested.prepareLayout();
+    nested.syncElements();
+
+    const int runs = 300;
+    int step = 0;
+    const double idle = HostChecks::timeUs(runs, [&]{ nested.syncElements(); });
+    const double moved = HostChecks::timeUs(runs, [&]{ elements[555]->setPos({int16_t(40 + (step++ & 1) * 2), 300}); nested.syncElements(); });
+    const double slide = HostChecks::timeUs(runs, [&]{ panels[3]->setPos({int16_t((step++ & 7) * 4), 0}); nested.prepareLayout(); nested.syncElements(); });
+    printf("  nested, 1110 rows: sync %.2f us, one moved %.2f us, panel slide (layout and sync) %.1f us\n", idle, moved, slide);
+
+    std::vector<UIElement*> loose;
+    BuiltScene flat;
+    for (int i = 0; i < 1100; i++){
+        loose.push_back(new UIElement(6, 6, {int16_t(i % 40 * 8), int16_t(i / 40 * 8)}));
+        flat.add(loose.back());
+    }
+    flat.syncElements();
+    const double flat_moved = HostChecks::timeUs(runs, [&]{ loose[5]->setPos({int16_t(step++ & 3), 0}); flat.syncElements(); });
+    printf("  flat, 1100 rows:   one moved %.2f us\n", flat_moved);
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*Renders the same scene of value widgets and a chart twice, once with partial redraw and once drawing every frame whole,
+and checks that both show the same pixels after every frame. The values change at random, at once or through their transitions,
+the slider is moved by inputs and the chart is fed a few samples at every step, so its plot is shifted in place. Both renders
+share the time their transitions start at and the animation time of each frame. It's done on an RGB565 canvas, an RGB332
+framebuffer and a strip buffer, where only the strips the changes touch are presented.
+Run with `tools/HostChecks/run.sh PartialRedrawCheck`.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace SimpleUI;
+
+namespace{
+    constexpr int WIDTH = 128, HEIGHT = 64;
+
+    //The widgets of one render, built the same way for both
+    struct Widgets{
+        ProgressBar bar{Outline(1, 1, 3, 0xFFFF), {2, 2}, 60, 10, 0x07E0, 0x2104};
+        ProgressBar column{Outline(1, 1, 0, 0xF800), {116, 2}, 10, 58, 0xFFE0, 0x0000, Direction::Up};
+        Slider slider{Outline(1, 1, 2, 0xFFFF), {2, 22}, 60, 12, 0x001F, 0x4208, 0xF81F, 5U};
+        Gauge gauge{Outline(1, 1, 0, 0xFFFF), {68, 4}, 44, 9U, 0xFD20, 0x2945};
+        SampleRing samples{64U};
+        Chart chart{&samples, {2, 40}, 60, 22, -1.0f, 1.0f, 2U, 0x07FF, 0x1082};
+        Scene scene{{&bar, &column, &slider, &gauge, &chart}, &slider};
+
+        Widgets(){
+            bar.setTransition(120, Interpolation::Sinusoidal);
+            column.setTransition(120, Interpolation::Linear);
+            slider.setTransition(80, Interpolation::Sinusoidal);
+            gauge.setTransition(120, Interpolation::Sinusoidal);
+            slider.setStep(0.15f);
+        }
+    };
+
+    //Copy what a canvas holds into a frame of RGB565 pixels, a strip buffer only holds the band it presents
+    void capture(GFXcanvas16* canvas, std::vector<uint16_t>& frame){
+        memcpy(frame.data(), canvas->getBuffer(), frame.size() * sizeof(uint16_t));
+    }
+    void capture(FrameBuffer* canvas, std::vector<uint16_t>& frame){
+        for (int y = 0; y < HEIGHT; y++)
+            canvas->readLine(y, 0, WIDTH, frame.data() + y * WIDTH);
+    }
+    void capture(StripBuffer* canvas, std::vector<uint16_t>& frame){
+        memcpy(frame.data() + canvas->getTop() * WIDTH, canvas->getPixels(), canvas->getLines() * WIDTH * sizeof(uint16_t));
+    }
+
+    //A UI on its own canvas, and the frame it last presented
+    template<class Canvas>
+    struct Render{
+        Widgets widgets;
+        Canvas* canvas;
+        UI ui;
+        std::vector<uint16_t> shown = std::vector<uint16_t>(WIDTH * HEIGHT);
+
+        Render(Canvas* target, bool partial) : canvas(target), ui(&widgets.scene, target){
+            ui.setPartialRedraw(partial);
+            ui.bindDisplay([this](Adafruit_GFX*){ capture(canvas, shown); });
+        }
+    };
+
+    //!@return How many frames differed
+    template<class Canvas>
+    int compare(const char* name, Canvas&& partial_canvas, Canvas&& full_canvas){
+        Render<Canvas> partial(&partial_canvas, true), full(&full_canvas, false);
+        int wrong_frames = 0;
+        srand(7);
+        for (int step = 0; step < 60; step++){
+            const float value = (rand() % 101) / 100.0f;
+            const bool animate = rand() % 2;
+            const int fed = rand() % 6;
+            Clock::Tick(); //The transitions of both start at the same time
+            for (Render<Canvas>* render : {&partial, &full}){
+                switch (step % 4){
+                    case 0: render->widgets.bar.setValue(value, animate); break;
+                    case 1: render->widgets.gauge.setValue(value, animate); break;
+                    case 2: render->widgets.column.setValue(value, animate); break;
+                    case 3: render->ui.FocusDirection(value < 0.5f ? Direction::Left : Direction::Right); break;
+                }
+                for (int i = 0; i < fed; i++)
+                    render->widgets.samples.push(sinf((step * 6 + i) * 0.3f) * 1.2f);
+            }
+            Clock::Release();
+            for (int frame = 0; frame < 3; frame++){
+                Clock::Tick();
+                partial.ui.Frame();
+                full.ui.Frame();
+                Clock::Release();
+                if (partial.shown != full.shown){
+                    if (!wrong_frames)
+                        printf("%s: the partial frame differs at step %d, frame %d\n", name, step, frame);
+                    wrong_frames++;
+                }
+                delay(10);
+            }
+        }
+        EXPECT(partial.ui.getPartialFrameCount() > 60);
+        EXPECT(full.ui.getPartialFrameCount() == 0);
+        return wrong_frames;
+    }
+}
+
+int main(){
+    EXPECT(compare("RGB565", GFXcanvas16(WIDTH, HEIGHT), GFXcanvas16(WIDTH, HEIGHT)) == 0);
+    EXPECT(compare("RGB332", FrameBuffer8(WIDTH, HEIGHT), FrameBuffer8(WIDTH, HEIGHT)) == 0);
+    EXPECT(compare("Strip", StripBuffer(WIDTH, HEIGHT, 8), StripBuffer(WIDTH, HEIGHT, 8)) == 0);
+    return HostChecks::failures();
+}
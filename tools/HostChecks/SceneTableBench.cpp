@@ -0,0 +1,53 @@
+/*Times a strip frame and the focus searches in flat scenes of 10, 100 and 1000 elements, the figures quoted when the
+per-frame state of a scene was packed into the ElementTable. The elements are spread between heap blocks of random size,
+as they are after a while on a board. Run with `tools/HostChecks/bench.sh SceneTableBench`.*/
+#include "Bench.h"
+#include "SimpleUI.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace SimpleUI;
+
+namespace{
+    //A scene filled at run time, the public constructors take a fixed list
+    class GridScene : public Scene{
+        public:
+        explicit GridScene(const std::vector<UIElement*>& elements) : Scene({elements[0]}, elements[0]){
+            for (size_t i = 1; i < elements.size(); i++)
+                m_addElement(elements[i], true);
+        }
+    };
+}
+
+int main(){
+    for (int count : {10, 100, 1000}){
+        std::vector<UIElement*> elements;
+        std::vector<void*> filler;
+        srand(1);
+        const int columns = count <= 10 ? 5 : count <= 100 ? 10 : 40;
+        for (int i = 0; i < count; i++){
+            filler.push_back(malloc(64 + rand() % 512));
+            elements.push_back(new UIElement(6, 6, {int16_t(i % columns * 8), int16_t(i / columns * 8)}));
+        }
+        GridScene scene(elements);
+        scene.settings.focus.max_distance = 64;
+        StripBuffer strip(320, 240, 8);
+        UI ui(&scene, &strip);
+        ui.bindDisplay([](Adafruit_GFX*){});
+        for (int i = 0; i < 3; i++)
+            ui.Render();
+
+        const double frame = HostChecks::timeUs(200, [&]{ scene.invalidate(); ui.Render(); });
+        const double ray_miss = HostChecks::timeUs(2000, [&]{ UiUtils::SignedDistance(90, &scene, elements[0]); });
+        scene.settings.focus.algorithm = FocusingAlgorithm::Cone;
+        const double cone_miss = HostChecks::timeUs(200, [&]{ UiUtils::SignedDistance(90, &scene, elements[0]); });
+        printf("  n=%-4d  strip frame %7.1f us   ray miss %7.2f us   cone miss %8.2f us\n", count, frame, ray_miss, cone_miss);
+
+        for (UIElement* element : elements)
+            delete element;
+        for (void* block : filler)
+            free(block);
+    }
+    return 0;
+}
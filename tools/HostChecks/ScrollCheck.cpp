@@ -0,0 +1,194 @@
+/*Scrolls views with partial redraw and sends the frames to a panel that scrolls in hardware, emulated by replaying the recorded
+bytes through its scroll registers (RecordingBus::replay()). Checks that the panel always shows what the canvas holds, that the
+canvas matches a UI drawing every frame from scratch, and counts the bytes saved against a transport that doesn't scroll.
+Run with `tools/HostChecks/run.sh ScrollCheck`.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include <string.h>
+
+using namespace SimpleUI;
+
+namespace{
+    constexpr int WIDTH = 128, HEIGHT = 64;
+    constexpr int PANEL_WIDTH = 132, PANEL_HEIGHT = 162;    //The ST7735 memory, the scroll area spans all of its rows
+    constexpr int X_OFFSET = 2, Y_OFFSET = 1;
+
+    uint16_t panel[PANEL_WIDTH * PANEL_HEIGHT];
+    uint16_t shown[PANEL_WIDTH * PANEL_HEIGHT];
+
+    uint32_t seed = 99;
+    int random(int below){
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed % below;
+    }
+
+    //A color per line and a dot moving across, with something drawn above the requested area that has to be clipped
+    void drawContent(Adafruit_GFX* target, const PixelAccess&, Point origin, const Rect& area){
+        for (int y = area.y; y < area.bottom(); y++){
+            target->drawFastHLine(origin.x, origin.y + y, WIDTH, static_cast<uint16_t>(y * 2654435761U >> 16));
+            target->drawPixel(origin.x + (y * 7) % WIDTH, origin.y + y, 0xFFFF);
+        }
+        target->fillRect(origin.x + 100, origin.y + area.y - 5, 10, 3, 0xF800);
+    }
+
+    //!@return How many pixels the panel shows differently from the frame, turned upside down if asked
+    int countWrong(const RecordingBus& bus, const uint16_t* frame, bool upside_down = false){
+        memset(panel, 0, sizeof(panel));
+        bus.replay(panel, PANEL_WIDTH, PANEL_HEIGHT, shown);
+        int wrong = 0;
+        for (int y = 0; y < HEIGHT; y++)
+            for (int x = 0; x < WIDTH; x++){
+                const uint16_t expected = upside_down ? frame[(HEIGHT - 1 - y) * WIDTH + WIDTH - 1 - x] : frame[y * WIDTH + x];
+                wrong += shown[(y + Y_OFFSET) * PANEL_WIDTH + x + X_OFFSET] != expected;
+            }
+        return wrong;
+    }
+}
+
+int main(){
+    {
+        //The same scrolls on a UI redrawing everything and on one redrawing only what changed, sent by a scrolling transport
+        GFXcanvas16 reference(WIDTH, HEIGHT), canvas(WIDTH, HEIGHT);
+        UIElement first_anchor(2, 2, {0, 0}), second_anchor(2, 2, {0, 0});
+        ScrollView first_view(drawContent, 600, {0, 8}, WIDTH, 48, 16, 8), second_view(drawContent, 600, {0, 8}, WIDTH, 48, 16, 8);
+        ScrollView first_narrow(drawContent, 300, {20, 0}, 60, 8, 4, 3), second_narrow(drawContent, 300, {20, 0}, 60, 8, 4, 3); //Moved in the canvas only
+        Scene first_scene({&first_anchor, &first_view, &first_narrow}, &first_anchor);
+        Scene second_scene({&second_anchor, &second_view, &second_narrow}, &second_anchor);
+        UI full(&first_scene, &reference), partial(&second_scene, &canvas);
+        partial.setPartialRedraw(true);
+
+        RecordingBus bus, plain_bus;
+        DisplayTransport transport(bus, 1024, X_OFFSET, Y_OFFSET), plain(plain_bus, 1024, X_OFFSET, Y_OFFSET);
+        transport.setScrollable(PANEL_HEIGHT);
+        int reports = 0;
+        auto scroller = [&](int16_t top, uint16_t height, int16_t lines){
+            reports++;
+            transport.scroll(top, height, lines);
+        };
+        auto present = [&](Adafruit_GFX*){
+            transport.queueChanged(canvas.getBuffer(), WIDTH, HEIGHT);
+            transport.flush();
+            plain.queueChanged(canvas.getBuffer(), WIDTH, HEIGHT);
+            plain.flush();
+        };
+        partial.bindScroller(Delegate<void(int16_t, uint16_t, int16_t)>::ref(scroller));
+        partial.bindDisplay(Delegate<void(Adafruit_GFX*)>::ref(present));
+
+        int different = 0, wrong = 0;
+        for (int frame = 0; frame < 300; frame++){
+            const int action = random(10);
+            if (action < 3){
+                const int lines = random(40) - 20;
+                first_view.scrollBy(lines, false);
+                second_view.scrollBy(lines, false);
+            }
+            else if (action == 3){
+                const int offset = random(600);
+                first_view.scrollTo(offset, false);
+                second_view.scrollTo(offset, false);
+            }
+            else if (action == 4){
+                const int lines = random(10) - 5;
+                first_narrow.scrollBy(lines, false);
+                second_narrow.scrollBy(lines, false);
+            }
+            if (frame == 150){
+                first_view.refresh();
+                second_view.refresh();
+            }
+            full.Frame();
+            if (partial.needsFrame())
+                partial.Frame();
+            for (int i = 0; i < WIDTH * HEIGHT; i++)
+                different += reference.getBuffer()[i] != canvas.getBuffer()[i];
+            wrong += countWrong(bus, canvas.getBuffer());
+        }
+        EXPECT(different == 0);
+        EXPECT(wrong == 0);
+        EXPECT(reports > 0 && partial.getPartialFrameCount() > 0);
+
+        const TransportStats& scrolled = transport.getStats();
+        const TransportStats& sent = plain.getStats();
+        EXPECT(scrolled.scrolled_lines > 0);
+        EXPECT(scrolled.pixel_bytes * 2 < sent.pixel_bytes);
+        printf("300 frames: %u pixel bytes and %u command bytes with %u lines scrolled by the panel, %u and %u without\n",
+               scrolled.pixel_bytes, scrolled.command_bytes, scrolled.scrolled_lines, sent.pixel_bytes, sent.command_bytes);
+    }
+
+    {
+        //A strip UI queues every strip as it's drawn, the rows are remapped through the scroll as well
+        StripBuffer strip(WIDTH, HEIGHT, 8);
+        UIElement anchor(2, 2, {0, 0});
+        ScrollView view(drawContent, 600, {0, 8}, WIDTH, 48, 16, 8);
+        Scene scene({&anchor, &view}, &anchor);
+        UI ui(&scene, &strip);
+        ui.setPartialRedraw(true);
+        RecordingBus bus;
+        DisplayTransport transport(bus, 512, X_OFFSET, Y_OFFSET);
+        transport.setScrollable(PANEL_HEIGHT);
+        static uint16_t image[WIDTH * HEIGHT];  //What the strips drew, to compare with the panel
+        auto scroller = [&](int16_t top, uint16_t height, int16_t lines){ transport.scroll(top, height, lines); };
+        auto present = [&](Adafruit_GFX* target){
+            StripBuffer* band = static_cast<StripBuffer*>(target);
+            memcpy(image + band->getTop() * WIDTH, band->getPixels(), band->getLines() * WIDTH * 2);
+            transport.queue(image, WIDTH, 0, band->getTop(), WIDTH, band->getLines());
+            transport.flush();
+        };
+        ui.bindScroller(Delegate<void(int16_t, uint16_t, int16_t)>::ref(scroller));
+        ui.bindDisplay(Delegate<void(Adafruit_GFX*)>::ref(present));
+
+        int wrong = 0;
+        for (int frame = 0; frame < 200; frame++){
+            if (random(3) == 0)
+                view.scrollBy(random(50) - 25, false);
+            if (ui.needsFrame())
+                ui.Frame();
+            wrong += countWrong(bus, image);
+        }
+        EXPECT(wrong == 0);
+    }
+
+    {
+        //Scrolling a band sends only the lines it exposed, moving to another band or turning the panel puts the old one back
+        GFXcanvas16 canvas(WIDTH, HEIGHT);
+        uint16_t* pixels = canvas.getBuffer();
+        RecordingBus bus;
+        DisplayTransport transport(bus, 1024, X_OFFSET, Y_OFFSET);
+        transport.setScrollable(PANEL_HEIGHT);
+        for (int i = 0; i < WIDTH * HEIGHT; i++)
+            pixels[i] = static_cast<uint16_t>((i / WIDTH) * 40503U);
+        transport.queueChanged(pixels, WIDTH, HEIGHT);
+        transport.flush();
+        EXPECT(countWrong(bus, pixels) == 0);
+
+        //Lines 10 to 40 move up by 5
+        memmove(pixels + 10 * WIDTH, pixels + 15 * WIDTH, 25 * WIDTH * 2);
+        for (int y = 35; y < 40; y++)
+            for (int x = 0; x < WIDTH; x++)
+                pixels[y * WIDTH + x] = static_cast<uint16_t>(0x1234 + y);
+        EXPECT(transport.scroll(10, 30, 5));
+        const uint32_t before = transport.getStats().pixel_bytes;
+        transport.queueChanged(pixels, WIDTH, HEIGHT);
+        transport.flush();
+        EXPECT(transport.getStats().pixel_bytes - before == 5 * WIDTH * 2);
+        EXPECT(countWrong(bus, pixels) == 0);
+
+        //Lines 20 to 50 move down by 3
+        EXPECT(transport.scroll(20, 30, -3));
+        memmove(pixels + 23 * WIDTH, pixels + 20 * WIDTH, 27 * WIDTH * 2);
+        transport.queueChanged(pixels, WIDTH, HEIGHT);
+        transport.flush();
+        EXPECT(countWrong(bus, pixels) == 0);
+
+        transport.setRotation(PanelRotation::Deg180, WIDTH, HEIGHT);
+        transport.resetChanged();
+        transport.queueChanged(pixels, WIDTH, HEIGHT);
+        transport.flush();
+        EXPECT(countWrong(bus, pixels, true) == 0);
+        EXPECT(!transport.scroll(0, 10, 1));
+    }
+
+    return HostChecks::failures();
+}
@@ -0,0 +1,58 @@
+/*Two panels of nested Groups in one scene. Moving an element must resync its row and the subtree bounds of its ancestors, and
+leave the rows of the other panel alone: an element of that panel is moved behind the table's back, and the table must not see
+it until the element tells its parents that its bounds changed. Run with `tools/HostChecks/run.sh SubtreeCheck`.*/
+#include "Check.h"
+#include "SimpleUI.h"
+
+using namespace SimpleUI;
+
+namespace{
+    //Moves and bumps its own version but not the subtree versions of its parents, so a sync that descends into every subtree sees it
+    class QuietElement : public UIElement{
+        public:
+        QuietElement(unsigned int w, unsigned int h, Point pos) : UIElement(w, h, pos){}
+        void moveQuietly(Point pos){ m_position = pos; m_pos_dirty = true; m_version++; }
+    };
+
+    size_t rowOf(const ElementTable& table, const UIElement* element){
+        for (size_t row = 0; row < table.size(); row++)
+            if (table[row] == element)
+                return row;
+        return table.size();
+    }
+}
+
+int main(){
+    UIElement a0(6, 6, {0, 0}), a1(6, 6, {10, 0});
+    QuietElement b0(6, 6, {0, 0});
+    Group row({&a0, &a1});
+    Group left({&row}, {0, 0}), right({&b0}, {100, 0});
+    Scene scene({&left, &right}, &a0);
+    scene.prepareLayout();
+    scene.syncElements();
+
+    const ElementTable& table = scene.getTable();
+    const size_t left_row = rowOf(table, &left), row_row = rowOf(table, &row), a1_row = rowOf(table, &a1);
+    const size_t right_row = rowOf(table, &right), b0_row = rowOf(table, &b0);
+    EXPECT(table.getSubtreeEnd(left_row) == right_row);
+    EXPECT(table.getSubtreeEnd(row_row) == right_row);
+    const Rect b0_before = table.getPaintBounds(b0_row), right_before = table.getSubtreeBounds(right_row);
+
+    b0.moveQuietly({100, 200});
+    a1.setPos({50, 50});
+    scene.syncElements();
+    EXPECT(table.getPaintBounds(a1_row).contains({53, 53}));
+    EXPECT(table.getSubtreeBounds(row_row).contains({53, 53}));
+    EXPECT(table.getSubtreeBounds(left_row).contains({53, 53}));
+    EXPECT(table.focusableAt({53, 53}) == &a1);
+    EXPECT(table.getPaintBounds(b0_row) == b0_before);
+    EXPECT(table.getSubtreeBounds(right_row) == right_before);
+
+    b0.invalidateBounds();
+    scene.syncElements();
+    EXPECT(table.getPaintBounds(b0_row).contains({103, 203}));
+    EXPECT(table.getSubtreeBounds(right_row).contains({103, 203}));
+    EXPECT(table.focusableAt({103, 203}) == &b0);
+    EXPECT(table.focusableAt({103, 203}, &b0) == nullptr);
+    return HostChecks::failures();
+}
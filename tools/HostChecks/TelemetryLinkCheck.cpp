@@ -0,0 +1,130 @@
+/*Streams the telemetry of a rendering UI through a pseudo-terminal, the way the board writes it to its serial port, and decodes
+what comes out of the other end with TelemetryDecoder, like tools/TelemetryDecoder does. Boot messages go first and a stretch of
+the stream is lost on the way, the decoder must skip both and lose no other record.
+Run with `tools/HostChecks/run.sh TelemetryLinkCheck`, it needs openpty() from libutil.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include "../../src/images/home_images.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+using namespace SimpleUI;
+
+namespace{
+    //Bytes the board side writes at once, about what Serial.availableForWrite() allows
+    constexpr size_t CHUNK = 64;
+
+    struct Link{
+        int board = -1;     //Where the board writes, the pseudo-terminal's master
+        int host = -1;      //The port the host opens, raw like the decoder sets it
+        size_t in_flight = 0;
+    };
+
+    //Read from the host end until every byte written so far came out
+    void receive(Link& link, TelemetryDecoder& decoder){
+        uint8_t bytes[256];
+        while (link.in_flight){
+            pollfd ready{link.host, POLLIN, 0};
+            if (poll(&ready, 1, 1000) <= 0)
+                return;
+            const ssize_t got = read(link.host, bytes, sizeof(bytes));
+            if (got <= 0)
+                return;
+            decoder.feed(bytes, got);
+            link.in_flight -= std::min(link.in_flight, static_cast<size_t>(got));
+        }
+    }
+
+    void send(Link& link, const uint8_t* bytes, size_t len){
+        if (write(link.board, bytes, len) == static_cast<ssize_t>(len))
+            link.in_flight += len;
+    }
+}
+
+int main(){
+    Link link;
+    EXPECT(openpty(&link.board, &link.host, nullptr, nullptr, nullptr) == 0);
+    termios mode;
+    tcgetattr(link.host, &mode);
+    cfmakeraw(&mode);
+    tcsetattr(link.host, TCSANOW, &mode);
+
+    std::vector<TelemetryMessage> messages;
+    auto collect = [&messages](const TelemetryMessage& message){ messages.push_back(message); };
+    TelemetryDecoder decoder(TelemetryDecoder::Handler::ref(collect));
+
+    Texture small{25, 25, home_small_gallery}, large{36, 36, home_large_gallery};
+    AnimatedApp gallery{&small, &large, {10, 10}}, settings{&small, &large, {60, 10}};
+    Scene scene({&gallery, &settings}, &gallery);
+    GFXcanvas16 canvas(128, 64);
+    UI ui(&scene, &canvas);
+    TelemetryChannel channel(2048);
+    UITelemetry telemetry(&ui, &channel, 0);
+
+    const char boot[] = "ets Jun  8 2016 00:22:57\r\nrst:0x1 (POWERON_RESET)\r\n";
+    send(link, reinterpret_cast<const uint8_t*>(boot), sizeof(boot) - 1);
+    telemetry.requestHello(240); //Posted by the first sample(), like a request from the comms task
+
+    const int frames = 40, lost_frame = 20;
+    size_t lost = 0;
+    for (int frame = 0; frame < frames; frame++){
+        if (frame == 10)
+            ui.FocusDirection(Direction::Right);
+        ui.Frame();
+        telemetry.sample();
+        uint8_t bytes[CHUNK];
+        size_t len;
+        while ((len = channel.read(bytes, sizeof(bytes)))){
+            if (frame == lost_frame && !lost){ //A few bytes never make it, the records they belong to are lost
+                lost = len / 2;
+                send(link, bytes + lost, len - lost);
+            }
+            else{
+                send(link, bytes, len);
+            }
+            receive(link, decoder);
+        }
+    }
+    close(link.board);
+    close(link.host);
+
+    EXPECT(channel.getDropped() == 0);
+    EXPECT(lost > 0);
+    EXPECT(decoder.getCorrupted() == 2); //The boot messages and the cut record
+    EXPECT(decoder.getDecoded() == messages.size());
+    EXPECT(decoder.getDecoded() + 1 == channel.getPosted());
+
+    EXPECT(!messages.empty() && messages[0].type == TelemetryType::Hello);
+    EXPECT(!messages.empty() && messages[0].count == 3 && messages[0].numbers[0] == TelemetryCodec::version && messages[0].numbers[2] == 240);
+    int frame_records = 0, heap_records = 0;
+    uint32_t last_frame = 0;
+    std::vector<std::string> focused;
+    for (const TelemetryMessage& message : messages){
+        switch (message.type){
+            case TelemetryType::Frame:
+                EXPECT(message.count == 7);
+                EXPECT(frame_records == 0 || message.numbers[0] > last_frame);
+                last_frame = message.numbers[0];
+                frame_records++;
+                break;
+            case TelemetryType::Heap:
+                heap_records++;
+                break;
+            case TelemetryType::Focus:
+                focused.push_back(message.text);
+                break;
+            default:
+                break;
+        }
+    }
+    EXPECT(frame_records + heap_records >= 2 * frames - 3); //Every frame but the first is reported, one record is lost
+    EXPECT(focused.size() == 2 && focused.back() == ui.focus.focusedElementID);
+
+    printf("%u records decoded, %u corrupted, %zu bytes lost on the way\n", decoder.getDecoded(), decoder.getCorrupted(), lost);
+    return HostChecks::failures();
+}
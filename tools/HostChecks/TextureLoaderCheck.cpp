@@ -0,0 +1,270 @@
+/*Writes QOI and PNG files into a temporary directory and decodes them through a DirectoryAssetSource, the stand-in for the
+flash filesystem. The files use every QOI operation, every PNG filter, split IDAT chunks and a 4 bit palette with transparency.
+Then checks that textures of inactive scenes are evicted to fit the budget and decoded again when their scene is shown,
+and that tasks showing the same scene at once decode each texture a single time.
+Run with `tools/HostChecks/run.sh TextureLoaderCheck`, it needs zlib to compress the PNGs.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SimpleUI;
+
+namespace{
+    constexpr int WIDTH = 13, HEIGHT = 9;
+
+    struct RGBA{
+        uint8_t r, g, b, a;
+        bool operator==(const RGBA& other) const { return r == other.r && g == other.g && b == other.b && a == other.a; }
+    };
+
+    std::vector<RGBA> makeImage(){
+        std::vector<RGBA> pixels;
+        for (int y = 0; y < HEIGHT; y++)
+            for (int x = 0; x < WIDTH; x++)
+                pixels.push_back({uint8_t(x * 19), uint8_t(y * 27), uint8_t(x * y * 7), uint8_t((x + y) % 3 ? 255 : x * 20)});
+        for (int x = 0; x < 5; x++)
+            pixels[x] = {10, 20, 30, 255};  //A run
+        pixels[6] = {11, 19, 31, 255};      //Small and luma differences from the pixel before
+        pixels[7] = {20, 35, 41, 255};
+        pixels[8] = pixels[5];              //Back to a pixel already seen
+        return pixels;
+    }
+
+    void put32(std::vector<uint8_t>& out, uint32_t value){
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(uint8_t(value >> shift));
+    }
+
+    std::vector<uint8_t> encodeQOI(std::vector<RGBA> pixels, uint8_t channels){
+        std::vector<uint8_t> out = {'q', 'o', 'i', 'f'};
+        put32(out, WIDTH);
+        put32(out, HEIGHT);
+        out.push_back(channels);
+        out.push_back(0);
+        RGBA index[64] = {};
+        RGBA previous = {0, 0, 0, 255};
+        int run = 0;
+        for (size_t i = 0; i < pixels.size(); i++){
+            RGBA pixel = pixels[i];
+            if (channels == 3)
+                pixel.a = 255;
+            if (pixel == previous){
+                if (++run == 62 || i + 1 == pixels.size()){
+                    out.push_back(uint8_t(0xC0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run){
+                out.push_back(uint8_t(0xC0 | (run - 1)));
+                run = 0;
+            }
+            const int hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+            if (index[hash] == pixel){
+                out.push_back(uint8_t(hash));
+            }
+            else{
+                index[hash] = pixel;
+                const int8_t dr = int8_t(pixel.r - previous.r), dg = int8_t(pixel.g - previous.g), db = int8_t(pixel.b - previous.b);
+                if (pixel.a != previous.a){
+                    out.insert(out.end(), {0xFF, pixel.r, pixel.g, pixel.b, pixel.a});
+                }
+                else if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1){
+                    out.push_back(uint8_t(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                }
+                else if (dg >= -32 && dg <= 31 && dr - dg >= -8 && dr - dg <= 7 && db - dg >= -8 && db - dg <= 7){
+                    out.push_back(uint8_t(0x80 | (dg + 32)));
+                    out.push_back(uint8_t((dr - dg + 8) << 4 | (db - dg + 8)));
+                }
+                else{
+                    out.insert(out.end(), {0xFE, pixel.r, pixel.g, pixel.b});
+                }
+            }
+            previous = pixel;
+        }
+        out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+        return out;
+    }
+
+    void putChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data){
+        put32(out, data.size());
+        const size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        put32(out, crc32(0, out.data() + start, out.size() - start));
+    }
+
+    //Every row uses the next of the five filters
+    std::vector<uint8_t> encodePNG(const std::vector<std::vector<uint8_t>>& rows, uint8_t color_type, uint8_t depth, size_t bpp,
+                                   const std::vector<uint8_t>& palette = {}, const std::vector<uint8_t>& transparency = {}){
+        std::vector<uint8_t> raw;
+        for (size_t y = 0; y < rows.size(); y++){
+            const std::vector<uint8_t>& row = rows[y];
+            const std::vector<uint8_t> above = y ? rows[y - 1] : std::vector<uint8_t>(row.size());
+            const uint8_t filter = y % 5;
+            raw.push_back(filter);
+            for (size_t i = 0; i < row.size(); i++){
+                const int a = i >= bpp ? row[i - bpp] : 0, b = above[i], c = i >= bpp ? above[i - bpp] : 0;
+                int predicted = 0;
+                switch (filter){
+                    case 1: predicted = a; break;
+                    case 2: predicted = b; break;
+                    case 3: predicted = (a + b) / 2; break;
+                    case 4:{
+                        const int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+                        predicted = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+                        break;
+                    }
+                }
+                raw.push_back(uint8_t(row[i] - predicted));
+            }
+        }
+        std::vector<uint8_t> compressed(compressBound(raw.size()));
+        uLongf length = compressed.size();
+        compress2(compressed.data(), &length, raw.data(), raw.size(), 9);
+        compressed.resize(length);
+
+        std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        std::vector<uint8_t> header;
+        put32(header, WIDTH);
+        put32(header, HEIGHT);
+        header.insert(header.end(), {depth, color_type, 0, 0, 0});
+        putChunk(out, "IHDR", header);
+        if (!palette.empty())
+            putChunk(out, "PLTE", palette);
+        if (!transparency.empty())
+            putChunk(out, "tRNS", transparency);
+        putChunk(out, "IDAT", std::vector<uint8_t>(compressed.begin(), compressed.begin() + 7));
+        putChunk(out, "IDAT", std::vector<uint8_t>(compressed.begin() + 7, compressed.end()));
+        putChunk(out, "IEND", {});
+        return out;
+    }
+
+    void writeFile(const std::string& path, const std::vector<uint8_t>& bytes){
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    uint16_t to565(uint8_t r, uint8_t g, uint8_t b){ return uint16_t((r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3); }
+
+    //!@return How many pixels of the texture differ from the expected ones
+    int countWrong(const Texture* texture, const std::vector<RGBA>& expected, bool alpha){
+        if (!texture || !texture->data.rgb565 || texture->width != WIDTH || texture->height != HEIGHT)
+            return -1;
+        int wrong = 0;
+        for (int y = 0; y < HEIGHT; y++)
+            for (int x = 0; x < WIDTH; x++){
+                const RGBA& pixel = expected[y * WIDTH + x];
+                bool same = texture->data.rgb565[y * WIDTH + x] == to565(pixel.r, pixel.g, pixel.b);
+                if (alpha)
+                    same = same && texture->data.getAlpha(x, y, WIDTH) == pixel.a >> 4;
+                wrong += !same;
+            }
+        return wrong;
+    }
+}
+
+int main(){
+    char root[] = "/tmp/TextureLoaderCheckXXXXXX";
+    EXPECT(mkdtemp(root));
+    const std::string dir = root;
+
+    const std::vector<RGBA> image = makeImage();
+    std::vector<std::vector<uint8_t>> rgba_rows, rgb_rows, index_rows;
+    for (int y = 0; y < HEIGHT; y++){
+        std::vector<uint8_t> rgba, rgb;
+        for (int x = 0; x < WIDTH; x++){
+            const RGBA& p = image[y * WIDTH + x];
+            rgba.insert(rgba.end(), {p.r, p.g, p.b, p.a});
+            rgb.insert(rgb.end(), {p.r, p.g, p.b});
+        }
+        rgba_rows.push_back(rgba);
+        rgb_rows.push_back(rgb);
+    }
+    std::vector<uint8_t> palette;
+    for (int i = 0; i < 16; i++)
+        palette.insert(palette.end(), {uint8_t(i * 16), uint8_t(255 - i * 16), uint8_t(i * 8)});
+    std::vector<RGBA> indexed;
+    for (int y = 0; y < HEIGHT; y++){
+        std::vector<uint8_t> row((WIDTH + 1) / 2);
+        for (int x = 0; x < WIDTH; x++){
+            const int index = (x + y) % 16;
+            row[x / 2] |= uint8_t(x % 2 ? index : index << 4);
+            indexed.push_back({palette[index * 3], palette[index * 3 + 1], palette[index * 3 + 2], uint8_t(index == 0 ? 0 : index == 1 ? 128 : 255)});
+        }
+        index_rows.push_back(row);
+    }
+
+    writeFile(dir + "/rgba.qoi", encodeQOI(image, 4));
+    writeFile(dir + "/rgb.qoi", encodeQOI(image, 3));
+    writeFile(dir + "/rgba.png", encodePNG(rgba_rows, 6, 8, 4));
+    writeFile(dir + "/rgb.png", encodePNG(rgb_rows, 2, 8, 3));
+    writeFile(dir + "/palette.png", encodePNG(index_rows, 3, 4, 1, palette, {0, 128}));
+
+    DirectoryAssetSource source(dir);
+    {
+        TextureLoader loader(source, 100000);
+        EXPECT(countWrong(loader.load("rgba.qoi"), image, true) == 0);
+        EXPECT(countWrong(loader.load("/rgb.qoi"), image, false) == 0);
+        EXPECT(countWrong(loader.load("rgba.png"), image, true) == 0);
+        EXPECT(countWrong(loader.load("rgb.png"), image, false) == 0);
+        EXPECT(countWrong(loader.load("palette.png"), indexed, true) == 0);
+        EXPECT(loader.load("rgba.qoi") == loader.load("rgba.qoi"));
+        EXPECT(loader.load("missing.qoi") == nullptr);
+    }
+
+    {
+        //Room for two RGB565A4 textures: showing a scene with two evicts the one of the other scene
+        const size_t texture_bytes = WIDTH * HEIGHT * 2 + (WIDTH + 1) / 2 * HEIGHT;
+        TextureLoader loader(source, texture_bytes * 2 + 10);
+        Scene first, second;
+        Texture* a = loader.load("rgba.qoi", &first);
+        Texture* b = loader.load("rgba.png", &second);
+        Texture* c = loader.load("palette.png", &second);
+        EXPECT(a && b && c);
+        EXPECT(!loader.isResident(a) && !loader.isResident(b) && !loader.isResident(c));
+        EXPECT(a->width == WIDTH && a->height == HEIGHT);
+
+        loader.activate(&first);
+        EXPECT(loader.isResident(a) && loader.isReady(&first));
+        loader.deactivate(&first);
+        loader.activate(&second);
+        EXPECT(!loader.isResident(a) && loader.isResident(b) && loader.isResident(c));
+        EXPECT(loader.getUsage() <= texture_bytes * 2 + 10);
+        EXPECT(countWrong(b, image, true) == 0);
+        EXPECT(countWrong(c, indexed, true) == 0);
+
+        const uint32_t decodes = loader.getDecodeCount();
+        loader.deactivate(&second);
+        loader.activate(&first);
+        EXPECT(loader.isResident(a) && loader.getDecodeCount() == decodes + 1);
+        EXPECT(countWrong(a, image, true) == 0);
+    }
+
+    {
+        //The decodes run without the lock, the threads asking for a texture being decoded wait for it
+        TextureLoader loader(source, 100000);
+        Scene scene;
+        const char* names[] = {"rgba.qoi", "rgb.qoi", "rgba.png", "rgb.png", "palette.png"};
+        for (const char* name : names)
+            loader.load(name, &scene);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++)
+            threads.emplace_back([&loader, &scene]{ loader.activate(&scene); });
+        for (std::thread& thread : threads)
+            thread.join();
+        EXPECT(loader.isReady(&scene) && loader.getDecodeCount() == 5);
+        EXPECT(countWrong(loader.load("rgb.png"), image, false) == 0);
+        EXPECT(countWrong(loader.load("palette.png"), indexed, true) == 0);
+    }
+
+    for (const char* name : {"rgba.qoi", "rgb.qoi", "rgba.png", "rgb.png", "palette.png"})
+        unlink((dir + "/" + name).c_str());
+    rmdir(root);
+    return HostChecks::failures();
+}
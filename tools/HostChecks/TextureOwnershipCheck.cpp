@@ -0,0 +1,113 @@
+/*Exercises who owns the pixels of a texture: views that never free, move-only OwnedTextures and reference counted SharedTextures,
+including handles from AssetStore::scaledShared() that outlive the cache entry they came from. Every buffer is freed exactly once
+and never read after, which AddressSanitizer verifies as the check runs. Run with `tools/HostChecks/run.sh TextureOwnershipCheck`.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace SimpleUI;
+
+static_assert(std::is_trivially_copyable_v<Texture>, "A view is copied by value");
+static_assert(!std::is_copy_constructible_v<OwnedTexture>, "A buffer has a single owner");
+static_assert(std::is_nothrow_move_constructible_v<OwnedTexture>, "Owners can live in a vector");
+static_assert(!std::is_constructible_v<Texture, OwnedTexture&&>, "A view of a temporary owner would dangle");
+static_assert(!std::is_constructible_v<Texture, SharedTexture&&>, "A view of a temporary handle would dangle");
+static_assert(!std::is_assignable_v<Texture&, OwnedTexture&&>, "A view of a temporary owner would dangle");
+
+namespace{
+    uint16_t pixels[16 * 16];
+    uint8_t alpha[8 * 16];
+
+    bool samePixels(const Texture& first, const Texture& second){
+        if (first.width != second.width || first.height != second.height)
+            return false;
+        for (unsigned int i = 0; i < first.width * first.height; i++)
+            if (first.data.rgb565[i] != second.data.rgb565[i])
+                return false;
+        return true;
+    }
+}
+
+int main(){
+    for (int i = 0; i < 16 * 16; i++)
+        pixels[i] = static_cast<uint16_t>(i * 97);
+    for (int i = 0; i < 8 * 16; i++)
+        alpha[i] = static_cast<uint8_t>(i);
+    const Texture source(16, 16, static_cast<const uint16_t*>(pixels), static_cast<const uint8_t*>(alpha));
+
+    {
+        //Nothing to scale: the result wraps the source and must not free it
+        OwnedTexture same = scale(source, 1.0f);
+        EXPECT(!same.ownsPixels());
+        EXPECT(same.data.rgb565 == pixels);
+        Texture copy = same;
+        EXPECT(copy.data.rgb565 == pixels && copy.data.alpha == alpha);
+    }
+
+    //Moving hands the buffer over and leaves the source empty
+    OwnedTexture half = scale(source, 0.5f);
+    EXPECT(half.ownsPixels() && half.width == 8 && half.height == 8);
+    const uint16_t* half_pixels = half.data.rgb565;
+    OwnedTexture moved(std::move(half));
+    EXPECT(!half.ownsPixels() && half.data.mono == nullptr);
+    EXPECT(moved.ownsPixels() && moved.data.rgb565 == half_pixels);
+
+    std::vector<OwnedTexture> scaled;
+    for (int i = 0; i < 10; i++)
+        scaled.push_back(scale(source, 0.25f + 0.05f * i, i & 1)); //Reallocations move every owner
+    moved = std::move(scaled[3]);   //Frees the buffer moved held
+    EXPECT(moved.width == static_cast<unsigned int>(16 * 0.4f));
+    EXPECT(!scaled[3].ownsPixels());
+    scaled.erase(scaled.begin());
+
+    //Shared handles count their holders and free the pixels with the last one
+    SharedTexture shared(std::move(moved));
+    EXPECT(shared.getHolders() == 1 && moved.data.mono == nullptr);
+    {
+        SharedTexture copy = shared, assigned;
+        assigned = copy;
+        EXPECT(shared.getHolders() == 3);
+        SharedTexture taken(std::move(assigned));
+        EXPECT(shared.getHolders() == 3 && assigned.data.mono == nullptr);
+        assigned = taken;
+        assigned = std::move(copy);
+        EXPECT(shared.getHolders() == 3);
+    }
+    EXPECT(shared.getHolders() == 1);
+
+    //Handles copied and dropped from several tasks at once
+    std::vector<std::thread> tasks;
+    for (int t = 0; t < 4; t++)
+        tasks.emplace_back([&shared]{
+            for (int i = 0; i < 10000; i++){
+                SharedTexture copy = shared;
+                (void)copy;
+            }
+        });
+    for (std::thread& task : tasks)
+        task.join();
+    EXPECT(shared.getHolders() == 1);
+
+    //A handle from the store keeps its pixels after the store evicted them to fit its budget
+    AssetStore store(200);
+    SharedTexture held = store.scaledShared(source, 0.5f);
+    EXPECT(held.getHolders() == 2);
+    const OwnedTexture expected = scale(source, 0.5f);
+    const Texture* last = nullptr;
+    for (int i = 0; i < 8; i++)
+        last = &store.scaled(source, 0.6f + 0.04f * i);
+    EXPECT(held.getHolders() == 1);
+    EXPECT(samePixels(held, expected));
+    EXPECT(store.getScaledUsage() == Texture::getByteSize(last->width, last->height, last->data.colorspace)); //Only the last copy is left
+    store.releaseScaled();
+    EXPECT(samePixels(held, expected));
+
+    //Nothing to scale: the store hands out the source itself, a handle counts nothing
+    EXPECT(&store.scaled(source, 1.0f) == &source);
+    SharedTexture unscaled = store.scaledShared(source, 1.0f);
+    EXPECT(unscaled.data.rgb565 == pixels && unscaled.getHolders() == 0);
+
+    return HostChecks::failures();
+}
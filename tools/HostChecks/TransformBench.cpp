@@ -0,0 +1,56 @@
+/*Times drawing a 64x64 texture scaled by scale() and then drawn, against drawing it through a TextureTransform, and a rotated
+draw with both samplings. These are the figures quoted when transformed drawing was added.
+Run with `tools/HostChecks/bench.sh TransformBench`.*/
+#include "Bench.h"
+#include "SimpleUI.h"
+#include <stdio.h>
+
+using namespace SimpleUI;
+
+int main(){
+    static uint16_t colors[64 * 64];
+    static uint8_t mono[8 * 64];
+    for (int i = 0; i < 64 * 64; i++)
+        colors[i] = uint16_t(i * 31);
+    for (int i = 0; i < 8 * 64; i++)
+        mono[i] = uint8_t(i * 7);
+    const Texture rgb(64, 64, static_cast<const uint16_t*>(colors)), bw(64, 64, static_cast<const uint8_t*>(mono));
+
+    GFXcanvas16 canvas(240, 240);
+    PixelAccess access;
+    access.pixels = canvas.getBuffer();
+    access.width = 240;
+    access.lines = 240;
+    volatile uint16_t sink = 0;   //Keeps the draws from being optimised away
+
+    printf("                scale() then draw    transform\n");
+    for (float factor : {1.5f, 3.0f}){
+        const TextureTransform transform = TextureTransform::scaling(factor, factor).then(TextureTransform::translation(10, 10));
+        const double scaled = HostChecks::timeUs(2000, [&]{
+            OwnedTexture copy = scale(rgb, factor);
+            UiUtils::drawTexture(&canvas, access, copy, Point(10, 10), 0);
+            sink = sink + canvas.getBuffer()[500];
+        });
+        const double direct = HostChecks::timeUs(2000, [&]{
+            UiUtils::drawTexture(&canvas, access, rgb, transform, 0);
+            sink = sink + canvas.getBuffer()[500];
+        });
+        const double scaled_mono = HostChecks::timeUs(2000, [&]{
+            OwnedTexture copy = scale(bw, factor);
+            UiUtils::drawTexture(&canvas, access, copy, Point(10, 10), 0xFFFF);
+            sink = sink + canvas.getBuffer()[500];
+        });
+        const double direct_mono = HostChecks::timeUs(2000, [&]{
+            UiUtils::drawTexture(&canvas, access, bw, transform, 0xFFFF);
+            sink = sink + canvas.getBuffer()[500];
+        });
+        printf("  x%.1f RGB565   %10.1f us     %8.1f us\n", factor, scaled, direct);
+        printf("  x%.1f mono     %10.1f us     %8.1f us\n", factor, scaled_mono, direct_mono);
+    }
+
+    const TextureTransform rotated = TextureTransform::place(32, 32, 120, 120, 0.7f, 1.5f, 1.5f);
+    const double nearest = HostChecks::timeUs(2000, [&]{ UiUtils::drawTexture(&canvas, access, rgb, rotated, 0); });
+    const double bilinear = HostChecks::timeUs(2000, [&]{ UiUtils::drawTexture(&canvas, access, rgb, rotated, 0, TextureSampling::Bilinear); });
+    printf("  x1.5 rotated: nearest %.1f us, bilinear %.1f us\n", nearest, bilinear);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*Sends frames through a DisplayTransport into a RecordingBus and replays the recorded bytes into a model of the panel memory.
+Checks that the panel ends up showing the frame, turned by every rotation and through buffers from a single pixel to a whole frame,
+that merged regions go out in a single transaction, that no transfer buffer is touched while the bus still sends it,
+and how many bytes sending only the changed lines saves on the home scene.
+Run with `tools/HostChecks/run.sh TransportCheck`.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include "../../src/images/home_images.h"
+#include <stdlib.h>
+
+using namespace SimpleUI;
+
+namespace{
+    constexpr int WIDTH = 128, HEIGHT = 64;
+    constexpr int PANEL_WIDTH = 132, PANEL_HEIGHT = 66;
+    constexpr int X_OFFSET = 2, Y_OFFSET = 1;
+
+    /*Sends the bytes handed to data() only when wait() is called, like a DMA transfer finishing in the background,
+    and counts the transfer buffers that changed before they were out*/
+    class BackgroundBus : public RecordingBus{
+        public:
+        void command(uint8_t cmd) override {
+            wait();
+            RecordingBus::command(cmd);
+        }
+        void data(const uint8_t* bytes, size_t len) override {
+            wait();
+            m_pending = bytes;
+            m_copy.assign(bytes, bytes + len);
+        }
+        void wait() override {
+            if (!m_pending)
+                return;
+            if (!std::equal(m_copy.begin(), m_copy.end(), m_pending))
+                m_overwritten++;
+            RecordingBus::data(m_copy.data(), m_copy.size());
+            m_pending = nullptr;
+        }
+        void end() override { wait(); }
+        inline int getOverwritten() const { return m_overwritten; }
+
+        private:
+        const uint8_t* m_pending = nullptr;
+        std::vector<uint8_t> m_copy;
+        int m_overwritten = 0;
+    };
+
+    uint16_t frame[WIDTH * HEIGHT];
+    uint16_t panel[PANEL_WIDTH * PANEL_HEIGHT];
+
+    //!@return How many pixels of the rectangle the panel doesn't show like the frame
+    int countWrong(const uint16_t* pixels, int x0, int y0, int w, int h){
+        int wrong = 0;
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++)
+                wrong += panel[(y + Y_OFFSET) * PANEL_WIDTH + x + X_OFFSET] != pixels[y * WIDTH + x];
+        return wrong;
+    }
+
+    void randomize(){
+        for (uint16_t& pixel : frame)
+            pixel = static_cast<uint16_t>(rand());
+    }
+
+    //Big enough for the frame standing upright or on its side, with the offsets
+    constexpr int TURNED_SIZE = WIDTH + X_OFFSET + Y_OFFSET;
+    uint16_t turned[TURNED_SIZE * TURNED_SIZE], expected[TURNED_SIZE * TURNED_SIZE];
+
+    //!@return Where a pixel of the frame lands in the panel memory, before the offsets
+    Point rotate(int x, int y, PanelRotation rotation){
+        switch (rotation){
+            case PanelRotation::Deg90:  return Point(HEIGHT - 1 - y, x);
+            case PanelRotation::Deg180: return Point(WIDTH - 1 - x, HEIGHT - 1 - y);
+            case PanelRotation::Deg270: return Point(y, WIDTH - 1 - x);
+            default:                    return Point(x, y);
+        }
+    }
+
+    //Send regions of the frame turned, and compare the panel memory with the frame turned pixel by pixel
+    void checkRotation(PanelRotation rotation, size_t buffer_pixels){
+        struct Area{ int x, y, w, h; };
+        const Area areas[] = {{0, 0, WIDTH, HEIGHT}, {10, 10, 20, 20}, {25, 15, 20, 20}, {100, 40, 8, 8}, {0, 60, WIDTH, 4}, {127, 0, 1, HEIGHT}};
+        BackgroundBus bus;
+        DisplayTransport transport(bus, buffer_pixels, X_OFFSET, Y_OFFSET);
+        transport.setRotation(rotation, WIDTH, HEIGHT);
+        for (const Area& area : areas){
+            randomize();
+            std::fill(std::begin(turned), std::end(turned), 0);
+            std::fill(std::begin(expected), std::end(expected), 0);
+            bus.clear();
+            transport.queue(frame, WIDTH, area.x, area.y, area.w, area.h);
+            transport.flush();
+            bus.replay(turned, TURNED_SIZE, TURNED_SIZE);
+            for (int y = area.y; y < area.y + area.h; y++)
+                for (int x = area.x; x < area.x + area.w; x++){
+                    const Point at = rotate(x, y, rotation);
+                    expected[(at.y + Y_OFFSET) * TURNED_SIZE + at.x + X_OFFSET] = frame[y * WIDTH + x];
+                }
+            if (!std::equal(std::begin(turned), std::end(turned), std::begin(expected))){
+                HostChecks::failures()++;
+                printf("rotation %d, %zu pixel buffers: the %dx%d region at %d,%d doesn't match\n",
+                       static_cast<int>(rotation), buffer_pixels, area.w, area.h, area.x, area.y);
+            }
+        }
+        EXPECT(bus.getOverwritten() == 0);
+    }
+}
+
+int main(){
+    //A whole frame through buffers much smaller than it
+    BackgroundBus bus;
+    DisplayTransport transport(bus, 100, X_OFFSET, Y_OFFSET);
+    randomize();
+    EXPECT(transport.queue(frame, WIDTH, 0, 0, WIDTH, HEIGHT));
+    transport.flush();
+    bus.replay(panel, PANEL_WIDTH, PANEL_HEIGHT);
+    EXPECT(countWrong(frame, 0, 0, WIDTH, HEIGHT) == 0);
+    EXPECT(bus.getByteCount() == 11 + WIDTH * HEIGHT * 2); //CASET and RASET with 4 bytes each, RAMWR, then the pixels
+    EXPECT(bus.getTransactionCount() == 1);
+    EXPECT(bus.getOverwritten() == 0);
+
+    //Several regions, overlapping ones merged when it sends fewer bytes, all go out in one transaction
+    bus.clear();
+    int completed = 0;
+    auto complete = [&completed]{ completed++; };
+    transport.onComplete(Delegate<void()>::ref(complete));
+    randomize();
+    transport.queue(frame, WIDTH, 10, 10, 20, 20);
+    transport.queue(frame, WIDTH, 25, 15, 20, 20);
+    transport.queue(frame, WIDTH, 100, 40, 8, 8);
+    transport.queue(frame, WIDTH, 0, 60, WIDTH, 4);
+    transport.flush();
+    bus.replay(panel, PANEL_WIDTH, PANEL_HEIGHT);
+    EXPECT(countWrong(frame, 10, 10, 20, 20) == 0);
+    EXPECT(countWrong(frame, 25, 15, 20, 20) == 0);
+    EXPECT(countWrong(frame, 100, 40, 8, 8) == 0);
+    EXPECT(countWrong(frame, 0, 60, WIDTH, 4) == 0);
+    EXPECT(bus.getTransactionCount() == 1);
+    EXPECT(completed == 1);
+    EXPECT(bus.getOverwritten() == 0);
+
+    //Every rotation, through buffers shorter than a line of the panel, between one and several lines, and bigger than the frame
+    for (PanelRotation rotation : {PanelRotation::Deg0, PanelRotation::Deg90, PanelRotation::Deg180, PanelRotation::Deg270})
+        for (size_t buffer_pixels : {1, 7, 64, 100, 300, WIDTH * HEIGHT + 5})
+            checkRotation(rotation, buffer_pixels);
+
+    //The home scene with two focus changes: only the lines that changed are sent
+    Texture small{25, 25, home_small_gallery}, large{36, 36, home_large_gallery};
+    AnimatedApp gallery{&small, &large, {0, 0}, false, 80U, Interpolation::Sinusoidal, Constraint::Center};
+    AnimatedApp settings{&small, &large, {0, 0}, false, 80U, Interpolation::Sinusoidal, Constraint::Center};
+    AnimatedApp test{&small, &large, {0, 0}, false, 80U, Interpolation::Sinusoidal, Constraint::Center};
+    HStack stack{{&gallery, &settings, &test}, {64, 32}, true, 14};
+    Scene scene({&stack}, &settings);
+    GFXcanvas16 canvas(WIDTH, HEIGHT);
+    UI ui(&scene, &canvas);
+
+    RecordingBus home_bus;
+    DisplayTransport home(home_bus, 1024, X_OFFSET, Y_OFFSET);
+    const size_t frames = 60;
+    for (size_t i = 0; i < frames; i++){
+        if (i == 10)
+            ui.FocusDirection(Direction::Right);
+        if (i == 35)
+            ui.FocusDirection(Direction::Left);
+        canvas.fillScreen(0);
+        ui.Render();
+        home.queueChanged(canvas.getBuffer(), WIDTH, HEIGHT);
+        home.flush();
+        delay(5);
+    }
+    home_bus.replay(panel, PANEL_WIDTH, PANEL_HEIGHT);
+    EXPECT(countWrong(canvas.getBuffer(), 0, 0, WIDTH, HEIGHT) == 0);
+    const size_t full = frames * (11 + WIDTH * HEIGHT * 2);
+    const TransportStats& stats = home.getStats();
+    EXPECT(home_bus.getByteCount() == stats.command_bytes + stats.pixel_bytes);
+    EXPECT(home_bus.getByteCount() < full / 2);
+
+    printf("home scene, %zu frames: %zu bytes sent, %zu for whole frames (%u regions)\n", frames, home_bus.getByteCount(), full, stats.regions);
+    return HostChecks::failures();
+}
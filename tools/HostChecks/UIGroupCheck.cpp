@@ -0,0 +1,61 @@
+/*Two UIs of different resolutions, each on its own canvas, rendered by a UIGroup from one AssetStore.
+Checks that the textures are stored once, that both UIs see the same animation time in a frame, and that the scene they share
+ends up drawn the same on both canvases. Run with `tools/HostChecks/run.sh UIGroupCheck`.*/
+#include "Check.h"
+#include "SimpleUI.h"
+#include "../../src/images/home_images.h"
+
+using namespace SimpleUI;
+
+int main(){
+    AssetStore store;
+    Texture* small = store.texture(25, 25, home_small_gallery);
+    Texture* large = store.texture(36, 36, home_large_gallery);
+    EXPECT(store.texture(25, 25, home_small_gallery) == small);
+    EXPECT(store.getTextureCount() == 2);
+
+    GFXcanvas16 wide(128, 64), tall(80, 160);
+    AnimatedApp first(small, large, {10, 10}), second(small, large, {10, 10});
+    Scene first_scene({&first}, &first), second_scene({&second}, &second);
+    UI first_ui(&first_scene, &wide, &store), second_ui(&second_scene, &tall, &store);
+    EXPECT(first_ui.assets == second_ui.assets);
+
+    int first_presents = 0, second_presents = 0;
+    uint32_t first_time = 0, second_time = 0;
+    bool same_time = true;
+    auto present_first = [&](Adafruit_GFX*){
+        first_presents++;
+        first_time = Clock::now();
+    };
+    auto present_second = [&](Adafruit_GFX*){
+        second_presents++;
+        second_time = Clock::now();
+        same_time = same_time && Clock::isTicking() && second_time == first_time;
+    };
+    first_ui.bindDisplay(Delegate<void(Adafruit_GFX*)>::ref(present_first));
+    second_ui.bindDisplay(Delegate<void(Adafruit_GFX*)>::ref(present_second));
+
+    UIGroup group({&first_ui, &second_ui});
+    const size_t textures = store.getTextureCount();
+    for (int frame = 0; frame < 30; frame++){
+        group.Render();
+        delay(5);
+        //What the one UI draws the other must draw too, the focus animation is at the same point on both
+        int different = 0, drawn = 0;
+        for (int y = 0; y < 64; y++)
+            for (int x = 0; x < 80; x++){
+                different += wide.getPixel(x, y) != tall.getPixel(x, y);
+                drawn += wide.getPixel(x, y) != 0;
+            }
+        EXPECT(different == 0);
+        EXPECT(drawn > 0);
+    }
+    EXPECT(!Clock::isTicking());
+    EXPECT(first_presents == 30 && second_presents == 30);
+    EXPECT(same_time);
+    EXPECT(store.getTextureCount() == textures);
+    EXPECT(store.getScaledUsage() <= store.getScaledBudget());
+
+    printf("scaled copies use %zu bytes of %zu\n", store.getScaledUsage(), store.getScaledBudget());
+    return HostChecks::failures();
+}
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Builds the library for the computer it runs on with optimisations and no sanitizers, then builds and runs every *Bench.cpp
+# of this folder against it. The timings are host timings, they compare two versions of the code, not what a board achieves.
+#
+# Usage, from anywhere:
+#     tools/HostChecks/bench.sh [Name...]    e.g. `tools/HostChecks/bench.sh TransformBench`, with no name every benchmark runs
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$HERE/../..
+OUT=${OUT:-$HERE/build}
+CXX=${CXX:-g++}
+FLAGS="-std=gnu++17 -O2"
+INCLUDES="-I$HERE -I$HERE/stubs -I$ROOT/lib/SimpleUI/src -I$ROOT/lib/SimpleUI/deps"
+for dir in "$ROOT"/lib/SimpleUI/deps/*/; do INCLUDES="$INCLUDES -I$dir"; done
+
+mkdir -p "$OUT/bench-lib"
+OBJECTS=""
+for source in "$ROOT"/lib/SimpleUI/src/*.cpp "$ROOT"/lib/SimpleUI/deps/*/*.cpp "$HERE"/stubs/*.cpp; do
+    object=$OUT/bench-lib/$(basename "$source" .cpp).o
+    if [ ! -f "$object" ] || [ "$source" -nt "$object" ] || [ -n "$(find "$ROOT/lib" "$HERE/stubs" -name '*.h' -newer "$object")" ]; then
+        $CXX $FLAGS $INCLUDES -c "$source" -o "$object"
+    fi
+    OBJECTS="$OBJECTS $object"
+done
+
+if [ $# -eq 0 ]; then
+    set -- $(cd "$HERE" && ls *Bench.cpp | sed 's/\.cpp$//')
+fi
+for name in "$@"; do
+    $CXX $FLAGS $INCLUDES "$HERE/$name.cpp" $OBJECTS -o "$OUT/$name"
+    echo "$name:"
+    "$OUT/$name"
+done
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Builds the library for the computer it runs on, under AddressSanitizer and UndefinedBehaviorSanitizer, then builds and runs
+# every *Check.cpp of this folder against it. The Arduino core, FreeRTOS and Adafruit_GFX are replaced by the stand-ins of stubs/.
+#
+# Usage, from anywhere:
+#     tools/HostChecks/run.sh [Name...]      e.g. `tools/HostChecks/run.sh TransportCheck`, with no name every check runs
+# Needs g++ (or CXX) with the sanitizers, zlib for TextureLoaderCheck and libutil for TelemetryLinkCheck.
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$HERE/../..
+OUT=${OUT:-$HERE/build}
+CXX=${CXX:-g++}
+FLAGS="-std=gnu++17 -g -O1 -fsanitize=address,undefined -fno-sanitize-recover=all -fno-omit-frame-pointer"
+INCLUDES="-I$HERE -I$HERE/stubs -I$ROOT/lib/SimpleUI/src -I$ROOT/lib/SimpleUI/deps"
+for dir in "$ROOT"/lib/SimpleUI/deps/*/; do INCLUDES="$INCLUDES -I$dir"; done
+
+mkdir -p "$OUT/lib"
+OBJECTS=""
+for source in "$ROOT"/lib/SimpleUI/src/*.cpp "$ROOT"/lib/SimpleUI/deps/*/*.cpp "$HERE"/stubs/*.cpp; do
+    object=$OUT/lib/$(basename "$source" .cpp).o
+    if [ ! -f "$object" ] || [ "$source" -nt "$object" ] || [ -n "$(find "$ROOT/lib" "$HERE/stubs" -name '*.h' -newer "$object")" ]; then
+        $CXX $FLAGS $INCLUDES -c "$source" -o "$object"
+    fi
+    OBJECTS="$OBJECTS $object"
+done
+
+if [ $# -eq 0 ]; then
+    set -- $(cd "$HERE" && ls *Check.cpp | sed 's/\.cpp$//')
+fi
+failed=0
+for name in "$@"; do
+    case $name in
+        TextureLoaderCheck) LIBS="-lz -pthread" ;;
+        TelemetryLinkCheck) LIBS="-lutil" ;;
+        *) LIBS="" ;;
+    esac
+    $CXX $FLAGS $INCLUDES "$HERE/$name.cpp" $OBJECTS $LIBS -o "$OUT/$name"
+    if "$OUT/$name"; then
+        echo "$name: passed"
+    else
+        echo "$name: FAILED"
+        failed=1
+    fi
+done
+exit $failed
@@ -0,0 +1,166 @@
+/*The part of Adafruit_GFX the library draws with. Everything is drawn a pixel at a time through drawPixel(), the canvases clip
+like the real ones do. Text isn't rasterized, writing a character only moves the cursor.*/
+#pragma once
+#include "Arduino.h"
+
+struct GFXglyph{
+    uint16_t bitmapOffset;
+    uint8_t width, height, xAdvance;
+    int8_t xOffset, yOffset;
+};
+
+struct GFXfont{
+    uint8_t* bitmap;
+    GFXglyph* glyph;
+    uint16_t first, last;
+    uint8_t yAdvance;
+};
+
+class Adafruit_GFX : public Print{
+    public:
+    Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h){}
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void startWrite(){}
+    virtual void endWrite(){}
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color){ drawPixel(x, y, color); }
+    virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){ fillRect(x, y, w, h, color); }
+    virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){ drawFastVLine(x, y, h, color); }
+    virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){ drawFastHLine(x, y, w, color); }
+    virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color){ drawLine(x0, y0, x1, y1, color); }
+    virtual void invertDisplay(bool){}
+
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+        for (int i = 0; i < h; i++)
+            drawPixel(x, y + i, color);
+    }
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+        for (int i = 0; i < w; i++)
+            drawPixel(x + i, y, color);
+    }
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+        for (int i = 0; i < h; i++)
+            drawFastHLine(x, y + i, w, color);
+    }
+    virtual void fillScreen(uint16_t color){ fillRect(0, 0, _width, _height, color); }
+    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color){
+        const int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+        const int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+        int error = dx + dy;
+        while (true){
+            drawPixel(x0, y0, color);
+            if (x0 == x1 && y0 == y1)
+                break;
+            const int e2 = 2 * error;
+            if (e2 >= dy){ error += dy; x0 += sx; }
+            if (e2 <= dx){ error += dx; y0 += sy; }
+        }
+    }
+    virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+        drawFastHLine(x, y, w, color);
+        drawFastHLine(x, y + h - 1, w, color);
+        drawFastVLine(x, y, h, color);
+        drawFastVLine(x + w - 1, y, h, color);
+    }
+
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color){
+        for (int y = -r; y <= r; y++)
+            for (int x = -r; x <= r; x++){
+                const int d = x * x + y * y;
+                if (d <= r * r && d > (r - 1) * (r - 1))
+                    drawPixel(x0 + x, y0 + y, color);
+            }
+    }
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color){
+        for (int y = -r; y <= r; y++)
+            for (int x = -r; x <= r; x++)
+                if (x * x + y * y <= r * r)
+                    drawPixel(x0 + x, y0 + y, color);
+    }
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color){
+        drawLine(x0, y0, x1, y1, color);
+        drawLine(x1, y1, x2, y2, color);
+        drawLine(x2, y2, x0, y0, color);
+    }
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color){
+        const int area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+        for (int y = std::min({y0, y1, y2}); y <= std::max({y0, y1, y2}); y++)
+            for (int x = std::min({x0, x1, x2}); x <= std::max({x0, x1, x2}); x++){
+                const int w0 = (x1 - x) * (y2 - y) - (x2 - x) * (y1 - y);
+                const int w1 = (x2 - x) * (y0 - y) - (x0 - x) * (y2 - y);
+                const int w2 = (x0 - x) * (y1 - y) - (x1 - x) * (y0 - y);
+                if (area >= 0 ? (w0 >= 0 && w1 >= 0 && w2 >= 0) : (w0 <= 0 && w1 <= 0 && w2 <= 0))
+                    drawPixel(x, y, color);
+            }
+    }
+    void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t, uint16_t color){ drawRect(x, y, w, h, color); }
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t, uint16_t color){ fillRect(x, y, w, h, color); }
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color){
+        const int stride = (w + 7) / 8;
+        for (int j = 0; j < h; j++)
+            for (int i = 0; i < w; i++)
+                if (bitmap[j * stride + i / 8] & (0x80 >> (i & 7)))
+                    writePixel(x + i, y + j, color);
+    }
+    void drawBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w, int16_t h, uint16_t color){
+        drawBitmap(x, y, const_cast<const uint8_t*>(bitmap), w, h, color);
+    }
+    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h){
+        for (int j = 0; j < h; j++)
+            for (int i = 0; i < w; i++)
+                writePixel(x + i, y + j, bitmap[j * w + i]);
+    }
+    void drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap, int16_t w, int16_t h){
+        drawRGBBitmap(x, y, const_cast<const uint16_t*>(bitmap), w, h);
+    }
+
+    void drawChar(int16_t, int16_t, unsigned char, uint16_t, uint16_t, uint8_t){}
+    void getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h){
+        *x1 = x;
+        *y1 = y;
+        *w = strlen(text) * 6 * textsize_x;
+        *h = 8 * textsize_y;
+    }
+    void setTextSize(uint8_t size){ textsize_x = textsize_y = size; }
+    void setFont(const GFXfont* font = nullptr){ gfxFont = const_cast<GFXfont*>(font); }
+    void setCursor(int16_t x, int16_t y){ cursor_x = x; cursor_y = y; }
+    void setTextColor(uint16_t color){ textcolor = textbgcolor = color; }
+    void setTextColor(uint16_t color, uint16_t background){ textcolor = color; textbgcolor = background; }
+    void setTextWrap(bool w){ wrap = w; }
+    size_t write(uint8_t) override { cursor_x += 6 * textsize_x; return 1; }
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+
+    protected:
+    int16_t WIDTH, HEIGHT;
+    int16_t _width, _height;
+    int16_t cursor_x = 0, cursor_y = 0;
+    uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+    uint8_t textsize_x = 1, textsize_y = 1;
+    bool wrap = true;
+    GFXfont* gfxFont = nullptr;
+};
+
+class GFXcanvas16 : public Adafruit_GFX{
+    public:
+    GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h), buffer(new uint16_t[w * h]()){}
+    ~GFXcanvas16(){ delete[] buffer; }
+    GFXcanvas16(const GFXcanvas16&) = delete;
+    GFXcanvas16& operator=(const GFXcanvas16&) = delete;
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x >= 0 && y >= 0 && x < _width && y < _height)
+            buffer[x + y * WIDTH] = color;
+    }
+    uint16_t getPixel(int16_t x, int16_t y) const {
+        if (x < 0 || y < 0 || x >= _width || y >= _height)
+            return 0;
+        return buffer[x + y * WIDTH];
+    }
+    uint16_t* getBuffer() const { return buffer; }
+
+    protected:
+    uint16_t* buffer;
+};
@@ -0,0 +1,62 @@
+/*Just enough of the Arduino core and of FreeRTOS for the library to build and run on a computer, see ../run.sh.
+Time is the host's steady clock, pins do nothing, and tasks are never started: the code that would run on them is polled instead.*/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "Print.h"
+
+inline uint32_t micros(){
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+inline uint32_t millis(){ return micros() / 1000; }
+inline void delay(uint32_t ms){ std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(uint32_t us){ std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+#define PROGMEM
+#define IRAM_ATTR
+inline void pinMode(int, int){}
+inline void digitalWrite(int, int){}
+inline int digitalRead(int){ return 0; }
+inline void analogWrite(int, int){}
+
+//Prints to stdout
+class HardwareSerial : public Print{
+    public:
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t* bytes, size_t len) override { return fwrite(bytes, 1, len, stdout); }
+    void begin(unsigned long){}
+    int available(){ return 0; }
+    int read(){ return -1; }
+};
+extern HardwareSerial Serial;
+
+//FreeRTOS
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFU
+#define pdMS_TO_TICKS(ms) (ms)
+#define portTICK_PERIOD_MS 1
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, BaseType_t){ return pdFALSE; }
+inline void vTaskDelete(TaskHandle_t){}
+inline void vTaskDelay(TickType_t){}
+inline TaskHandle_t xTaskGetCurrentTaskHandle(){ return nullptr; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t){ return pdPASS; }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t){ return 0; }
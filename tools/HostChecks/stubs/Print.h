@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+class Print{
+    public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* bytes, size_t len){
+        size_t written = 0;
+        while(len--)
+            written += write(*bytes++);
+        return written;
+    }
+    size_t print(const char* text){ return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+    size_t print(long value){ char text[24]; snprintf(text, sizeof(text), "%ld", value); return print(text); }
+    size_t print(int value){ return print(static_cast<long>(value)); }
+    size_t print(unsigned int value){ return print(static_cast<long>(value)); }
+    size_t print(unsigned long value){ char text[24]; snprintf(text, sizeof(text), "%lu", value); return print(text); }
+    size_t println(const char* text = ""){ return print(text) + print("\n"); }
+    size_t printf(const char* format, ...){
+        char text[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        return print(text);
+    }
+};
@@ -0,0 +1,5 @@
+#pragma once
+#include "Arduino.h"
+
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t*>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t*>(address))
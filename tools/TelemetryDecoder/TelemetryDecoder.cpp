@@ -0,0 +1,308 @@
+/*Reads the telemetry a board streams on its serial port and prints it, on Linux or macOS.
+
+Build from this folder:
+    g++ -std=c++17 -O2 -I../../lib/SimpleUI/deps/Telemetry -I../../lib/SimpleUI/deps/Mirror -I../../lib/SimpleUI/deps/Delegate \
+        TelemetryDecoder.cpp ../../lib/SimpleUI/deps/Telemetry/Telemetry.cpp ../../lib/SimpleUI/deps/Mirror/Mirror.cpp -o telemetry
+
+Usage:
+    telemetry [--csv] [--baud <rate>] [--mirror <image.ppm>] [port]
+
+With no port the stream is read from stdin, so a capture can be replayed with `telemetry < capture.bin`.
+By default a summary is printed every second, with the focus and animation events as they come.
+--csv prints every record as a line instead: seconds since start, type, then its numbers and text, ready to be plotted.
+--mirror asks the board to mirror its screen and keeps the image up to date with it, up to ten times a second.
+Any viewer that reloads the file shows it live, like `feh --reload 0.1 image.ppm`. When a record is lost the board is asked to
+send the whole screen again, which takes a moment on a slow link.
+A pseudo-terminal works as well as a real port, `socat -d -d pty,raw,echo=0 pty,raw,echo=0` makes a pair to test with.*/
+#include "Telemetry.h"
+#include "Mirror.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+using namespace SimpleUI;
+
+//The names of the enums of SimpleUI.h, in their order
+static const char* const type_names[] = {"hello", "frame", "heap", "focus", "animation", "perf", "transport", "mirror info", "mirror palette", "mirror delta"};
+static const char* const quality_names[] = {"Low", "Medium", "High"};
+static const char* const element_names[] = {"UIElement", "AnimatedApp", "UIImage", "Checkbox", "List", "Container", "Sprite", "Emitter", "ProgressBar", "Slider", "Gauge", "Chart", "ScrollView"};
+static const char* const anim_names[] = {"Start", "Running", "Finished"};
+
+template<size_t N>
+static const char* nameOf(const char* const (&names)[N], uint32_t index){
+    return index < N ? names[index] : "?";
+}
+
+static speed_t baudConstant(long baud){
+    switch(baud){
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+        default: return B0;
+    }
+}
+
+//Put a serial port in raw mode, so no byte is changed or held back
+static bool configurePort(int fd, long baud){
+    termios tty;
+    if(tcgetattr(fd, &tty) != 0)
+        return false;
+    cfmakeraw(&tty);
+    const speed_t speed = baudConstant(baud);
+    if(speed != B0){
+        cfsetispeed(&tty, speed);
+        cfsetospeed(&tty, speed);
+    }
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+//What the summary adds up between two prints
+struct Window{
+    uint32_t first_frame = 0, last_frame = 0;
+    uint64_t render_sum = 0, present_sum = 0;
+    uint32_t render_worst = 0, samples = 0;
+    uint32_t quality = 0, over_budget = 0;
+    uint32_t heap_free = 0, heap_low = 0, heap_total = 0;
+    uint32_t pixel_bytes = 0, last_pixel_bytes = 0;
+    bool started = false;   //first_frame is known
+    bool has_heap = false;
+    uint32_t mirror_frames = 0;
+};
+
+static volatile sig_atomic_t stopping = 0;
+
+//Write the mirrored screen as a binary PPM, through a temporary file so a viewer never reads half an image
+static bool writeImage(const MirrorReceiver& mirror, const std::string& path){
+    const std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if(!file)
+        return false;
+    fprintf(file, "P6\n%u %u\n255\n", mirror.getWidth(), mirror.getHeight());
+    std::string line(3 * mirror.getWidth(), '\0');
+    for(uint16_t y = 0; y < mirror.getHeight(); y++){
+        mirror.readLine(y, reinterpret_cast<uint8_t*>(&line[0]));
+        fwrite(line.data(), 1, line.size(), file);
+    }
+    fclose(file);
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+struct Printer{
+    bool csv = false;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Window window;
+    MirrorReceiver mirror;
+    bool mirror_changed = false;
+    uint32_t mirror_frame = 0;
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void message(const TelemetryMessage& message){
+        const uint32_t* n = message.numbers;
+        const bool mirrored = message.type >= TelemetryType::MirrorInfo;
+        if(mirror.apply(message)){
+            mirror_changed = true;
+            if(mirror.getFrame() != mirror_frame)
+                window.mirror_frames++;
+            mirror_frame = mirror.getFrame();
+        }
+        if(csv){
+            printf("%.3f,%s", seconds(), nameOf(type_names, static_cast<uint32_t>(message.type)));
+            for(size_t i = 0; i < message.count; i++){
+                printf(",%u", n[i]);
+            }
+            if(mirrored)
+                printf(",%zu", message.text.size());  //Binary, only its size is of interest
+            else if(!message.text.empty())
+                printf(",\"%s\"", message.text.c_str());
+            printf("\n");
+            fflush(stdout);
+            return;
+        }
+        switch(message.type){
+            case TelemetryType::Hello:
+                if(message.count >= 3)
+                    printf("[%8.3f] board up for %.1fs, protocol %u, %u MHz\n", seconds(), n[1] / 1000.0, n[0], n[2]);
+                break;
+            case TelemetryType::Frame:
+                if(message.count >= 7){
+                    if(!window.started)
+                        window.first_frame = n[0];
+                    window.started = true;
+                    window.last_frame = n[0];
+                    window.render_sum += n[1];
+                    window.present_sum += n[2];
+                    window.render_worst = std::max(window.render_worst, n[1] + n[2]);
+                    window.samples++;
+                    window.quality = n[5];
+                    window.over_budget = n[6];
+                }
+                break;
+            case TelemetryType::Heap:
+                if(message.count >= 3){
+                    window.has_heap = true;
+                    window.heap_free = n[0];
+                    window.heap_low = n[1];
+                    window.heap_total = n[2];
+                }
+                break;
+            case TelemetryType::Transport:
+                if(message.count >= 4)
+                    window.pixel_bytes = n[3];
+                break;
+            case TelemetryType::Focus:
+                if(message.count >= 1)
+                    printf("[%8.3f] focus -> %s (%s)\n", seconds(), message.text.c_str(), nameOf(element_names, n[0]));
+                break;
+            case TelemetryType::Animation:
+                if(message.count >= 3)
+                    printf("[%8.3f] animation of %s: %s, %s, value %.3f\n", seconds(), message.text.c_str(), nameOf(anim_names, n[0]),
+                           n[1] ? "forward" : "backward", TelemetryCodec::unzigzag(n[2]) / 1000.0);
+                break;
+            case TelemetryType::Perf:
+                if(message.count >= 1)
+                    printf("[%8.3f] perf %s: worst %uus\n", seconds(), message.text.c_str(), n[0]);
+                break;
+            case TelemetryType::MirrorInfo:
+                if(mirror.isSynced())
+                    printf("[%8.3f] mirroring %ux%u, %u bits per pixel\n", seconds(), mirror.getWidth(), mirror.getHeight(), mirror.getBits());
+                break;
+            default:
+                break;
+        }
+        fflush(stdout);
+    }
+
+    void summary(const TelemetryDecoder& decoder, double elapsed){
+        if(csv)
+            return;
+        Window& w = window;
+        if(w.samples){
+            const uint32_t frames = w.last_frame - w.first_frame;
+            printf("[%8.3f] %5.1f fps  render %5lluus  present %5lluus  worst %5uus  quality %s  over budget %u",
+                   seconds(), frames / elapsed, static_cast<unsigned long long>(w.render_sum / w.samples),
+                   static_cast<unsigned long long>(w.present_sum / w.samples), w.render_worst, nameOf(quality_names, w.quality), w.over_budget);
+            if(w.pixel_bytes >= w.last_pixel_bytes && w.last_pixel_bytes)
+                printf("  link %.1fkB/s", (w.pixel_bytes - w.last_pixel_bytes) / elapsed / 1000.0);
+            if(w.has_heap)
+                printf("  heap %u/%ukB free, low %ukB", w.heap_free / 1024, w.heap_total / 1024, w.heap_low / 1024);
+            if(w.mirror_frames)
+                printf("  mirror %.1f fps", w.mirror_frames / elapsed);
+            printf("  (%u records, %u corrupted)\n", decoder.getDecoded(), decoder.getCorrupted());
+            fflush(stdout);
+        }
+        //The next window starts where this one ended, so no frame is missed between two reports
+        Window next;
+        next.started = w.started;
+        next.first_frame = next.last_frame = w.last_frame;
+        next.pixel_bytes = next.last_pixel_bytes = w.pixel_bytes;
+        w = next;
+    }
+};
+
+int main(int argc, char** argv){
+    Printer printer;
+    long baud = 115200;
+    const char* path = nullptr;
+    const char* image = nullptr;
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "--csv"))
+            printer.csv = true;
+        else if(!strcmp(argv[i], "--baud") && i + 1 < argc)
+            baud = atol(argv[++i]);
+        else if(!strcmp(argv[i], "--mirror") && i + 1 < argc)
+            image = argv[++i];
+        else if(!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")){
+            fprintf(stderr, "usage: %s [--csv] [--baud <rate>] [--mirror <image.ppm>] [port]\n", argv[0]);
+            return 0;
+        }
+        else
+            path = argv[i];
+    }
+
+    int fd = STDIN_FILENO;
+    if(path && strcmp(path, "-")){
+        fd = open(path, (image ? O_RDWR : O_RDONLY) | O_NOCTTY);  //Mirroring is asked for on the same port
+        if(fd < 0){
+            perror(path);
+            return 1;
+        }
+    }
+    if(isatty(fd) && !configurePort(fd, baud)){
+        perror("configuring the port");
+        return 1;
+    }
+
+    //Tell the board to stop mirroring on the way out
+    signal(SIGINT, [](int){ stopping = 1; });
+    signal(SIGTERM, [](int){ stopping = 1; });
+    const bool can_ask = image && fd != STDIN_FILENO;
+    auto ask = [&](const char* command){
+        if(can_ask && write(fd, command, strlen(command)) < 0)
+            perror("asking the board");
+    };
+
+    TelemetryDecoder decoder(TelemetryDecoder::Handler::member<&Printer::message>(&printer));
+    auto last_summary = std::chrono::steady_clock::now();
+    auto last_request = last_summary - std::chrono::seconds(10);
+    auto last_image = last_summary;
+    uint8_t bytes[512];
+    while(!stopping){
+        pollfd waiting{fd, POLLIN, 0};
+        const int ready = poll(&waiting, 1, 200);
+        if(ready > 0){
+            const ssize_t len = read(fd, bytes, sizeof(bytes));
+            if(len == 0 && !isatty(fd))
+                break;  //End of a capture
+            if(len > 0)
+                decoder.feed(bytes, static_cast<size_t>(len));
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if(image){
+            //The mirror is out of step until the board sends the whole screen, asking again if that's lost too
+            if(!printer.mirror.isSynced() && now - last_request > std::chrono::seconds(3)){
+                ask("mirror\n");
+                last_request = now;
+            }
+            if(printer.mirror_changed && printer.mirror.isSynced() && now - last_image > std::chrono::milliseconds(100)){
+                if(!writeImage(printer.mirror, image))
+                    perror(image);
+                printer.mirror_changed = false;
+                last_image = now;
+            }
+        }
+        const double elapsed = std::chrono::duration<double>(now - last_summary).count();
+        if(elapsed >= 1.0){
+            printer.summary(decoder, elapsed);
+            last_summary = now;
+        }
+    }
+    if(image && printer.mirror.getWidth())
+        writeImage(printer.mirror, image);
+    ask("mirror off\n");
+    printer.summary(decoder, std::max(0.001, std::chrono::duration<double>(std::chrono::steady_clock::now() - last_summary).count()));
+    if(fd != STDIN_FILENO)
+        close(fd);
+    return 0;
+}